@@ -0,0 +1,76 @@
+#ifndef BENCH_HEIGHTMAP_H
+#define BENCH_HEIGHTMAP_H
+
+#include "core/heightmap.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// What heightmap_bench and env_bench both need: level01's bounds, a made up
+// map for when the real one isn't baked, and the timing loop.
+
+namespace bench {
+
+// Level01 bounds
+const Vec4 LEFT_UP(-454.7F, 0.0F, -326.2F);
+const Vec4 RIGHT_DOWN(392.8F, 0.0F, 326.8F);
+
+// A size x size map of rolling hills, written to the temp dir as name.hmp.
+// Returns its path, empty if it can't be written
+inline std::string WriteSyntheticMap(u32 size, const char* name)
+{
+    HeightmapFileHeader header = {};
+    header.magic = HEIGHTMAP_FILE_MAGIC;
+    header.version = HEIGHTMAP_FILE_VERSION;
+    header.width = size;
+    header.height = size;
+    header.minHeight = 0.0F;
+    header.maxHeight = 200.0F;
+    header.totalSize = HeightmapFileSize(size, size);
+
+    std::vector<u16> heights(size * size);
+    for (u32 y = 0; y < size; y++)
+    {
+        for (u32 x = 0; x < size; x++)
+        {
+            float h = 0.5F + 0.25F * std::sin(x * 0.05F) + 0.25F * std::cos(y * 0.07F + x * 0.01F);
+            heights[y * size + x] = static_cast<u16>(h * HEIGHTMAP_FILE_MAX_VALUE);
+        }
+    }
+
+    std::string path = std::string(P_tmpdir) + "/" + name + HEIGHTMAP_FILE_EXTENSION;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return "";
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(heights.data(), sizeof(u16), heights.size(), file);
+    fclose(file);
+    return path;
+}
+
+// The fastest of runs calls of body, in ns per item. body returns something
+// that depends on all its work, added up in sink so none of it gets
+// optimized out
+template <typename T, typename F>
+double BestOf(int runs, size_t items, T* sink, F&& body)
+{
+    double best = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        *sink += body();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / items;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef BENCH_VEHICLE_H
+#define BENCH_VEHICLE_H
+
+#include "core/tinyphysicsengine.hpp"
+
+// What stress_bench and vehicle_bench both need to put Car's soft body in a
+// TPE world and drive it, kept in step with Car by hand.
+
+namespace bench {
+
+const TPE_Unit GRAVITY = TPE_F / 50; // the levels' default
+const TPE_Unit BUMP_CELL = 8 * TPE_F;
+const TPE_Unit BUMP_RADIUS = 2 * TPE_F;
+
+// ground with a half buried ball in every 8x8 cell
+inline TPE_Vec3 BumpsEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    // only the ball of the cell the point is in can be closer than the ground
+    TPE_Vec3 bump = TPE_vec3(
+        (point.x >= 0 ? point.x / BUMP_CELL : (point.x + 1) / BUMP_CELL - 1) * BUMP_CELL + BUMP_CELL / 2, -BUMP_RADIUS / 2,
+        (point.z >= 0 ? point.z / BUMP_CELL : (point.z + 1) / BUMP_CELL - 1) * BUMP_CELL + BUMP_CELL / 2);
+
+    TPE_ENV_START(TPE_envGround(point, 0), point)
+    TPE_ENV_NEXT(TPE_envSphere(point, bump, BUMP_RADIUS), point)
+    TPE_ENV_END
+}
+
+// same as Car::Setup, takes 5 joints and 10 connections
+inline void MakeVehicle(TPE_Body* body, TPE_Joint* joints, TPE_Connection* connections)
+{
+    TPE_makeCenterRectFull(joints, connections, 1000, 1800, 400);
+    joints[4].position.y += 700;
+    joints[4].sizeDivided *= 3;
+    joints[4].sizeDivided /= 2;
+    TPE_bodyInit(body, joints, 5, connections, 10, TPE_F);
+    body->elasticity = TPE_F / 100;
+    body->friction = 3 * TPE_F / 32;
+    body->flags |= TPE_BODY_FLAG_ALWAYS_ACTIVE | TPE_BODY_FLAG_CCD;
+}
+
+// Car::SoftBodyUpdate with the given throttle and steering (0 straight, 1 or
+// 2 like Car's), contacts is a bit per joint touching the environment last
+// step. Gravity is the caller's.
+inline void DriveVehicle(TPE_Body* body, uint8_t contacts, float throttle, int steering)
+{
+    const TPE_Unit turnRate = 2 * TPE_F / 4;
+    const TPE_Unit turnFriction = 3 * TPE_F / 10;
+    const TPE_Unit acceleration = TPE_F / 8;
+
+    TPE_Vec3 forward = TPE_vec3Normalized(TPE_vec3Plus(TPE_vec3Minus(body->joints[2].position, body->joints[0].position),
+                                                       TPE_vec3Minus(body->joints[3].position, body->joints[1].position)));
+    TPE_Vec3 side = TPE_vec3Normalized(TPE_vec3Plus(TPE_vec3Minus(body->joints[1].position, body->joints[0].position),
+                                                    TPE_vec3Minus(body->joints[3].position, body->joints[2].position)));
+    TPE_Vec3 up = TPE_vec3Cross(forward, side);
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (contacts & (1 << i))
+        {
+            TPE_Vec3 velocity = TPE_vec3(body->joints[i].velocity[0], body->joints[i].velocity[1], body->joints[i].velocity[2]);
+            TPE_Vec3 axis = side;
+            if (i >= 2 && steering)
+            {
+                axis = TPE_vec3Normalized(steering == 2 ? TPE_vec3Plus(TPE_vec3Times(forward, turnRate), side)
+                                                        : TPE_vec3Minus(TPE_vec3Times(forward, turnRate), side));
+            }
+            velocity = TPE_vec3Minus(velocity, TPE_vec3Times(axis, TPE_vec3Dot(axis, velocity) * turnFriction / TPE_F));
+            body->joints[i].velocity[0] = velocity.x;
+            body->joints[i].velocity[1] = velocity.y;
+            body->joints[i].velocity[2] = velocity.z;
+        }
+    }
+
+    if (TPE_vec3Dot(up, TPE_vec3Minus(body->joints[4].position, body->joints[0].position)) < 0)
+    {
+        body->joints[4].position = TPE_vec3Plus(TPE_vec3Times(up, 300), body->joints[0].position);
+    }
+
+    if ((contacts & 0x0c) == 0x0c)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            body->joints[i].velocity[0] += forward.x * acceleration * throttle / TPE_F;
+            body->joints[i].velocity[1] += forward.y * acceleration * throttle / TPE_F;
+            body->joints[i].velocity[2] += forward.z * acceleration * throttle / TPE_F;
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+// Host check that TPE_BODY_FLAG_CCD keeps fast bodies from going through a
+// floor thinner than one step of their fall.
+//
+//   ccd_bench [-k ticks] [-f floor thickness]
+//
+// Drops a ball, a box and the car's body at a range of speeds onto a slab
+// of -f TPE_Units (TPE_F / 8 by default, less than a ball's joint) with the
+// levels' gravity, once without CCD and once with it, and steps each alone
+// for k ticks. A body went through if any of its joints ever got below the
+// slab's bottom or ended up below its top.
+//
+// Prints per shape and speed how far down the lowest joint got (a drop stops
+// once it's through) and whether it went through, and fails if anything went
+// through with CCD on. Without it the fast ones are expected to.
+
+#include "core/tinyphysicsengine.hpp"
+#include "bench_vehicle.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench;
+
+const TPE_Unit SIZE = 64 * TPE_F;
+
+enum Shape
+{
+    SHAPE_BALL,
+    SHAPE_BOX,
+    SHAPE_CAR,
+};
+
+const char* SHAPE_NAMES[] = {"ball", "box", "car"};
+
+TPE_Unit thickness = TPE_F / 8;
+
+TPE_Vec3 SlabEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    // top face at 0
+    return TPE_envAABox(point, TPE_vec3(0, -thickness / 2, 0), TPE_vec3(SIZE, thickness / 2, SIZE));
+}
+
+struct Result
+{
+    TPE_Unit lowest; // lowest joint center over the run
+    bool through;
+};
+
+Result Drop(Shape shape, TPE_Unit speed, bool ccd, int ticks)
+{
+    TPE_Body body;
+    TPE_Joint joints[8];
+    TPE_Connection connections[16];
+    switch (shape)
+    {
+        case SHAPE_BALL:
+            joints[0] = TPE_joint(TPE_vec3(0, 0, 0), TPE_F / 4);
+            TPE_bodyInit(&body, joints, 1, connections, 0, TPE_F);
+            break;
+        case SHAPE_BOX:
+            TPE_makeBox(joints, connections, TPE_F, TPE_F, TPE_F, TPE_F / 4);
+            TPE_bodyInit(&body, joints, 8, connections, 16, TPE_F);
+            break;
+        default:
+            MakeVehicle(&body, joints, connections);
+            break;
+    }
+    if (ccd)
+    {
+        body.flags |= TPE_BODY_FLAG_CCD;
+    }
+    else
+    {
+        body.flags &= ~TPE_BODY_FLAG_CCD;
+    }
+    // a step or two of fall above the floor, already going at speed
+    TPE_bodyMoveBy(&body, TPE_vec3(0, 2 * TPE_F + speed + speed / 2, 0));
+    TPE_bodyAccelerate(&body, TPE_vec3(0, -speed, 0));
+
+    TPE_World world;
+    TPE_worldInit(&world, &body, 1, SlabEnv);
+
+    Result result = {body.joints[0].position.y, false};
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        TPE_bodyApplyGravity(&body, GRAVITY);
+        TPE_worldStep(&world);
+        for (int i = 0; i < body.jointCount; i++)
+        {
+            result.lowest = std::min(result.lowest, body.joints[i].position.y);
+        }
+        if (result.lowest < -thickness)
+        {
+            // through, and falling far enough would overflow TPE's lengths
+            break;
+        }
+    }
+    result.through = result.lowest < -thickness;
+    for (int i = 0; i < body.jointCount; i++)
+    {
+        result.through |= body.joints[i].position.y < 0;
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int ticks = 200;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-k") && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) thickness = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-k ticks] [-f floor thickness]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ticks < 1 || thickness < 2)
+    {
+        fprintf(stderr, "Need at least one tick and a floor\n");
+        return 1;
+    }
+
+    const TPE_Unit speeds[] = {TPE_F / 4, TPE_F / 2, TPE_F, 2 * TPE_F, 4 * TPE_F, 8 * TPE_F, 16 * TPE_F};
+    printf("ccd: %d ticks, floor %d thick (TPE_F = %d)\n", ticks, thickness, TPE_F);
+    printf("  %-5s %7s %14s %14s\n", "shape", "speed", "lowest no ccd", "lowest ccd");
+    int failed = 0;
+    for (Shape shape : {SHAPE_BALL, SHAPE_BOX, SHAPE_CAR})
+    {
+        for (TPE_Unit speed : speeds)
+        {
+            Result plain = Drop(shape, speed, false, ticks);
+            Result swept = Drop(shape, speed, true, ticks);
+            printf("  %-5s %7d %7d %-7s %6d %s\n", SHAPE_NAMES[shape], speed, plain.lowest, plain.through ? "through" : "",
+                   swept.lowest, swept.through ? "THROUGH" : "");
+            failed += swept.through;
+        }
+    }
+    if (failed)
+    {
+        fprintf(stderr, "%d drops went through the floor with CCD on\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Host benchmark of what a level's environment function costs per query.
+//
+//   env_bench [-n queries] [-r runs] [map.hmp]
+//
+// Uses level01's heightmap (res/level01/heightmap.hmp) unless told otherwise,
+// and a generated one if that isn't baked. Queries are what the joints of a
+// car on the ground ask for: points from a bit under to a few units over the
+// surface, with a one unit search distance.
+//
+// Compares Heightmap::environmentDistance against the flat TPE_envGround it
+// replaced and TPE_envHeightmap calling back into the same heightmap. Then
+// the same for casts: Heightmap::segmentCast against TPE_castEnvironmentRay
+// raymarching through environmentDistance, for short downward wheel rays
+// and long line of sight segments over the terrain.
+
+#include "core/heightmap.hpp"
+#include "bench_heightmap.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace bench;
+
+const Heightmap* heightmap;
+TPE_Vec3 gridCenter;
+TPE_Unit gridSize;
+
+TPE_Vec3 HeightfieldEnv(TPE_Vec3 position, TPE_Unit maxDistance)
+{
+    return heightmap->environmentDistance(position, maxDistance);
+}
+
+TPE_Unit HeightAtSample(int32_t x, int32_t y)
+{
+    Vec4 position((gridCenter.x + x * gridSize) / static_cast<float>(TPE_F), 0.0F,
+                  (gridCenter.z + y * gridSize) / static_cast<float>(TPE_F));
+    return static_cast<TPE_Unit>(heightmap->getHeightOffset(position) * TPE_F);
+}
+
+template <typename F>
+void Measure(const char* name, const std::vector<TPE_Vec3>& queries, int runs, F&& env)
+{
+    TPE_Unit sink = 0;
+    double best = BestOf(runs, queries.size(), &sink, [&] {
+        TPE_Unit sum = 0;
+        for (const auto& query : queries)
+        {
+            sum += env(query, TPE_F).y;
+        }
+        return sum;
+    });
+    printf("  %-16s %8.2f ns/query   (checksum %ld)\n", name, best, static_cast<long>(sink / runs));
+}
+
+struct Segment
+{
+    Vec4 from, to;
+};
+
+void MeasureCasts(const char* name, const std::vector<Segment>& segments, int runs)
+{
+    long hits = 0, visits = 0, sink = 0;
+    double best = BestOf(runs, segments.size(), &sink, [&] {
+        hits = visits = 0;
+        HeightmapHit hit;
+        for (const auto& segment : segments)
+        {
+            hits += heightmap->segmentCast(segment.from, segment.to, &hit);
+            visits += hit.nodesVisited;
+        }
+        return hits;
+    });
+
+    // the raymarcher only knows about directions, past the end of the
+    // segment counts as a miss
+    long marchHits = 0;
+    double marchBest = BestOf(runs / 5 + 1, segments.size(), &sink, [&] {
+        marchHits = 0;
+        for (const auto& segment : segments)
+        {
+            TPE_Vec3 from = TPE_vec3(segment.from.x * TPE_F, segment.from.y * TPE_F, segment.from.z * TPE_F);
+            TPE_Vec3 to = TPE_vec3(segment.to.x * TPE_F, segment.to.y * TPE_F, segment.to.z * TPE_F);
+            TPE_Vec3 direction = TPE_vec3Minus(to, from);
+            TPE_Vec3 result = TPE_castEnvironmentRay(from, direction, HeightfieldEnv, TPE_F / 4, TPE_F * 8, 64);
+            marchHits += result.x != TPE_INFINITY && TPE_vec3Len(TPE_vec3Minus(result, from)) <= TPE_vec3Len(direction);
+        }
+        return marchHits;
+    });
+
+    printf("  %-16s segmentCast %8.2f ns, %.1f nodes, %ld hits | castEnvironmentRay %9.2f ns, %ld hits\n", name, best,
+           static_cast<double>(visits) / segments.size(), hits, marchBest, marchHits);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 1 << 18;
+    int runs = 10;
+    std::string path = "level01/heightmap" HEIGHTMAP_FILE_EXTENSION;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) count = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = atoi(argv[++i]);
+        else path = argv[i];
+    }
+
+    std::unique_ptr<Heightmap> map(new Heightmap(path, LEFT_UP, RIGHT_DOWN));
+    if (!map->isLoaded())
+    {
+        path = WriteSyntheticMap(256, "gwc_env_bench");
+        map.reset(new Heightmap(path, LEFT_UP, RIGHT_DOWN));
+        if (!map->isLoaded())
+        {
+            fprintf(stderr, "Can't load %s\n", path.c_str());
+            return 1;
+        }
+    }
+    heightmap = map.get();
+
+    // TPE wants square cells around a center, close enough for timing
+    gridSize = static_cast<TPE_Unit>((RIGHT_DOWN.x - LEFT_UP.x) / map->mapWidth * TPE_F);
+    gridCenter = TPE_vec3(static_cast<TPE_Unit>(LEFT_UP.x * TPE_F) + gridSize / 2, 0,
+                          static_cast<TPE_Unit>(LEFT_UP.z * TPE_F) + gridSize / 2);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> xs(LEFT_UP.x + 1.0F, RIGHT_DOWN.x - 1.0F);
+    std::uniform_real_distribution<float> zs(LEFT_UP.z + 1.0F, RIGHT_DOWN.z - 1.0F);
+    std::uniform_real_distribution<float> over(-0.5F, 3.0F);
+    std::vector<TPE_Vec3> queries(count);
+    for (auto& query : queries)
+    {
+        Vec4 position(xs(random), 0.0F, zs(random));
+        position.y = map->sampleTriangle(position) + over(random);
+        query = TPE_vec3(position.x * TPE_F, position.y * TPE_F, position.z * TPE_F);
+    }
+
+    printf("%s: %dx%d, %zu queries, best of %d\n", path.c_str(), map->mapWidth, map->mapHeight, count, runs);
+
+    Measure("envGround", queries, runs, [](TPE_Vec3 p, TPE_Unit) { return TPE_envGround(p, 0); });
+    Measure("heightfield", queries, runs,
+            [](TPE_Vec3 p, TPE_Unit maxD) { return heightmap->environmentDistance(p, maxD); });
+    Measure("envHeightmap", queries, runs / 5 + 1, [](TPE_Vec3 p, TPE_Unit maxD) {
+        return TPE_envHeightmap(p, gridCenter, gridSize, HeightAtSample, maxD);
+    });
+
+    // every point returned has to be on the surface, or the query itself
+    float worst = 0.0F;
+    for (const auto& query : queries)
+    {
+        TPE_Vec3 closest = heightmap->environmentDistance(query, TPE_F);
+        if (closest.x == query.x && closest.y == query.y && closest.z == query.z) continue;
+        Vec4 point(closest.x / static_cast<float>(TPE_F), closest.y / static_cast<float>(TPE_F),
+                   closest.z / static_cast<float>(TPE_F));
+        float distance = Vec4(query.x, query.y, query.z).distanceTo(Vec4(closest.x, closest.y, closest.z)) / TPE_F;
+        if (distance > 0.99F) continue; // lower bounds, not surface points
+        worst = std::max(worst, std::fabs(point.y - map->sampleTriangle(point)));
+    }
+    printf("  heightfield points off the surface by at most %g\n", worst);
+
+    // casts only hit the triangles between the samples, so stay off the border
+    float margin = (RIGHT_DOWN.x - LEFT_UP.x) / map->mapWidth + 50.0F;
+    xs = std::uniform_real_distribution<float>(LEFT_UP.x + margin, RIGHT_DOWN.x - margin);
+    zs = std::uniform_real_distribution<float>(LEFT_UP.z + margin, RIGHT_DOWN.z - margin);
+    std::uniform_real_distribution<float> angles(0.0F, 6.2831853F);
+    std::uniform_real_distribution<float> heights(2.0F, 20.0F);
+    std::vector<Segment> wheels(count / 16), sights(count / 16);
+    for (auto& wheel : wheels)
+    {
+        Vec4 position(xs(random), 0.0F, zs(random));
+        position.y = map->sampleTriangle(position) + 1.0F;
+        wheel = {position, position - Vec4(0.0F, 2.0F, 0.0F, 0.0F)};
+    }
+    for (auto& sight : sights)
+    {
+        Vec4 from(xs(random), 0.0F, zs(random));
+        float angle = angles(random);
+        Vec4 to(from.x + 50.0F * std::cos(angle), 0.0F, from.z + 50.0F * std::sin(angle));
+        from.y = map->sampleTriangle(from) + heights(random);
+        to.y = map->sampleTriangle(to) + heights(random);
+        sight = {from, to};
+    }
+
+    MeasureCasts("wheel rays", wheels, runs);
+    MeasureCasts("line of sight", sights, runs);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Host micro-benchmark for the Heightmap sampling paths.
+//
+//   heightmap_bench [-n samples] [-r runs] [map.hmp]
+//
+// Without a map (path relative to res/) it generates a 256x256 one. Positions
+// are random but seeded, spread a bit past the map so clamping gets hit too.
+// Reports the best of the runs in ns per sample.
+
+#include "core/heightmap.hpp"
+#include "bench_heightmap.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace bench;
+
+template <typename F>
+double Measure(const char* name, size_t samples, int runs, F&& body)
+{
+    float sink = 0.0F;
+    double best = BestOf(runs, samples, &sink, body);
+    printf("  %-16s %7.2f ns/sample   (checksum %g)\n", name, best, sink / runs);
+    return best;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t samples = 1 << 20;
+    int runs = 10;
+    std::string path;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) samples = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = atoi(argv[++i]);
+        else path = argv[i];
+    }
+
+    if (path.empty())
+    {
+        path = WriteSyntheticMap(256, "gwc_heightmap_bench");
+    }
+
+    Heightmap heightmap(path, LEFT_UP, RIGHT_DOWN);
+    if (!heightmap.isLoaded())
+    {
+        fprintf(stderr, "Can't load %s\n", path.c_str());
+        return 1;
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> xs(LEFT_UP.x - 10.0F, RIGHT_DOWN.x + 10.0F);
+    std::uniform_real_distribution<float> zs(LEFT_UP.z - 10.0F, RIGHT_DOWN.z + 10.0F);
+    std::vector<Vec4> positions(samples);
+    for (auto& position : positions)
+    {
+        position = Vec4(xs(random), 0.0F, zs(random));
+    }
+    std::vector<float> heights(samples);
+
+    printf("%s: %dx%d, %zu samples, best of %d\n", path.c_str(), heightmap.mapWidth, heightmap.mapHeight, samples,
+           runs);
+
+    Measure("nearest", samples, runs, [&] {
+        float sum = 0.0F;
+        for (const auto& position : positions) sum += heightmap.getHeightOffset(position);
+        return sum;
+    });
+    Measure("bilinear", samples, runs, [&] {
+        float sum = 0.0F;
+        for (const auto& position : positions) sum += heightmap.sampleBilinear(position);
+        return sum;
+    });
+    Measure("triangle", samples, runs, [&] {
+        float sum = 0.0F;
+        for (const auto& position : positions) sum += heightmap.sampleTriangle(position);
+        return sum;
+    });
+    Measure("sampleHeights", samples, runs, [&] {
+        heightmap.sampleHeights(positions.data(), heights.data(), samples);
+        return heights[samples / 2];
+    });
+    Measure("normal", samples, runs, [&] {
+        float sum = 0.0F;
+        for (const auto& position : positions) sum += heightmap.sampleNormal(position).y;
+        return sum;
+    });
+
+    // the batch has to agree with the single sample path
+    float maxDifference = 0.0F;
+    for (size_t i = 0; i < samples; i++)
+    {
+        maxDifference = std::max(maxDifference, std::fabs(heights[i] - heightmap.sampleBilinear(positions[i])));
+    }
+    printf("  sampleHeights vs bilinear: max difference %g\n", maxDifference);
+    return maxDifference == 0.0F ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+// Host benchmark of what the profiler costs, and its dump-to-file mode.
+//
+//   profiler_bench [-f frames] [-r runs] [report.txt]
+//
+// Runs a made up frame shaped like the game's: an object tree walked once to
+// update and once to render, with a TPE world of boxes stepped in between.
+// Once with the same zones and physics step stats the game has and once
+// without, the difference is the profiler overhead. That's a fixed cost per
+// zone, so it's also given against a whole 60Hz frame, which is what the
+// game spends. Then writes the profiler report of the instrumented runs to
+// report.txt (host/bin/profile.txt by default).
+
+#include "core/profiler.hpp"
+#include "core/tinyphysicsengine.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int BODIES = 10;
+const int CHILDREN = 4;
+const int DEPTH = 3; // 1 + 4 + 16 + 64 objects, about what level01 has
+
+TPE_World world;
+TPE_Body bodies[BODIES];
+TPE_Joint joints[BODIES * 8];
+TPE_Connection connections[BODIES * 16];
+TPE_WorldStats stats;
+volatile u32 sink;
+
+TPE_Vec3 Environment(TPE_Vec3 position, TPE_Unit maxDistance)
+{
+    return TPE_envGround(position, 0);
+}
+
+void SetupWorld()
+{
+    for (int i = 0; i < BODIES; i++)
+    {
+        TPE_makeBox(joints + i * 8, connections + i * 16, TPE_F, TPE_F, TPE_F, TPE_F / 4);
+        TPE_bodyInit(&bodies[i], joints + i * 8, 8, connections + i * 16, 16, TPE_F);
+        TPE_bodyMoveBy(&bodies[i], TPE_vec3((i % 5) * 2 * TPE_F, (2 + i / 5) * TPE_F, 0));
+        // like the car, otherwise they'd fall asleep and the frame would be empty
+        bodies[i].flags |= TPE_BODY_FLAG_ALWAYS_ACTIVE;
+    }
+    TPE_worldInit(&world, bodies, BODIES, Environment);
+}
+
+// stands in for a component's work, so the walk isn't free either
+void Touch(int node)
+{
+    sink = sink + node;
+}
+
+template <bool Profiled>
+void UpdateNode(int node, int depth)
+{
+    if constexpr (Profiled)
+    {
+        PROFILE_SCOPE("Update");
+        Touch(node);
+        if (depth < DEPTH)
+        {
+            for (int i = 0; i < CHILDREN; i++) UpdateNode<Profiled>(node * CHILDREN + i + 1, depth + 1);
+        }
+    }
+    else
+    {
+        Touch(node);
+        if (depth < DEPTH)
+        {
+            for (int i = 0; i < CHILDREN; i++) UpdateNode<Profiled>(node * CHILDREN + i + 1, depth + 1);
+        }
+    }
+}
+
+template <bool Profiled>
+void RenderNode(int node, int depth)
+{
+    if constexpr (Profiled)
+    {
+        PROFILE_SCOPE("Render");
+        Touch(node);
+        if (depth < DEPTH)
+        {
+            for (int i = 0; i < CHILDREN; i++) RenderNode<Profiled>(node * CHILDREN + i + 1, depth + 1);
+        }
+    }
+    else
+    {
+        Touch(node);
+        if (depth < DEPTH)
+        {
+            for (int i = 0; i < CHILDREN; i++) RenderNode<Profiled>(node * CHILDREN + i + 1, depth + 1);
+        }
+    }
+}
+
+template <bool Profiled>
+void Frame()
+{
+    if constexpr (Profiled)
+    {
+        {
+            PROFILE_SCOPE("Loop");
+            {
+                PROFILE_SCOPE("World");
+                {
+                    PROFILE_SCOPE("Physics");
+                    TPE_worldStep(&world);
+                }
+                PROFILE_COUNT("Env calls", 50, stats.environmentCalls);
+                PROFILE_COUNT("Collision iterations", 5, stats.collisionIterations);
+                PROFILE_COUNT("Reshape passes", 1, stats.reshapePasses);
+                PROFILE_COUNT("Pairs tested", 1, stats.bodyPairsTested);
+                PROFILE_COUNT("Pairs overlapping", 1, stats.bodyPairsOverlapping);
+                PROFILE_COUNT("Joint tests", 10, stats.jointTests);
+                PROFILE_COUNT("Bodies active", 1, stats.bodiesActive);
+            }
+            UpdateNode<Profiled>(0, 0);
+            RenderNode<Profiled>(0, 0);
+        }
+        PROFILE_FRAME();
+    }
+    else
+    {
+        TPE_worldStep(&world);
+        UpdateNode<Profiled>(0, 0);
+        RenderNode<Profiled>(0, 0);
+    }
+}
+
+template <bool Profiled>
+double MeasureFrames(int frames, int runs)
+{
+    double best = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        SetupWorld();
+        world.stats = Profiled ? &stats : nullptr;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            Frame<Profiled>();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / frames;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+double MeasureScope(int count, int runs)
+{
+    static const int zone = Profiler::GetZone("Scope");
+    double best = 1e30;
+    for (int r = 0; r < runs; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            ProfileScope scope(zone);
+            Touch(i);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / count;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 2000;
+    int runs = 5;
+    std::string path = "bin/profile.txt";
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = atoi(argv[++i]);
+        else path = argv[i];
+    }
+
+    double plain = MeasureFrames<false>(frames, runs);
+    double profiled = MeasureFrames<true>(frames, runs);
+    bool written = Profiler::WriteReport(path);
+
+    // the empty loop around a scope is counted too, it's tiny next to the clock
+    double scope = MeasureScope(1000000, runs);
+
+    printf("profiler: %d frames, best of %d\n", frames, runs);
+    printf("  one scope        %8.2f ns\n", scope);
+    printf("  frame            %8.2f us without, %8.2f us with the zones, %+.2f%%\n", plain / 1000.0, profiled / 1000.0,
+           (profiled - plain) * 100.0 / plain);
+    printf("  of a 60Hz frame  %8.4f%%\n", (profiled - plain) * 100.0 / (1e9 / 60.0));
+
+    if (!written)
+    {
+        return 1;
+    }
+    printf("  report written to %s\n", path.c_str());
+    return 0;
+}
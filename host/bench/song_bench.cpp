@@ -0,0 +1,204 @@
+// Host check that SongStream keeps the audio going through long frames.
+//
+//   song_bench [-l seconds] [-b audsrv bytes] [-f frame ms] [-h hitch ms] [-e every n frames]
+//
+// Writes a WAV of silence (44.1kHz, 16 bit stereo, like the game's songs)
+// and plays it through SongStream against a stand-in for audsrv that plays
+// back in real time out of a buffer of -b bytes. The main thread meanwhile
+// runs frames of -f ms calling Update, with a -h ms hitch every -e frames,
+// like a level switch or a bad physics step.
+//
+// Prints how long audsrv sat with nothing to play before the song was over
+// and fails if it did at all. The host schedules threads preemptively on
+// several cores, so this checks that feeding doesn't depend on the main
+// thread, not how the reader's priority works out on the EE.
+
+#include "core/song_stream.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// audsrv stand-in, drains its buffer at the format's byte rate
+struct Device
+{
+    std::mutex mutex;
+    u32 capacity = 8 * 1024;
+    double rate = 0;
+    double queued = 0;
+    Clock::time_point last;
+    u64 played = 0;
+    u64 total = 0;
+    double starved = 0;
+    int underruns = 0;
+    bool dry = false;
+
+    // called with the mutex held
+    void Drain()
+    {
+        auto now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        if (played == 0)
+        {
+            return;
+        }
+
+        double wanted = elapsed * rate;
+        if (wanted > queued && played < total)
+        {
+            if (!dry) underruns++;
+            dry = true;
+            starved += (wanted - queued) / rate;
+        }
+        queued = wanted > queued ? 0 : queued - wanted;
+    }
+};
+
+Device device;
+
+bool WriteSilence(const std::string& path, u32 dataSize)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    auto put32 = [&](u32 v) { u8 b[4] = {u8(v), u8(v >> 8), u8(v >> 16), u8(v >> 24)}; fwrite(b, 1, 4, file); };
+    auto put16 = [&](u16 v) { u8 b[2] = {u8(v), u8(v >> 8)}; fwrite(b, 1, 2, file); };
+    fwrite("RIFF", 1, 4, file);
+    put32(36 + dataSize);
+    fwrite("WAVEfmt ", 1, 8, file);
+    put32(16);
+    put16(1);
+    put16(2);
+    put32(44100);
+    put32(44100 * 4);
+    put16(4);
+    put16(16);
+    fwrite("data", 1, 4, file);
+    put32(dataSize);
+    std::vector<u8> zeros(dataSize);
+    fwrite(zeros.data(), 1, zeros.size(), file);
+    return fclose(file) == 0;
+}
+
+}
+
+int audsrv_set_format(struct audsrv_fmt_t* fmt)
+{
+    std::lock_guard<std::mutex> lock(device.mutex);
+    device.rate = static_cast<double>(fmt->freq) * fmt->channels * fmt->bits / 8;
+    device.last = Clock::now();
+    return 0;
+}
+
+int audsrv_set_volume(int volume) { return 0; }
+
+int audsrv_available()
+{
+    std::lock_guard<std::mutex> lock(device.mutex);
+    device.Drain();
+    return device.capacity - static_cast<u32>(device.queued);
+}
+
+int audsrv_play_audio(const char* chunk, int bytes)
+{
+    std::lock_guard<std::mutex> lock(device.mutex);
+    device.Drain();
+    device.queued += bytes;
+    device.played += bytes;
+    device.dry = false;
+    return bytes;
+}
+
+int audsrv_wait_audio(int bytes)
+{
+    while (true)
+    {
+        double left;
+        {
+            std::lock_guard<std::mutex> lock(device.mutex);
+            device.Drain();
+            left = device.queued + bytes - device.capacity;
+            if (left <= 0) return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(left / device.rate));
+    }
+}
+
+int audsrv_stop_audio() { return 0; }
+
+int main(int argc, char** argv)
+{
+    float seconds = 3.0F;
+    int frameMs = 20;
+    int hitchMs = 300;
+    int every = 25;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-l") && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) device.capacity = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) frameMs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc) hitchMs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) every = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-l seconds] [-b audsrv bytes] [-f frame ms] [-h hitch ms] [-e every n frames]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (seconds <= 0 || device.capacity < 1024 || frameMs < 0 || hitchMs < 0 || every < 1)
+    {
+        fprintf(stderr, "Need a song, a 1 KB buffer and frames that don't run backwards\n");
+        return 1;
+    }
+
+    auto path = (std::filesystem::temp_directory_path() / "song_bench.wav").string();
+    device.total = static_cast<u32>(seconds * 44100) * 4;
+    if (!WriteSilence(path, device.total))
+    {
+        fprintf(stderr, "Can't write %s\n", path.c_str());
+        return 1;
+    }
+
+    SongStream music;
+    if (!music.Load(path))
+    {
+        return 1;
+    }
+    music.Play();
+
+    auto start = Clock::now();
+    int frames = 0;
+    while (music.IsPlaying())
+    {
+        music.Update();
+        frames++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(frames % every ? frameMs : hitchMs));
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    music.Stop();
+    std::filesystem::remove(path);
+
+    printf("song: %.1f s, audsrv buffer %u bytes (%.0f ms), %d ms frames, %d ms hitch every %d\n", seconds,
+           device.capacity, device.capacity * 1000.0 / device.rate, frameMs, hitchMs, every);
+    printf("  %d frames over %.2f s, starved %.1f ms in %d underruns\n", frames, wall, device.starved * 1000.0,
+           device.underruns);
+    if (device.starved > 0)
+    {
+        fprintf(stderr, "Audio ran dry\n");
+        return 1;
+    }
+    return 0;
+}
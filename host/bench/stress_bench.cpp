@@ -0,0 +1,341 @@
+// Host benchmark of how the physics step scales with the number of bodies.
+//
+//   stress_bench [-n 10,100,...] [-m vehicles] [-k ticks] [-e ground|bumps|arena] [-s seed] [-c] [-d run.det]
+//
+// For every n builds a TPE world of n bodies of mixed shapes (boxes, the
+// car's center rect, two joint lines and single spheres) plus m vehicles
+// built and driven like Car, drops them on the environment and steps it
+// k times, pulling every body down by the levels' default gravity first like
+// PhysicsComponent does. The world in the game stops at 10 bodies, this is
+// for seeing what broadphase, pooling or solver changes do well past that.
+//
+// Bodies get spread over a grid growing with n, so the density stays about
+// the same. Environments:
+//   ground  flat ground, what the old levels had
+//   bumps   ground with a half buried ball in every 8x8 cell
+//   arena   the inside of a box around the scene, floor and walls
+//
+// Reports the step time (mean and percentiles over the k steps), the body
+// pairs tested per step and the share of bodies asleep, over the run and at
+// the end. Vehicles never sleep, like the car.
+//
+// -c turns on TPE_BODY_FLAG_CCD for every body, the vehicles have it anyway
+// like the car. "swept" is how many joints per step were fast enough for it.
+//
+// -d logs the world hash of every step there, one segment per n, for
+// determinism_compare. Also prints what logging costs per step, it only
+// rehashes the bodies that are awake, and fails if that hash ever differs
+// from TPE_worldHash of the whole world.
+
+#include "core/tinyphysicsengine.hpp"
+#include "core/determinism_log.hpp"
+#include "bench_vehicle.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace bench;
+
+const TPE_Unit CELL = 4 * TPE_F;
+
+enum Shape
+{
+    SHAPE_BOX,
+    SHAPE_RECT,
+    SHAPE_LINE,
+    SHAPE_SPHERE,
+    SHAPE_VEHICLE,
+};
+
+// joints and connections each shape takes
+const int SHAPE_JOINTS[] = {8, 5, 2, 1, 5};
+const int SHAPE_CONNECTIONS[] = {16, 10, 1, 0, 10};
+
+struct Scene
+{
+    TPE_World world;
+    std::vector<TPE_Body> bodies;
+    std::vector<TPE_Joint> joints;
+    std::vector<TPE_Connection> connections;
+    std::vector<int> vehicles;
+    std::vector<uint8_t> contacts; // joints touching the environment, bit per joint
+    TPE_WorldStats stats;
+};
+
+struct Result
+{
+    int bodies;
+    double mean, p50, p90, p99, max;
+    double pairs;
+    double asleep, asleepAtEnd;
+    double swept;
+    double logging;
+    int hashMismatches;
+};
+
+Scene* current;
+TPE_Unit arenaSize;
+
+TPE_Vec3 GroundEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    return TPE_envGround(point, 0);
+}
+
+TPE_Vec3 ArenaEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    return TPE_envAABoxInside(point, TPE_vec3(0, 10 * TPE_F, 0), TPE_vec3(arenaSize, 20 * TPE_F, arenaSize));
+}
+
+int CollisionCallback(int b1, int j1, int b2, int j2, TPE_Vec3 p)
+{
+    if (b1 == b2)
+    {
+        current->contacts[b1] |= 1 << j1;
+    }
+    return 1;
+}
+
+void BuildScene(Scene* scene, int bodyCount, int vehicleCount, TPE_ClosestPointFunction env, bool ccd, std::mt19937& generator)
+{
+    // every fourth body of each shape, the vehicles mixed in anywhere
+    std::vector<Shape> shapes;
+    for (int i = 0; i < bodyCount; i++)
+    {
+        shapes.push_back(static_cast<Shape>(i % 4));
+    }
+    shapes.insert(shapes.end(), vehicleCount, SHAPE_VEHICLE);
+    std::shuffle(shapes.begin(), shapes.end(), generator);
+
+    int jointCount = 0, connectionCount = 0;
+    for (Shape shape : shapes)
+    {
+        jointCount += SHAPE_JOINTS[shape];
+        connectionCount += SHAPE_CONNECTIONS[shape];
+    }
+    // the bodies point into these, they can't move after
+    scene->bodies.assign(shapes.size(), TPE_Body());
+    scene->joints.assign(jointCount, TPE_Joint());
+    scene->connections.assign(connectionCount + 1, TPE_Connection());
+    scene->contacts.assign(shapes.size(), 0);
+    scene->vehicles.clear();
+
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(shapes.size()))));
+    arenaSize = (side + 2) * CELL;
+    std::uniform_int_distribution<TPE_Unit> jitter(-CELL / 8, CELL / 8);
+    std::uniform_int_distribution<TPE_Unit> heights(TPE_F, 4 * TPE_F);
+    std::uniform_int_distribution<TPE_Unit> angles(0, TPE_F);
+
+    TPE_Joint* joints = scene->joints.data();
+    TPE_Connection* connections = scene->connections.data();
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        TPE_Body* body = &scene->bodies[i];
+        switch (shapes[i])
+        {
+            case SHAPE_BOX:
+                TPE_makeBox(joints, connections, TPE_F, TPE_F, TPE_F, TPE_F / 4);
+                TPE_bodyInit(body, joints, 8, connections, 16, TPE_F);
+                break;
+            case SHAPE_RECT:
+                TPE_makeCenterRectFull(joints, connections, 3 * TPE_F / 2, 2 * TPE_F, TPE_F / 3);
+                TPE_bodyInit(body, joints, 5, connections, 10, TPE_F);
+                break;
+            case SHAPE_LINE:
+                TPE_make2Line(joints, connections, 2 * TPE_F, TPE_F / 3);
+                TPE_bodyInit(body, joints, 2, connections, 1, TPE_F);
+                break;
+            case SHAPE_SPHERE:
+                joints[0] = TPE_joint(TPE_vec3(0, 0, 0), TPE_F / 2);
+                TPE_bodyInit(body, joints, 1, connections, 0, TPE_F);
+                break;
+            case SHAPE_VEHICLE:
+                MakeVehicle(body, joints, connections);
+                scene->vehicles.push_back(static_cast<int>(i));
+                break;
+        }
+        joints += SHAPE_JOINTS[shapes[i]];
+        connections += SHAPE_CONNECTIONS[shapes[i]];
+
+        if (ccd)
+        {
+            body->flags |= TPE_BODY_FLAG_CCD;
+        }
+        if (shapes[i] != SHAPE_VEHICLE)
+        {
+            TPE_bodyRotateByAxis(body, TPE_vec3(angles(generator), angles(generator), angles(generator)));
+        }
+        TPE_Unit x = (static_cast<int>(i) % side - side / 2) * CELL + jitter(generator);
+        TPE_Unit z = (static_cast<int>(i) / side - side / 2) * CELL + jitter(generator);
+        TPE_bodyMoveTo(body, TPE_vec3(x, 0, z));
+        TPE_Vec3 surface = env(TPE_bodyGetCenterOfMass(body), 8 * TPE_F);
+        TPE_bodyMoveTo(body, TPE_vec3(x, surface.y + 2 * TPE_F + heights(generator), z));
+    }
+
+    TPE_worldInit(&scene->world, scene->bodies.data(), static_cast<uint16_t>(shapes.size()), env);
+    scene->world.collisionCallback = CollisionCallback;
+    scene->world.stats = &scene->stats;
+}
+
+double Percentile(std::vector<double> sorted, double p)
+{
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+Result Run(int bodyCount, int vehicleCount, int ticks, TPE_ClosestPointFunction env, bool ccd, unsigned seed, DeterminismLog* log)
+{
+    Scene scene;
+    std::mt19937 generator(seed);
+    BuildScene(&scene, bodyCount, vehicleCount, env, ccd, generator);
+    current = &scene;
+
+    std::vector<double> times(ticks);
+    double pairs = 0.0, asleep = 0.0, swept = 0.0, logging = 0.0;
+    int hashMismatches = 0;
+    if (log)
+    {
+        log->StartSegment();
+    }
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        for (size_t i = 0; i < scene.vehicles.size(); i++)
+        {
+            int index = scene.vehicles[i];
+            // steering the whole time so they go around in circles instead
+            // of leaving the scene
+            DriveVehicle(&scene.bodies[index], scene.contacts[index], 1.0f, 1 + i % 2);
+        }
+        std::fill(scene.contacts.begin(), scene.contacts.end(), 0);
+
+        auto start = std::chrono::steady_clock::now();
+        // like PhysicsComponent::Update, on every body, before the step
+        for (auto& body : scene.bodies)
+        {
+            TPE_bodyApplyGravity(&body, GRAVITY);
+        }
+        TPE_worldStep(&scene.world);
+        times[tick] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (log)
+        {
+            start = std::chrono::steady_clock::now();
+            u32 hash = log->Record(&scene.world);
+            logging += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            hashMismatches += hash != TPE_worldHash(&scene.world);
+        }
+
+        pairs += scene.stats.bodyPairsTested;
+        asleep += scene.stats.bodiesAsleep;
+        swept += scene.stats.jointsSwept;
+    }
+
+    Result result;
+    result.bodies = bodyCount;
+    result.mean = 0.0;
+    for (double time : times) result.mean += time;
+    result.mean /= ticks;
+    result.p50 = Percentile(times, 0.50);
+    result.p90 = Percentile(times, 0.90);
+    result.p99 = Percentile(times, 0.99);
+    result.max = *std::max_element(times.begin(), times.end());
+    result.pairs = pairs / ticks;
+    result.asleep = asleep / ticks / scene.bodies.size();
+    result.asleepAtEnd = static_cast<double>(scene.stats.bodiesAsleep) / scene.bodies.size();
+    result.swept = swept / ticks;
+    result.logging = logging / ticks;
+    result.hashMismatches = hashMismatches;
+    current = nullptr;
+    return result;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> counts = {10, 30, 100, 300, 1000};
+    int vehicles = 4;
+    int ticks = 300;
+    unsigned seed = 1;
+    std::string envName = "ground";
+    std::string logPath;
+    bool ccd = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            counts.clear();
+            for (char* count = strtok(argv[++i], ","); count; count = strtok(nullptr, ",")) counts.push_back(atoi(count));
+        }
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) vehicles = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) envName = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-c")) ccd = true;
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) logPath = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [-n 10,100,...] [-m vehicles] [-k ticks] [-e ground|bumps|arena] [-s seed] [-c] [-d run.det]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TPE_ClosestPointFunction env;
+    if (envName == "ground") env = GroundEnv;
+    else if (envName == "bumps") env = BumpsEnv;
+    else if (envName == "arena") env = ArenaEnv;
+    else
+    {
+        fprintf(stderr, "Unknown environment %s\n", envName.c_str());
+        return 1;
+    }
+    if (ticks < 1 || vehicles < 0)
+    {
+        fprintf(stderr, "Need at least one tick\n");
+        return 1;
+    }
+    for (int count : counts)
+    {
+        if (count < 0 || count + vehicles > 65535)
+        {
+            fprintf(stderr, "A world takes 0 to 65535 bodies, not %d\n", count + vehicles);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<DeterminismLog> log;
+    if (!logPath.empty() && !(log = DeterminismLog::Create(logPath)))
+    {
+        return 1;
+    }
+
+    printf("stress: %s, %d vehicles, %d ticks, seed %u%s\n", envName.c_str(), vehicles, ticks, seed, ccd ? ", ccd" : "");
+    printf("  %6s %9s %9s %9s %9s %9s %10s %8s %8s %7s\n", "bodies", "mean ms", "p50", "p90", "p99", "max", "pairs", "asleep",
+           "at end", "swept");
+    int hashMismatches = 0;
+    for (int count : counts)
+    {
+        Result r = Run(count, vehicles, ticks, env, ccd, seed, log.get());
+        printf("  %6d %9.3f %9.3f %9.3f %9.3f %9.3f %10.0f %7.1f%% %7.1f%% %7.1f\n", r.bodies, r.mean, r.p50, r.p90, r.p99,
+               r.max, r.pairs, r.asleep * 100.0, r.asleepAtEnd * 100.0, r.swept);
+        if (log)
+        {
+            printf("  %6s %9.3f ms logging, %d steps hashed wrong\n", "", r.logging, r.hashMismatches);
+            hashMismatches += r.hashMismatches;
+        }
+    }
+    if (hashMismatches)
+    {
+        fprintf(stderr, "The logged hash isn't the world's\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+// Host check of TiledHeightmap against Heightmap on the same terrain.
+//
+//   tiled_bench [-n casts] [-c tile cells] [-r runs]
+//
+// Writes one generated map both ways, a .hmp and a .hmt with tiles that
+// don't divide the map evenly, so the last row and column of tiles are
+// short. Sample (x, z) ends up at the same spot in both.
+//
+// Before any tile is resident the tiled map answers from its overview, which
+// has to hit every tile corner exactly, the map's far edge too. Once all of
+// it is resident, sampleTriangle and every kind of cast have to agree with
+// Heightmap's. Prints the worst differences and how long the casts took, and
+// fails if they're off.
+//
+// Then drives across the map and back on a map keeping the default number of
+// tiles resident, calling Update once a frame like Level01 does, with the
+// profiler's allocation budget at 0 like gwc_headless -b 0. Aborts if a
+// settled frame allocates.
+
+#include "core/heightmap.hpp"
+#include "core/tiled_heightmap.hpp"
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const u32 WIDTH = 250;
+const u32 HEIGHT = 190;
+const float MIN_HEIGHT = 0.0F;
+const float MAX_HEIGHT = 60.0F;
+const Vec4 LEFT_UP(-400.0F, 0.0F, -300.0F);
+const Vec4 RIGHT_DOWN(350.0F, 0.0F, 270.0F);
+
+std::vector<u16> Generate()
+{
+    std::vector<u16> heights(WIDTH * HEIGHT);
+    for (u32 z = 0; z < HEIGHT; z++)
+    {
+        for (u32 x = 0; x < WIDTH; x++)
+        {
+            float h = 0.5F + 0.25F * std::sin(x * 0.11F) + 0.25F * std::cos(z * 0.13F + x * 0.03F);
+            heights[z * WIDTH + x] = static_cast<u16>(h * HEIGHTMAP_FILE_MAX_VALUE);
+        }
+    }
+    return heights;
+}
+
+std::string WriteWhole(const std::vector<u16>& heights)
+{
+    HeightmapFileHeader header = {};
+    header.magic = HEIGHTMAP_FILE_MAGIC;
+    header.version = HEIGHTMAP_FILE_VERSION;
+    header.width = WIDTH;
+    header.height = HEIGHT;
+    header.minHeight = MIN_HEIGHT;
+    header.maxHeight = MAX_HEIGHT;
+    header.totalSize = HeightmapFileSize(WIDTH, HEIGHT);
+
+    std::string path = std::string(P_tmpdir) + "/gwc_tiled_bench" HEIGHTMAP_FILE_EXTENSION;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return "";
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(heights.data(), sizeof(u16), heights.size(), file);
+    fclose(file);
+    return path;
+}
+
+// the same layout tools/hmapconv -t writes
+std::string WriteTiled(const std::vector<u16>& heights, u32 tileCells)
+{
+    HeightmapTiledHeader header = {};
+    header.magic = HEIGHTMAP_TILED_MAGIC;
+    header.version = HEIGHTMAP_TILED_VERSION;
+    header.width = WIDTH;
+    header.height = HEIGHT;
+    header.tileCells = tileCells;
+    header.tilesX = (WIDTH - 2) / tileCells + 1;
+    header.tilesZ = (HEIGHT - 2) / tileCells + 1;
+    header.minHeight = MIN_HEIGHT;
+    header.maxHeight = MAX_HEIGHT;
+    header.cellSizeX = (RIGHT_DOWN.x - LEFT_UP.x) / WIDTH;
+    header.cellSizeZ = (RIGHT_DOWN.z - LEFT_UP.z) / HEIGHT;
+    header.originX = LEFT_UP.x + header.cellSizeX / 2;
+    header.originZ = LEFT_UP.z + header.cellSizeZ / 2;
+    header.totalSize = HeightmapTiledFileSize(header.tilesX, header.tilesZ, tileCells);
+
+    auto sample = [&](u32 x, u32 z) { return heights[std::min(z, HEIGHT - 1) * WIDTH + std::min(x, WIDTH - 1)]; };
+
+    std::vector<HeightmapTileBounds> tileBounds;
+    std::vector<u16> overview, tiles;
+    for (u32 tz = 0; tz < header.tilesZ; tz++)
+    {
+        for (u32 tx = 0; tx < header.tilesX; tx++)
+        {
+            HeightmapTileBounds range = {HEIGHTMAP_FILE_MAX_VALUE, 0};
+            for (u32 z = 0; z <= tileCells; z++)
+            {
+                for (u32 x = 0; x <= tileCells; x++)
+                {
+                    u16 value = sample(tx * tileCells + x, tz * tileCells + z);
+                    range.min = std::min(range.min, value);
+                    range.max = std::max(range.max, value);
+                    tiles.push_back(value);
+                }
+            }
+            tileBounds.push_back(range);
+        }
+    }
+    for (u32 tz = 0; tz <= header.tilesZ; tz++)
+    {
+        for (u32 tx = 0; tx <= header.tilesX; tx++)
+        {
+            overview.push_back(sample(tx * tileCells, tz * tileCells));
+        }
+    }
+
+    std::string path = std::string(P_tmpdir) + "/gwc_tiled_bench" HEIGHTMAP_TILED_EXTENSION;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return "";
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(tileBounds.data(), sizeof(HeightmapTileBounds), tileBounds.size(), file);
+    fwrite(overview.data(), sizeof(u16), overview.size(), file);
+    fwrite(tiles.data(), sizeof(u16), tiles.size(), file);
+    fclose(file);
+    return path;
+}
+
+Vec4 SamplePosition(u32 x, u32 z)
+{
+    float cellX = (RIGHT_DOWN.x - LEFT_UP.x) / WIDTH;
+    float cellZ = (RIGHT_DOWN.z - LEFT_UP.z) / HEIGHT;
+    return Vec4(LEFT_UP.x + (x + 0.5F) * cellX, 0.0F, LEFT_UP.z + (z + 0.5F) * cellZ);
+}
+
+struct Cast
+{
+    Vec4 from, to;
+    float radius;
+};
+
+struct Agreement
+{
+    int hits = 0;
+    int mismatches = 0;
+    float worst = 0.0F;
+    double wholeNs = 0.0, tiledNs = 0.0;
+};
+
+Agreement Compare(const Heightmap& whole, const TiledHeightmap& tiled, const std::vector<Cast>& casts, int runs)
+{
+    Agreement result;
+    for (const auto& cast : casts)
+    {
+        HeightmapHit a, b;
+        bool hitA = whole.sphereCast(cast.from, cast.to, cast.radius, &a);
+        bool hitB = tiled.SphereCast(cast.from, cast.to, cast.radius, &b);
+        result.hits += hitA;
+        if (hitA != hitB)
+        {
+            result.mismatches++;
+        }
+        else if (hitA)
+        {
+            result.worst = std::max(result.worst, std::fabs(a.distance - b.distance));
+        }
+    }
+
+    result.wholeNs = result.tiledNs = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        int sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& cast : casts) sink += whole.sphereCast(cast.from, cast.to, cast.radius);
+        auto middle = std::chrono::steady_clock::now();
+        for (const auto& cast : casts) sink += tiled.SphereCast(cast.from, cast.to, cast.radius);
+        auto end = std::chrono::steady_clock::now();
+        result.wholeNs = std::min(result.wholeNs, std::chrono::duration<double, std::nano>(middle - start).count() / casts.size());
+        result.tiledNs = std::min(result.tiledNs, std::chrono::duration<double, std::nano>(end - middle).count() / casts.size());
+        if (sink < 0) printf("\n");
+    }
+    return result;
+}
+
+// Returns how many tiles the streamed map had resident at the end
+int Stream(const std::string& path, int frames)
+{
+    TiledHeightmap streamed(path);
+    Profiler::SetAllocBudget(0, true);
+    Vec4 first = SamplePosition(0, 0), last = SamplePosition(WIDTH - 1, HEIGHT - 1);
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // corner to corner and back, twice
+        float along = 0.5F - 0.5F * std::cos(frame * 4.0F * 3.1415927F / frames);
+        streamed.Update(first + (last - first) * along);
+        Profiler::EndFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Profiler::SetAllocBudget(-1, false);
+
+    int resident = 0;
+    for (u32 z = 0; z < HEIGHT; z += 4)
+    {
+        for (u32 x = 0; x < WIDTH; x += 4)
+        {
+            resident += streamed.IsResident(SamplePosition(x, z));
+        }
+    }
+    return resident;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 1 << 14;
+    u32 tileCells = 32;
+    int runs = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) count = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) tileCells = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = std::max(1, atoi(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: %s [-n casts] [-c tile cells] [-r runs]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (tileCells < 1 || tileCells > 128)
+    {
+        fprintf(stderr, "Tiles take 1 to 128 cells, not %u\n", tileCells);
+        return 1;
+    }
+
+    auto heights = Generate();
+    std::string wholePath = WriteWhole(heights);
+    std::string tiledPath = WriteTiled(heights, tileCells);
+    Heightmap whole(wholePath, LEFT_UP, RIGHT_DOWN);
+    u32 tilesX = (WIDTH - 2) / tileCells + 1;
+    u32 tilesZ = (HEIGHT - 2) / tileCells + 1;
+    TiledHeightmap tiled(tiledPath, tilesX * tilesZ);
+    if (!whole.isLoaded() || !tiled.IsLoaded())
+    {
+        fprintf(stderr, "Can't load the generated maps\n");
+        return 1;
+    }
+    printf("%ux%u, %ux%u tiles of %u cells, the last ones %u x %u\n", WIDTH, HEIGHT, tilesX, tilesZ, tileCells,
+           WIDTH - 1 - (tilesX - 1) * tileCells, HEIGHT - 1 - (tilesZ - 1) * tileCells);
+
+    // nothing is resident yet, every tile corner comes off the overview
+    const float heightScale = (MAX_HEIGHT - MIN_HEIGHT) / HEIGHTMAP_FILE_MAX_VALUE;
+    float overviewWorst = 0.0F;
+    for (u32 tz = 0; tz <= tilesZ; tz++)
+    {
+        for (u32 tx = 0; tx <= tilesX; tx++)
+        {
+            u32 x = std::min(tx * tileCells, WIDTH - 1), z = std::min(tz * tileCells, HEIGHT - 1);
+            float expected = MIN_HEIGHT + heights[z * WIDTH + x] * heightScale;
+            overviewWorst = std::max(overviewWorst, std::fabs(tiled.SampleBilinear(SamplePosition(x, z)) - expected));
+        }
+    }
+    printf("  overview off the tile corners by at most %g\n", overviewWorst);
+
+    // then all of it
+    Vec4 center = (LEFT_UP + RIGHT_DOWN) * 0.5F;
+    for (int wait = 0;; wait++)
+    {
+        tiled.Update(center, std::max(tilesX, tilesZ));
+        bool all = true;
+        for (u32 tz = 0; tz < tilesZ; tz++)
+        {
+            for (u32 tx = 0; tx < tilesX; tx++)
+            {
+                all = all && tiled.IsResident(SamplePosition(std::min(tx * tileCells, WIDTH - 1), std::min(tz * tileCells, HEIGHT - 1)));
+            }
+        }
+        if (all) break;
+        if (wait == 1000)
+        {
+            fprintf(stderr, "Tiles never got resident\n");
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // casts only hit between the samples, keep the random ones inside them
+    Vec4 first = SamplePosition(0, 0), last = SamplePosition(WIDTH - 1, HEIGHT - 1);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> xs(first.x + 1.0F, last.x - 1.0F);
+    std::uniform_real_distribution<float> zs(first.z + 1.0F, last.z - 1.0F);
+    std::uniform_real_distribution<float> angles(0.0F, 6.2831853F);
+    std::uniform_real_distribution<float> above(2.0F, 20.0F);
+
+    float sampleWorst = 0.0F;
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec4 position(xs(random), 0.0F, zs(random));
+        sampleWorst = std::max(sampleWorst, std::fabs(whole.sampleTriangle(position) - tiled.SampleTriangle(position)));
+    }
+    printf("  sampleTriangle differs by at most %g\n", sampleWorst);
+
+    std::vector<Cast> wheels(count), sights(count), spheres(count);
+    for (auto& wheel : wheels)
+    {
+        Vec4 position(xs(random), 0.0F, zs(random));
+        position.y = whole.sampleTriangle(position) + 1.0F;
+        wheel = {position, position - Vec4(0.0F, 2.0F, 0.0F, 0.0F), 0.0F};
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec4 from(xs(random), 0.0F, zs(random));
+        float angle = angles(random);
+        Vec4 to(from.x + 50.0F * std::cos(angle), 0.0F, from.z + 50.0F * std::sin(angle));
+        to.x = std::min(std::max(to.x, first.x + 1.0F), last.x - 1.0F);
+        to.z = std::min(std::max(to.z, first.z + 1.0F), last.z - 1.0F);
+        from.y = whole.sampleTriangle(from) + above(random);
+        to.y = whole.sampleTriangle(to) + above(random);
+        sights[i] = {from, to, 0.0F};
+        spheres[i] = {from, to, 1.5F};
+    }
+
+    bool agree = overviewWorst < 1e-3F && sampleWorst < 1e-3F;
+    const char* names[] = {"wheel rays", "line of sight", "sphere casts"};
+    const std::vector<Cast>* sets[] = {&wheels, &sights, &spheres};
+    for (int i = 0; i < 3; i++)
+    {
+        auto result = Compare(whole, tiled, *sets[i], runs);
+        printf("  %-14s %6d hits, %d disagree, distances off by at most %g | Heightmap %8.2f ns, tiled %8.2f ns\n",
+               names[i], result.hits, result.mismatches, result.worst, result.wholeNs, result.tiledNs);
+        agree = agree && result.mismatches == 0 && result.worst < 1e-3F;
+    }
+
+    const int frames = 600;
+    int resident = Stream(tiledPath, frames);
+    printf("  streamed %d frames without allocating, %d of %u probed samples resident at the end\n", frames, resident,
+           ((WIDTH + 3) / 4) * ((HEIGHT + 3) / 4));
+
+    remove(wholePath.c_str());
+    remove(tiledPath.c_str());
+    if (!agree)
+    {
+        fprintf(stderr, "The tiled map doesn't match the whole one\n");
+        return 1;
+    }
+    return 0;
+}
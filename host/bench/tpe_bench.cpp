@@ -0,0 +1,340 @@
+// Host micro benchmarks of the hot TPE primitives, one at a time.
+//
+//   tpe_bench [-n ops] [-r runs] [-s seed] [-j out.json] [-b baseline.json] [-t percent]
+//
+// Every benchmark runs its op over n seeded random inputs, r times, and
+// reports the mean ns/op over the runs with its standard deviation and the
+// fastest run. Ops that change their inputs (collisions, reshaping) get them
+// reset between runs, outside of the timing.
+//
+// -j writes the results as JSON, -b reads such a file back and prints how
+// far each benchmark's fastest run moved against it. With -t too, a
+// benchmark whose fastest run got slower by more than that many percent
+// makes the exit code 2, but only if its mean moved by more than both
+// stddevs together, so one noisy run doesn't fail the gate. A stored
+// baseline can gate changes:
+//
+//   bin/tpe_bench -j baseline.json
+//   ... change TPE ...
+//   bin/tpe_bench -b baseline.json -t 5
+
+#include "core/tinyphysicsengine.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result
+{
+    std::string name;
+    double mean;
+    double stddev;
+    double min;
+};
+
+int ops = 4096;
+int runs = 15;
+volatile int64_t sink;
+std::mt19937 generator;
+
+TPE_Unit RandomUnit(TPE_Unit from, TPE_Unit to)
+{
+    return std::uniform_int_distribution<TPE_Unit>(from, to)(generator);
+}
+
+TPE_Vec3 RandomVec3(TPE_Unit range)
+{
+    return TPE_vec3(RandomUnit(-range, range), RandomUnit(-range, range), RandomUnit(-range, range));
+}
+
+void Consume(TPE_Vec3 v)
+{
+    sink = sink + v.x + v.y + v.z;
+}
+
+TPE_Vec3 Ground(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    return TPE_envGround(point, 0);
+}
+
+TPE_Unit HeightAt(int32_t x, int32_t y)
+{
+    return static_cast<TPE_Unit>((std::sin(x * 0.7F) + std::cos(y * 0.45F)) * TPE_F / 2);
+}
+
+// op(i) for i in [0, ops), reset() before every run
+template <typename Reset, typename Op>
+Result Measure(const char* name, Reset reset, Op op)
+{
+    std::vector<double> times;
+    for (int r = 0; r < runs; r++)
+    {
+        reset();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++)
+        {
+            op(i);
+        }
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count() / ops);
+    }
+
+    Result result = {name, 0.0, 0.0, times[0]};
+    for (double t : times)
+    {
+        result.mean += t;
+        if (t < result.min) result.min = t;
+    }
+    result.mean /= times.size();
+    for (double t : times)
+    {
+        result.stddev += (t - result.mean) * (t - result.mean);
+    }
+    result.stddev = std::sqrt(result.stddev / times.size());
+    return result;
+}
+
+template <typename Op>
+Result Measure(const char* name, Op op)
+{
+    return Measure(name, [] {}, op);
+}
+
+std::vector<Result> RunAll()
+{
+    std::vector<Result> results;
+
+    std::vector<TPE_Unit> units(ops), angles(ops), ratios(ops);
+    std::vector<TPE_Vec3> vectors(ops), points(ops), work(ops);
+    for (int i = 0; i < ops; i++)
+    {
+        units[i] = RandomUnit(0, 1 << 20);
+        angles[i] = RandomUnit(-4 * TPE_F, 4 * TPE_F);
+        ratios[i] = RandomUnit(-8 * TPE_F, 8 * TPE_F);
+        vectors[i] = RandomVec3(4 * TPE_F);
+        points[i] = RandomVec3(6 * TPE_F);
+    }
+
+    results.push_back(Measure("TPE_sqrt", [&](int i) { sink = sink + TPE_sqrt(units[i]); }));
+    results.push_back(Measure("TPE_vec3Len", [&](int i) { sink = sink + TPE_vec3Len(vectors[i]); }));
+    results.push_back(Measure("TPE_vec3Normalize", [&] { work = vectors; }, [&](int i) {
+        TPE_vec3Normalize(&work[i]);
+        Consume(work[i]);
+    }));
+    results.push_back(Measure("TPE_sin", [&](int i) { sink = sink + TPE_sin(angles[i]); }));
+    results.push_back(Measure("TPE_atan", [&](int i) { sink = sink + TPE_atan(ratios[i]); }));
+
+    // overlapping joint pairs, moving a bit
+    std::vector<TPE_Joint> pairs(ops * 2), pairsWork;
+    for (int i = 0; i < ops; i++)
+    {
+        TPE_Vec3 position = RandomVec3(8 * TPE_F);
+        TPE_Vec3 offset = RandomVec3(TPE_F / 4);
+        pairs[i * 2] = TPE_joint(position, TPE_F / 4);
+        pairs[i * 2 + 1] = TPE_joint(TPE_vec3Plus(position, offset), TPE_F / 4);
+        for (int k = 0; k < 3; k++)
+        {
+            pairs[i * 2].velocity[k] = RandomUnit(-TPE_F / 16, TPE_F / 16);
+            pairs[i * 2 + 1].velocity[k] = RandomUnit(-TPE_F / 16, TPE_F / 16);
+        }
+    }
+    results.push_back(Measure("TPE_jointsResolveCollision", [&] { pairsWork = pairs; }, [&](int i) {
+        sink = sink + TPE_jointsResolveCollision(&pairsWork[i * 2], &pairsWork[i * 2 + 1], TPE_F, TPE_F, TPE_F / 2, TPE_F / 2, Ground);
+    }));
+
+    // joints sunk into the ground, falling
+    std::vector<TPE_Joint> sunk(ops), sunkWork;
+    for (int i = 0; i < ops; i++)
+    {
+        TPE_Vec3 position = RandomVec3(8 * TPE_F);
+        position.y = RandomUnit(-TPE_F / 8, TPE_F / 8);
+        sunk[i] = TPE_joint(position, TPE_F / 4);
+        sunk[i].velocity[1] = -RandomUnit(0, TPE_F / 8);
+    }
+    results.push_back(Measure("TPE_jointEnvironmentResolveCollision", [&] { sunkWork = sunk; }, [&](int i) {
+        sink = sink + TPE_jointEnvironmentResolveCollision(&sunkWork[i], TPE_F / 2, TPE_F / 2, Ground);
+    }));
+
+    // boxes off the ground, their joints knocked out of shape
+    std::vector<TPE_Joint> boxJoints(ops * 8), boxJointsWork;
+    std::vector<TPE_Connection> boxConnections(ops * 16);
+    std::vector<TPE_Body> boxes(ops);
+    for (int i = 0; i < ops; i++)
+    {
+        TPE_makeBox(&boxJoints[i * 8], &boxConnections[i * 16], TPE_F, TPE_F, TPE_F, TPE_F / 4);
+        TPE_bodyInit(&boxes[i], &boxJoints[i * 8], 8, &boxConnections[i * 16], 16, TPE_F);
+        TPE_bodyMoveBy(&boxes[i], TPE_vec3(0, 4 * TPE_F, 0));
+        for (int j = 0; j < 8; j++)
+        {
+            boxJoints[i * 8 + j].position = TPE_vec3Plus(boxJoints[i * 8 + j].position, RandomVec3(TPE_F / 8));
+            for (int k = 0; k < 3; k++)
+            {
+                boxJoints[i * 8 + j].velocity[k] = RandomUnit(-TPE_F / 16, TPE_F / 16);
+            }
+        }
+    }
+    auto resetBoxes = [&] {
+        std::copy(boxJoints.begin(), boxJoints.end(), boxJointsWork.begin());
+    };
+    boxJointsWork = boxJoints;
+    for (int i = 0; i < ops; i++)
+    {
+        boxes[i].joints = &boxJointsWork[i * 8];
+    }
+    results.push_back(Measure("TPE_bodyReshape", resetBoxes, [&](int i) {
+        TPE_bodyReshape(&boxes[i], Ground);
+        Consume(boxes[i].joints[0].position);
+    }));
+    results.push_back(Measure("TPE_bodyCancelOutVelocities", resetBoxes, [&](int i) {
+        TPE_bodyCancelOutVelocities(&boxes[i], 1);
+        sink = sink + boxes[i].joints[0].velocity[0];
+    }));
+
+    TPE_Vec3 center = TPE_vec3(0, 0, 0);
+    TPE_Vec3 rotation = TPE_vec3(TPE_F / 8, TPE_F / 5, 0);
+    TPE_Unit prism[6] = {-TPE_F, 0, TPE_F, 0, 0, 2 * TPE_F};
+    results.push_back(Measure("TPE_envBox", [&](int i) {
+        Consume(TPE_envBox(points[i], center, TPE_vec3(TPE_F, TPE_F / 2, 2 * TPE_F), rotation));
+    }));
+    results.push_back(Measure("TPE_envHeightmap", [&](int i) {
+        Consume(TPE_envHeightmap(points[i], center, TPE_F, HeightAt, 2 * TPE_F));
+    }));
+    results.push_back(Measure("TPE_envAATriPrism", [&](int i) {
+        Consume(TPE_envAATriPrism(points[i], center, prism, 2 * TPE_F, 0));
+    }));
+    results.push_back(Measure("TPE_envCone", [&](int i) {
+        Consume(TPE_envCone(points[i], center, TPE_vec3(0, 2 * TPE_F, 0), TPE_F));
+    }));
+
+    return results;
+}
+
+bool WriteJson(const std::string& path, const std::vector<Result>& results, unsigned seed)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        return false;
+    }
+    // one benchmark per line, ReadJson relies on it
+    fprintf(file, "{\n  \"seed\": %u, \"ops\": %d, \"runs\": %d,\n  \"benchmarks\": [\n", seed, ops, runs);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"mean_ns\": %.4f, \"stddev_ns\": %.4f, \"min_ns\": %.4f}%s\n", r.name.c_str(), r.mean,
+                r.stddev, r.min, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+double ReadField(const std::string& line, const char* key)
+{
+    auto at = line.find(key);
+    return at == std::string::npos ? 0.0 : atof(line.c_str() + at + strlen(key));
+}
+
+// Only reads back what WriteJson writes
+bool ReadJson(const std::string& path, std::map<std::string, Result>* results)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        auto name = line.find("\"name\": \"");
+        if (name == std::string::npos || line.find("\"mean_ns\": ") == std::string::npos)
+        {
+            continue;
+        }
+        name += 9;
+        Result r;
+        r.name = line.substr(name, line.find('"', name) - name);
+        r.mean = ReadField(line, "\"mean_ns\": ");
+        r.stddev = ReadField(line, "\"stddev_ns\": ");
+        r.min = ReadField(line, "\"min_ns\": ");
+        // older files only had the mean
+        if (r.min <= 0.0) r.min = r.mean;
+        (*results)[r.name] = r;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned seed = 1;
+    std::string jsonPath, baselinePath;
+    double threshold = -1.0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) ops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc) jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) threshold = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-n ops] [-r runs] [-s seed] [-j out.json] [-b baseline.json] [-t percent]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ops < 1 || runs < 1)
+    {
+        fprintf(stderr, "Need at least one op and one run\n");
+        return 1;
+    }
+
+    std::map<std::string, Result> baseline;
+    if (!baselinePath.empty() && !ReadJson(baselinePath, &baseline))
+    {
+        fprintf(stderr, "Can't read %s\n", baselinePath.c_str());
+        return 1;
+    }
+
+    generator.seed(seed);
+    auto results = RunAll();
+
+    printf("tpe: %d ops, %d runs, seed %u\n", ops, runs, seed);
+    bool regressed = false;
+    for (const auto& r : results)
+    {
+        printf("  %-38s %9.2f ns/op  +- %6.2f  (min %9.2f)", r.name.c_str(), r.mean, r.stddev, r.min);
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && it->second.min > 0.0)
+        {
+            const auto& base = it->second;
+            double change = (r.min - base.min) * 100.0 / base.min;
+            bool slower = threshold >= 0.0 && change > threshold && r.mean - base.mean > r.stddev + base.stddev;
+            regressed |= slower;
+            printf("  %+7.2f%% vs baseline%s", change, slower ? "  SLOWER" : "");
+        }
+        printf("\n");
+    }
+
+    if (!jsonPath.empty())
+    {
+        if (!WriteJson(jsonPath, results, seed))
+        {
+            fprintf(stderr, "Can't write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        printf("  results written to %s\n", jsonPath.c_str());
+    }
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,247 @@
+// Host benchmark of the two car models against each other.
+//
+//   vehicle_bench [-m vehicles] [-k ticks] [-e ground|bumps|ramps] [-t throttle]
+//
+// Drops m cars of each model on the environment, far enough apart not to
+// touch, and drives them like Car does with the throttle held: straight for
+// the first half of the ticks, steering for the second. Gravity is the
+// levels' default.
+//   soft     the five joint TPE soft body, a world of m bodies stepped by
+//            TPE_worldStep after Car::PhysicsUpdate
+//   raycast  RaycastVehicle, m of them stepped one after another
+//
+// Reports per car and tick the time and environment queries taken, and per
+// model the top speed, how far the cars got and how they ended up, for
+// checking the raycast one still drives about like the soft one does.
+
+#include "core/tinyphysicsengine.hpp"
+#include "core/raycast_vehicle.hpp"
+#include "bench_vehicle.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace bench;
+
+const TPE_Unit SPACING = 40 * TPE_F;
+const TPE_Unit RAMP_CELL = 16 * TPE_F;
+
+struct Result
+{
+    double ns;         // per car and tick
+    double envCalls;   // per car and tick
+    double topSpeed;   // TPE_Units per tick
+    double distance;   // from the start, on average
+    double height;     // of the center over the ground at the end, on average
+    int upsideDown;
+};
+
+uint8_t* contacts;
+
+TPE_Vec3 GroundEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    return TPE_envGround(point, 0);
+}
+
+TPE_Vec3 RampsEnv(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+    // a tilted box across the way every so often, something to jump off
+    TPE_Unit z = point.z >= 0 ? point.z / RAMP_CELL : (point.z + 1) / RAMP_CELL - 1;
+    TPE_Vec3 ramp = TPE_vec3(point.x, -TPE_F / 4, z * RAMP_CELL + RAMP_CELL / 2);
+
+    TPE_ENV_START(TPE_envGround(point, 0), point)
+    TPE_ENV_NEXT(TPE_envAABox(point, ramp, TPE_vec3(2 * TPE_F, TPE_F / 2, 3 * TPE_F)), point)
+    TPE_ENV_END
+}
+
+int CollisionCallback(int b1, int j1, int b2, int j2, TPE_Vec3 p)
+{
+    if (b1 == b2)
+    {
+        contacts[b1] |= 1 << j1;
+    }
+    return 1;
+}
+
+TPE_Vec3 StartOf(int car)
+{
+    // cars drive towards -z, side by side along x
+    return TPE_vec3(car * SPACING, 2 * TPE_F, 0);
+}
+
+void Finish(Result* result, const std::vector<TPE_Vec3>& ends, TPE_ClosestPointFunction env, int ticks, double ns, double envCalls)
+{
+    int cars = static_cast<int>(ends.size());
+    result->ns = ns / ticks / cars;
+    result->envCalls = envCalls / ticks / cars;
+    result->distance = 0.0;
+    result->height = 0.0;
+    for (int i = 0; i < cars; i++)
+    {
+        result->distance += TPE_dist(ends[i], StartOf(i)) / static_cast<double>(cars);
+        TPE_Vec3 below = env(ends[i], 8 * TPE_F);
+        result->height += (ends[i].y - below.y) / static_cast<double>(cars);
+    }
+}
+
+Result RunSoft(int cars, int ticks, TPE_ClosestPointFunction env, float throttle)
+{
+    std::vector<TPE_Body> bodies(cars);
+    std::vector<TPE_Joint> joints(5 * cars);
+    std::vector<TPE_Connection> connections(10 * cars);
+    std::vector<uint8_t> touching(cars, 0);
+    contacts = touching.data();
+
+    for (int i = 0; i < cars; i++)
+    {
+        MakeVehicle(&bodies[i], &joints[5 * i], &connections[10 * i]);
+        TPE_bodyMoveBy(&bodies[i], StartOf(i));
+    }
+
+    TPE_World world;
+    TPE_WorldStats stats = {};
+    TPE_worldInit(&world, bodies.data(), static_cast<uint16_t>(cars), env);
+    world.collisionCallback = CollisionCallback;
+    world.stats = &stats;
+
+    Result result = {};
+    std::vector<TPE_Vec3> last(cars);
+    for (int i = 0; i < cars; i++) last[i] = joints[5 * i + 4].position;
+    double ns = 0.0, envCalls = 0.0;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        int steering = tick < ticks / 2 ? 0 : 1;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < cars; i++)
+        {
+            DriveVehicle(&bodies[i], touching[i], throttle, steering);
+            TPE_bodyApplyGravity(&bodies[i], GRAVITY);
+        }
+        std::fill(touching.begin(), touching.end(), 0);
+        TPE_worldStep(&world);
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        envCalls += stats.environmentCalls;
+
+        for (int i = 0; i < cars; i++)
+        {
+            TPE_Vec3 now = joints[5 * i + 4].position;
+            TPE_Vec3 moved = TPE_vec3Minus(now, last[i]);
+            moved.y = 0;
+            result.topSpeed = std::max(result.topSpeed, static_cast<double>(TPE_LENGTH(moved)));
+            last[i] = now;
+        }
+    }
+
+    std::vector<TPE_Vec3> ends(cars);
+    for (int i = 0; i < cars; i++)
+    {
+        ends[i] = joints[5 * i + 4].position;
+        TPE_Vec3 up = TPE_vec3Cross(TPE_vec3Minus(joints[5 * i + 2].position, joints[5 * i].position),
+                                    TPE_vec3Minus(joints[5 * i + 1].position, joints[5 * i].position));
+        result.upsideDown += up.y < 0;
+    }
+    Finish(&result, ends, env, ticks, ns, envCalls);
+    contacts = nullptr;
+    return result;
+}
+
+Result RunRaycast(int cars, int ticks, TPE_ClosestPointFunction env, float throttle)
+{
+    std::vector<RaycastVehicle> vehicles(cars, RaycastVehicle(RaycastVehicleSetup::ForCar()));
+    for (int i = 0; i < cars; i++)
+    {
+        vehicles[i].MoveBy(StartOf(i));
+    }
+
+    Result result = {};
+    double ns = 0.0, envCalls = 0.0;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        // Car::RaycastUpdate's steering 1
+        float steering = tick < ticks / 2 ? 0.0f : 1.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& vehicle : vehicles)
+        {
+            vehicle.Step(env, GRAVITY, vehicle.IsDriving() ? throttle : 0.0f, steering);
+        }
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        for (auto& vehicle : vehicles)
+        {
+            envCalls += vehicle.GetEnvironmentCalls();
+            TPE_Vec3 velocity = vehicle.GetVelocity();
+            velocity.y = 0;
+            result.topSpeed = std::max(result.topSpeed, static_cast<double>(TPE_LENGTH(velocity)));
+        }
+    }
+
+    std::vector<TPE_Vec3> ends(cars);
+    for (int i = 0; i < cars; i++)
+    {
+        ends[i] = vehicles[i].GetPosition();
+        result.upsideDown += vehicles[i].IsUpsideDown();
+    }
+    Finish(&result, ends, env, ticks, ns, envCalls);
+    return result;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int cars = 8;
+    int ticks = 1000;
+    float throttle = 1.4f;
+    std::string envName = "ground";
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-m") && i + 1 < argc) cars = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) envName = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) throttle = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-m vehicles] [-k ticks] [-e ground|bumps|ramps] [-t throttle]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TPE_ClosestPointFunction env;
+    if (envName == "ground") env = GroundEnv;
+    else if (envName == "bumps") env = BumpsEnv;
+    else if (envName == "ramps") env = RampsEnv;
+    else
+    {
+        fprintf(stderr, "Unknown environment %s\n", envName.c_str());
+        return 1;
+    }
+    if (ticks < 2 || cars < 1 || cars > 65535)
+    {
+        fprintf(stderr, "Need at least two ticks and one to 65535 vehicles\n");
+        return 1;
+    }
+
+    // Car's acceleration tops out at 1.4
+    printf("vehicle: %s, %d vehicles, %d ticks, throttle %.2f\n", envName.c_str(), cars, ticks, throttle);
+    printf("  %-8s %10s %10s %10s %10s %10s %8s\n", "model", "ns/tick", "env calls", "top speed", "distance", "height",
+           "flipped");
+    Result soft = RunSoft(cars, ticks, env, throttle);
+    Result raycast = RunRaycast(cars, ticks, env, throttle);
+    for (auto model : {std::make_pair("soft", soft), std::make_pair("raycast", raycast)})
+    {
+        const Result& r = model.second;
+        printf("  %-8s %10.0f %10.1f %10.1f %10.0f %10.0f %8d\n", model.first, r.ns, r.envCalls, r.topSpeed, r.distance, r.height,
+               r.upsideDown);
+    }
+    printf("  raycast takes %.2fx the time, %.2fx the env calls\n", raycast.ns / soft.ns, raycast.envCalls / soft.envCalls);
+    return 0;
+}
@@ -0,0 +1,36 @@
+// Compares two physics determinism logs, from gwc_headless -d or
+// stress_bench -d, and says where they first differ.
+//
+//   determinism_compare a.det b.det
+//
+// Exits with 0 when both are the same step for step, 1 when they diverge and
+// 2 when one can't be read. Handy for checking a physics change doesn't move
+// anything:
+//
+//   bin/gwc_headless -g -a -f 1200 -d before.det
+//   ... change TPE ...
+//   bin/gwc_headless -g -a -f 1200 -d after.det
+//   bin/determinism_compare before.det after.det
+
+#include "core/determinism_log.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s a.det b.det\n", argv[0]);
+        return 2;
+    }
+
+    std::string report;
+    auto result = DeterminismLog::Compare(argv[1], argv[2], &report);
+    fputs(report.c_str(), stdout);
+    switch (result)
+    {
+        case DeterminismLog::CompareResult::Same: return 0;
+        case DeterminismLog::CompareResult::Diverged: return 1;
+        default: return 2;
+    }
+}
@@ -0,0 +1,136 @@
+// The whole game on the null engine: no window, no sound, every model a
+// single triangle, but the levels, objects, physics and asset streaming all
+// run for real. For perf, sanitizers and anything else that wants the game
+// loop off the console.
+//
+//   gwc_headless [-f frames] [-g] [-a] [-p report.txt] [-b allocs] [-t trace.json] [-d run.det] [-r] [-s] [-x seed]
+//
+//   -f  how many frames to run, 600 by default
+//   -g  start level01 right away instead of sitting on the splash and menu
+//   -a  hold cross (throttle) the whole time
+//   -p  write the profiler report there at the end (needs PROFILE=1, the
+//       default for host builds)
+//   -b  abort on any settled frame making more main thread allocations than
+//       that (needs PROFILE=1 too), -b 0 is what steady state should manage
+//   -t  write a Chrome trace of the whole run there on exit (needs TRACE=1),
+//       open it in chrome://tracing or ui.perfetto.dev
+//   -d  log the physics world hash of every step there, two of those go into
+//       determinism_compare to find where two runs or builds part ways
+//   -r  run on the real clock, by default every frame takes 1/50s of game
+//       time however fast it really goes, so -f means the same on any machine
+//   -s  no loader thread, levels parse their meshes in Setup on the main
+//       thread like before there was one, for comparing level switch hitches
+//   -x  deterministic, rand seeded with that, level01 on its first song, -s
+//       and the fixed clock: two runs with the same seed log the same -d
+//
+// Assets come from res/ like on the console, whatever is missing falls back
+// the same way it would there.
+
+#include "gwc.hpp"
+#include "core/determinism_log.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    int frames = 600;
+    bool startGame = false;
+    bool throttle = false;
+    std::string reportPath;
+    int allocBudget = -1;
+    std::string tracePath;
+    std::string determinismPath;
+    bool realClock = false;
+    bool synchronous = false;
+    bool deterministic = false;
+    unsigned seed = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-g")) startGame = true;
+        else if (!strcmp(argv[i], "-a")) throttle = true;
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) reportPath = argv[++i];
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) allocBudget = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) tracePath = argv[++i];
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) determinismPath = argv[++i];
+        else if (!strcmp(argv[i], "-r")) realClock = true;
+        else if (!strcmp(argv[i], "-s")) synchronous = true;
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+        {
+            deterministic = true;
+            seed = strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-f frames] [-g] [-a] [-p report.txt] [-b allocs] [-t trace.json] [-d run.det] [-r] [-s] [-x seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (deterministic && realClock)
+    {
+        fprintf(stderr, "-x runs on the fixed clock, it can't take -r\n");
+        return 1;
+    }
+
+#ifdef GWC_TRACE
+    if (!tracePath.empty())
+    {
+        Trace::WriteAtExit(tracePath);
+    }
+#endif
+
+    std::unique_ptr<DeterminismLog> determinismLog;
+    if (!determinismPath.empty())
+    {
+        determinismLog = DeterminismLog::Create(determinismPath);
+        if (!determinismLog)
+        {
+            return 1;
+        }
+        DeterminismLog::SetLog(determinismLog.get());
+    }
+
+    Tyra::EngineOptions opts;
+    Tyra::Engine engine{opts};
+    Tyra::GameWithCar game(&engine);
+    Tyra::GameWithCar::SetGWC(&game);
+
+#ifdef GWC_PROFILE
+    Profiler::SetAllocBudget(allocBudget, true);
+#endif
+    game.SetSynchronousLoading(synchronous);
+    if (deterministic)
+    {
+        game.SetDeterministic(seed);
+    }
+    game.init();
+    if (!realClock)
+    {
+        GameClock::GetClock()->SetFixedDelta(1.0f / 50.0f);
+    }
+    if (startGame)
+    {
+        game.StartGame();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        engine.pad.pressed.Cross = throttle;
+        game.loop();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%d frames in %.1f ms, %.3f ms per frame\n", frames, elapsed, elapsed / frames);
+
+#ifdef GWC_PROFILE
+    if (!reportPath.empty() && !Profiler::WriteReport(reportPath))
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,256 @@
+// The engine side of inc/tyra: takes every call the game makes and draws,
+// plays and loads nothing. Textures and meshes still keep the ids and links
+// Tyra would, the game's own bookkeeping (AssetCache, StaticBatchComponent)
+// depends on them.
+
+#include <tyra>
+
+#include <algorithm>
+
+namespace {
+
+// sprites and materials link to textures by id, so they can't share any
+u32 nextLinkId = 1;
+u32 nextTextureId = 1;
+
+template <typename T>
+T* CopyArray(const T* source, u32 count)
+{
+    if (!source || count == 0)
+    {
+        return nullptr;
+    }
+    T* copy = new T[count];
+    std::copy(source, source + count, copy);
+    return copy;
+}
+
+}
+
+int audsrv_set_format(struct audsrv_fmt_t* fmt) { return 0; }
+int audsrv_set_volume(int volume) { return 0; }
+int audsrv_play_audio(const char* chunk, int bytes) { return bytes; }
+int audsrv_available() { return 1 << 20; }
+int audsrv_wait_audio(int bytes) { return 0; }
+int audsrv_stop_audio() { return 0; }
+
+namespace Tyra {
+
+const M4x4 M4x4::Identity(1.0F, 0.0F, 0.0F, 0.0F,
+                          0.0F, 1.0F, 0.0F, 0.0F,
+                          0.0F, 0.0F, 1.0F, 0.0F,
+                          0.0F, 0.0F, 0.0F, 1.0F);
+
+// There's no OBJ parser here, every model is the same single triangle so the
+// code handling mesh data still has something to chew on
+std::unique_ptr<MeshBuilderData> ObjLoader::load(const std::string& path, const ObjLoaderOptions& options)
+{
+    auto data = std::make_unique<MeshBuilderData>();
+    auto material = std::make_unique<MeshBuilderDataMaterial>();
+    material->name = "null";
+    material->texturePath = "null.png";
+
+    for (u32 f = 0; f < options.animation.count; f++)
+    {
+        auto frame = std::make_unique<MeshBuilderDataMaterialFrame>();
+        frame->count = 3;
+        frame->vertices = new Vec4[3]{Vec4(0.0F, 0.0F, 0.0F), Vec4(options.scale, 0.0F, 0.0F), Vec4(0.0F, 0.0F, options.scale)};
+        frame->normals = new Vec4[3]{Vec4(0.0F, 1.0F, 0.0F), Vec4(0.0F, 1.0F, 0.0F), Vec4(0.0F, 1.0F, 0.0F)};
+        frame->textureCoords = new Vec4[3]{Vec4(0.0F, 0.0F, 1.0F), Vec4(1.0F, 0.0F, 1.0F), Vec4(0.0F, 1.0F, 1.0F)};
+        frame->colors = new Color[3];
+        material->frames.push_back(std::move(frame));
+    }
+
+    data->materials.push_back(std::move(material));
+    data->loadNormals = true;
+    return data;
+}
+
+StaticMeshMaterial::StaticMeshMaterial(const MeshBuilderDataMaterial* data)
+    : ambient(data->ambient), id(nextLinkId++), name(data->name)
+{
+    if (!data->frames.empty())
+    {
+        const auto* frame = data->frames[0].get();
+        count = frame->count;
+        vertices = CopyArray(frame->vertices, count);
+        normals = CopyArray(frame->normals, count);
+        textureCoords = CopyArray(frame->textureCoords, count);
+        colors = CopyArray(frame->colors, count);
+    }
+}
+
+// like Tyra, a copy shares the mother's arrays and gets an id of its own
+StaticMeshMaterial::StaticMeshMaterial(const StaticMeshMaterial& material)
+    : count(material.count),
+      vertices(material.vertices),
+      normals(material.normals),
+      textureCoords(material.textureCoords),
+      colors(material.colors),
+      ambient(material.ambient),
+      id(nextLinkId++),
+      name(material.name),
+      isMother(false)
+{
+}
+
+StaticMeshMaterial::~StaticMeshMaterial()
+{
+    if (isMother)
+    {
+        delete[] vertices;
+        delete[] normals;
+        delete[] textureCoords;
+        delete[] colors;
+    }
+}
+
+Mesh::Mesh() : translation(M4x4::Identity), rotation(M4x4::Identity), scale(M4x4::Identity) {}
+
+StaticMesh::StaticMesh(const MeshBuilderData* data)
+{
+    for (const auto& material : data->materials)
+    {
+        materials.push_back(new StaticMeshMaterial(material.get()));
+    }
+}
+
+StaticMesh::StaticMesh(const StaticMesh& mesh) : Mesh(mesh)
+{
+    for (const auto* material : mesh.materials)
+    {
+        materials.push_back(new StaticMeshMaterial(*material));
+    }
+}
+
+StaticMesh::~StaticMesh()
+{
+    for (auto* material : materials)
+    {
+        delete material;
+    }
+}
+
+void StaticPipeline::render(const StaticMesh* mesh, const StaPipOptions* options) {}
+
+Sprite::Sprite() : id(nextLinkId++) {}
+
+void Texture::addLink(const u32& id)
+{
+    links.push_back(id);
+}
+
+void Texture::removeLinkById(const u32& id)
+{
+    auto it = std::find(links.begin(), links.end(), id);
+    if (it != links.end())
+    {
+        links.erase(it);
+    }
+}
+
+bool Texture::isLinkedWith(const u32& id) const
+{
+    return std::find(links.begin(), links.end(), id) != links.end();
+}
+
+Texture* TextureRepository::add(const std::string& path)
+{
+    textures.push_back(std::make_unique<Texture>(nextTextureId++));
+    return textures.back().get();
+}
+
+void TextureRepository::addByMesh(const Mesh* mesh, const std::string& directory, const std::string& extension)
+{
+    const auto* staticMesh = dynamic_cast<const StaticMesh*>(mesh);
+    if (!staticMesh)
+    {
+        return;
+    }
+    for (const auto* material : staticMesh->materials)
+    {
+        auto* texture = add(directory + material->getName() + "." + extension);
+        texture->addLink(material->getId());
+    }
+}
+
+void TextureRepository::freeByMesh(const Mesh* mesh)
+{
+    const auto* staticMesh = dynamic_cast<const StaticMesh*>(mesh);
+    if (!staticMesh)
+    {
+        return;
+    }
+    for (const auto* material : staticMesh->materials)
+    {
+        auto* texture = getByMeshMaterialId(material->getId());
+        if (texture)
+        {
+            free(texture);
+        }
+    }
+}
+
+void TextureRepository::freeBySprite(const Sprite& sprite)
+{
+    auto* texture = getBySpriteId(sprite.id);
+    if (texture)
+    {
+        free(texture);
+    }
+}
+
+void TextureRepository::free(const Texture* texture)
+{
+    textures.erase(std::remove_if(textures.begin(), textures.end(), [texture](const std::unique_ptr<Texture>& t) { return t.get() == texture; }),
+                   textures.end());
+}
+
+Texture* TextureRepository::getBySpriteId(const u32& id) const
+{
+    for (const auto& texture : textures)
+    {
+        if (texture->isLinkedWith(id)) return texture.get();
+    }
+    return nullptr;
+}
+
+Texture* TextureRepository::getByMeshMaterialId(const u32& id) const
+{
+    return getBySpriteId(id);
+}
+
+void Renderer2D::render(const Sprite& sprite) {}
+
+void Renderer3D::usePipeline(Pipeline& pipeline) {}
+void Renderer3D::usePipeline(Pipeline* pipeline) {}
+
+void Renderer::beginFrame(const CameraInfo3D& cameraInfo) {}
+void Renderer::endFrame() {}
+void Renderer::setClearScreenColor(const Color& color) {}
+
+void AudioSong::load(const std::string& path) {}
+void AudioSong::play() { playing = true; }
+void AudioSong::stop() { playing = false; }
+void AudioSong::setVolume(const u8& volume) {}
+
+audsrv_adpcm_t* AudioAdpcm::load(const std::string& path)
+{
+    return new audsrv_adpcm_t{};
+}
+
+void AudioAdpcm::tryPlay(audsrv_adpcm_t* sample, const s8& channel) {}
+void AudioAdpcm::setVolume(const u8& volume, const s8& channel) {}
+
+Engine::Engine(const EngineOptions& options) {}
+
+void Engine::run(Game* game)
+{
+    game->init();
+    while (true)
+    {
+        game->loop();
+    }
+}
+
+}  // namespace Tyra
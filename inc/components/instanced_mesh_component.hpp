@@ -0,0 +1,78 @@
+#ifndef INSTANCED_MESH_COMPONENT_H
+#define INSTANCED_MESH_COMPONENT_H
+
+#include "core/game_component.hpp"
+#include "core/lod_chain.hpp"
+#include <tyra>
+#include <vector>
+
+// One mesh drawn many times. Instances are just transforms packed in a single
+// array, the mesh (and its LODs) and the pipeline exist once, and the whole
+// set is submitted with a single pipeline switch. Every instance is culled and
+// picks its LOD on its own.
+//
+// Tyra has no hardware instancing, so each visible instance is still its own
+// draw, it just skips everything else a StaticMeshComponent would pay for.
+//
+// Instances are usually driven by a MeshInstanceComponent on another object,
+// this component has to outlive them (put it on a parent, children get
+// deleted before components).
+class InstancedMeshComponent : public GameComponent
+{
+
+private:
+    struct Instance
+    {
+        Tyra::M4x4 translation;
+        Tyra::M4x4 rotation;
+        Tyra::M4x4 scale;
+        u8 lod;
+        bool active;
+        bool visible;
+    };
+
+    LodChain lods;
+    std::vector<Instance> instances;
+    std::vector<size_t> freeSlots;
+    // per LOD list of instances that passed culling this frame, kept around so
+    // rendering doesn't allocate
+    std::vector<std::vector<size_t>> drawLists;
+
+    float cullDistance = 0.f;
+    float boundingRadius = 0.f;
+
+    Tyra::StaPipOptions pipelineOptions;
+    Tyra::StaticPipeline pipeline;
+
+    std::string modelPath;
+    std::string texturePath;
+    Tyra::ObjLoaderOptions options;
+
+public:
+    InstancedMeshComponent(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
+    ~InstancedMeshComponent();
+    void Setup() override;
+    void Render() override;
+    void EventTrigger(ComponentType event, const void* data) override {};
+
+    size_t AddInstance();
+    void RemoveInstance(size_t id);
+    void SetInstanceTransform(size_t id, const Tyra::M4x4& translation, const Tyra::M4x4& rotation);
+    void SetInstanceScale(size_t id, float scale);
+    void SetInstanceVisible(size_t id, bool visible);
+    size_t GetInstanceCount() const { return instances.size() - freeSlots.size(); }
+
+    // Same as on StaticMeshComponent, have to be added before the component is set up
+    void AddLod(const std::string& lodModelPath, float distance) { lods.AddLod(lodModelPath, distance); }
+    void AddGeneratedLod(float distance, int gridResolution) { lods.AddGeneratedLod(distance, gridResolution); }
+    void SetLodHysteresis(float hysteresis) { lods.SetHysteresis(hysteresis); }
+
+    // Instances further away from the camera than this are skipped, 0 = disabled.
+    // The radius (before instance scale) keeps big meshes from popping out early
+    // and is also used to drop instances behind the camera.
+    void SetCullDistance(float distance);
+    void SetBoundingRadius(float radius);
+
+};
+
+#endif // INSTANCED_MESH_COMPONENT_H
@@ -0,0 +1,34 @@
+#ifndef MESH_INSTANCE_COMPONENT_H
+#define MESH_INSTANCE_COMPONENT_H
+
+#include "core/game_component.hpp"
+#include "components/instanced_mesh_component.hpp"
+#include <tyra>
+
+// Puts its owner into an InstancedMeshComponent living somewhere else and
+// keeps the instance transform in sync with the owner, the same way a
+// StaticMeshComponent would move its own mesh.
+class MeshInstanceComponent : public GameComponent
+{
+
+private:
+    InstancedMeshComponent* instancedMesh;
+    size_t instanceId;
+    float scale;
+
+    Tyra::M4x4 translation;
+    Tyra::M4x4 rotation;
+
+    void Sync();
+
+public:
+    MeshInstanceComponent(InstancedMeshComponent* instancedMesh, float scale = 1.f);
+    ~MeshInstanceComponent();
+    void Setup() override;
+    void EventTrigger(ComponentType event, const void* data) override;
+
+    void SetVisible(bool visible);
+
+};
+
+#endif // MESH_INSTANCE_COMPONENT_H
@@ -4,6 +4,7 @@
 #include "core/game_component.hpp"
 #include "core/tinyphysicsengine.hpp"
 #include "core/world.hpp"
+#include "core/raycast_vehicle.hpp"
 
 #define PHYS2TYRA 0.703125f
 
@@ -14,6 +15,8 @@ class PhysicsComponent : public GameComponent
 
 public:
     PhysicsComponent(TPE_Body* body);
+    // Follows a vehicle stepped by its owner instead of a TPE body, GetBody gives nullptr
+    PhysicsComponent(RaycastVehicle* vehicle);
     ~PhysicsComponent();
     void EventTrigger(ComponentType event, const void* data) override {};
 
@@ -21,12 +24,14 @@ public:
     Tyra::Vec4 GetPhysicsRotation();
 
     TPE_Body* GetBody();
+    RaycastVehicle* GetVehicle();
 
     void Setup() override;
     void Update() override;
 private:
     World* world;
     TPE_Body* body;
+    RaycastVehicle* vehicle = nullptr;
     TPE_Vec3 physicsPosition;
     TPE_Vec3 physicsRotation;
 };
@@ -2,10 +2,11 @@
 #define SPRITE_COMPONENT_H
 
 #include <tyra>
+#include <memory>
 #include <string>
 
 #include "core/game_component.hpp"
-#include "core/helper.hpp"
+#include "core/asset_cache.hpp"
 
 class SpriteComponent : public GameComponent
 {
@@ -27,6 +28,7 @@ private:
     std::string imagePath;
 
     Tyra::Sprite sprite;
+    std::shared_ptr<Tyra::Texture> texture;
 
 };
 
@@ -0,0 +1,60 @@
+#ifndef STATIC_BATCH_COMPONENT_H
+#define STATIC_BATCH_COMPONENT_H
+
+#include "core/game_component.hpp"
+#include "core/helper.hpp"
+#include "core/mesh_loader.hpp"
+#include <tyra>
+#include <vector>
+
+// Never-moving level geometry. Meshes are only registered with AddMesh, the
+// actual loading happens in Build() once the level is done setting up: all
+// sources get merged per texture and split into square chunks on the XZ
+// plane, so the whole thing is drawn with a single pipeline switch and the
+// pipeline can frustum cull every chunk on its own.
+class StaticBatchComponent : public GameComponent
+{
+
+private:
+    struct Source
+    {
+        std::string modelPath;
+        std::string texturePath;
+        Tyra::ObjLoaderOptions options;
+    };
+
+    struct Chunk
+    {
+        std::unique_ptr<Tyra::StaticMesh> mesh;
+        Tyra::Vec4 center;
+        float radius;
+    };
+
+    std::vector<Source> sources;
+    std::vector<Chunk> chunks;
+
+    float chunkSize;
+    float cullDistance = 0.f;
+    bool built = false;
+
+    Tyra::StaPipOptions pipelineOptions;
+    Tyra::StaticPipeline pipeline;
+
+public:
+    // chunkSize <= 0 merges everything into one mesh per texture directory
+    StaticBatchComponent(float chunkSize);
+    ~StaticBatchComponent();
+    void Setup() override;
+    void Render() override;
+    void EventTrigger(ComponentType event, const void* data) override {};
+
+    void AddMesh(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
+    void Build();
+    bool IsBuilt() const { return built; }
+
+    // Chunks further away from the camera than this are skipped, 0 = disabled
+    void SetCullDistance(float distance);
+
+};
+
+#endif // STATIC_BATCH_COMPONENT_H
@@ -3,13 +3,21 @@
 
 #include "core/game_component.hpp"
 #include "core/helper.hpp"
+#include "core/lod_chain.hpp"
 #include <tyra>
 
 class StaticMeshComponent : public GameComponent
 {
 
 private:
-    std::unique_ptr<Tyra::StaticMesh> mesh;
+    // meshes come from the asset cache and are shared with every other
+    // component using the same model, so the transform lives here
+    Tyra::M4x4 translation;
+    Tyra::M4x4 rotation;
+
+    LodChain lods;
+    size_t currentLod = 0;
+
     Tyra::StaPipOptions pipelineOptions;
     Tyra::StaticPipeline pipeline;
 
@@ -17,6 +25,9 @@ private:
     std::string texturePath;
     Tyra::ObjLoaderOptions options;
 
+    void UpdateLod();
+    Tyra::Vec4 GetPosition() const;
+
 public:
     StaticMeshComponent(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
     ~StaticMeshComponent();
@@ -28,7 +39,14 @@ public:
     void SetPosition(const Tyra::Vec4& newPosition);
     void Rotate(const Tyra::Vec4& addedRotation);
 
+    // LODs have to be added before the component is set up (AddComponent),
+    // see LodChain. Distances are to the camera.
+    void AddLod(const std::string& lodModelPath, float distance) { lods.AddLod(lodModelPath, distance); }
+    void AddGeneratedLod(float distance, int gridResolution) { lods.AddGeneratedLod(distance, gridResolution); }
+    void SetLodHysteresis(float hysteresis) { lods.SetHysteresis(hysteresis); }
+    size_t GetCurrentLod() const { return currentLod; }
+
 };
 
 
-#endif // STATIC_MESH_COMPONENT_H
\ No newline at end of file
+#endif // STATIC_MESH_COMPONENT_H
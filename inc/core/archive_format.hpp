@@ -0,0 +1,59 @@
+#ifndef ARCHIVE_FORMAT_H
+#define ARCHIVE_FORMAT_H
+
+#include <stdint.h>
+
+// Packed asset archive written by tools/assetpack and read by AssetArchive.
+// No Tyra types in here, the host packer includes this file too.
+//
+// Layout (little endian):
+//   ArchiveFileHeader
+//   ArchiveFileEntry[entryCount]
+//   padding up to dataOffset
+//   file data, every entry starting on an ARCHIVE_FILE_ALIGNMENT boundary
+//
+// Entries are stored in the order the packer was given them, which is the
+// order the levels load them in, so a level load is mostly one forward pass
+// over the disc. The alignment matches a CD/DVD sector, so reading an entry
+// never starts in the middle of one.
+//
+// Entries with ARCHIVE_ENTRY_FLAG_COMPRESSED are stored block compressed
+// (see block_codec.hpp), storedSize is then what they take in the archive
+// and size what they decode to.
+
+#define ARCHIVE_FILE_MAGIC 0x41435747 // "GWCA"
+#define ARCHIVE_FILE_VERSION 2
+#define ARCHIVE_FILE_NAME "assets.gwa"
+#define ARCHIVE_FILE_PATH_LENGTH 96
+#define ARCHIVE_FILE_ALIGNMENT 2048
+
+#define ARCHIVE_ENTRY_FLAG_COMPRESSED 1
+
+struct ArchiveFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t dataOffset; // first entry data, aligned
+    uint32_t totalSize;  // size of the whole file, for sanity checks
+    uint32_t reserved[3];
+};
+
+struct ArchiveFileEntry
+{
+    char path[ARCHIVE_FILE_PATH_LENGTH]; // relative to the asset root, '/' separated
+    uint32_t offset;                     // from the start of the file
+    uint32_t size;                       // decoded size
+    uint32_t storedSize;                 // size in the archive
+    uint32_t flags;
+};
+
+static_assert(sizeof(ArchiveFileHeader) % 16 == 0, "Archive header has to keep the TOC aligned");
+static_assert(sizeof(ArchiveFileEntry) % 16 == 0, "Archive entry has to keep the TOC aligned");
+
+inline uint32_t ArchiveAlign(uint32_t offset)
+{
+    return (offset + ARCHIVE_FILE_ALIGNMENT - 1) & ~(uint32_t)(ARCHIVE_FILE_ALIGNMENT - 1);
+}
+
+#endif // ARCHIVE_FORMAT_H
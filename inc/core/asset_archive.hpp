@@ -0,0 +1,50 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <tyra>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/archive_format.hpp"
+
+// The packed asset archive (tools/assetpack). The TOC is read once when it is
+// opened, after that every read is a seek + read on the one open file. Reads
+// are serialized, so the loader thread and the main thread can share it.
+class AssetArchive
+{
+
+public:
+    ~AssetArchive();
+
+    // nullptr if the archive is missing or malformed
+    static std::unique_ptr<AssetArchive> Open(const std::string& path);
+
+    static AssetArchive* GetArchive();
+    static void SetArchive(AssetArchive* archive);
+
+    // path relative to the asset root, nullptr if it isn't packed
+    const ArchiveFileEntry* Find(const std::string& path) const;
+    // offset from the start of the archive, see Helper::resolve
+    bool Read(u32 offset, void* destination, u32 size);
+
+    size_t GetEntryCount() const { return entries.size(); }
+    const ArchiveFileEntry& GetEntry(size_t i) const { return entries[i]; }
+
+private:
+    AssetArchive(FILE* file, u32 totalSize, std::vector<ArchiveFileEntry> entries);
+
+    static AssetArchive* archive;
+
+    FILE* file;
+    u32 totalSize;
+    std::vector<ArchiveFileEntry> entries;
+    std::map<std::string, size_t> index;
+    std::mutex mutex;
+
+};
+
+#endif // ASSET_ARCHIVE_H
@@ -0,0 +1,79 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <tyra>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/helper.hpp"
+#include "core/mesh_loader.hpp"
+#include "core/mesh_simplifier.hpp"
+
+// Hands out meshes and textures shared between everything that asks for the
+// same asset path (and load options). Entries are refcounted through the
+// shared_ptrs, the last owner going away frees the textures and the mesh data.
+//
+// Shared meshes must be treated as read only data. The only thing users may
+// touch is the mesh transform, and only as scratch right before rendering it.
+class AssetCache
+{
+
+public:
+    AssetCache(Tyra::Engine* engine);
+    ~AssetCache();
+
+    static AssetCache* GetAssetCache();
+    static void SetAssetCache(AssetCache* cache);
+
+    struct LodSource
+    {
+        std::string modelPath; // empty = generate from the base mesh
+        int gridResolution;
+    };
+
+    std::shared_ptr<Tyra::StaticMesh> GetMesh(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
+
+    // The mesh followed by a cheaper version of it per source (null if that
+    // came out empty), sharing the base mesh textures. The base mesh data is
+    // loaded at most once for the whole chain and dropped once it's built.
+    std::vector<std::shared_ptr<Tyra::StaticMesh>> GetMeshAndLods(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options,
+                                                                  const std::vector<LodSource>& sources);
+
+    std::shared_ptr<Tyra::Texture> GetTexture(const std::string& imagePath);
+
+    size_t GetMeshCount() const { return meshes.size(); }
+    size_t GetTextureCount() const { return textures.size(); }
+
+private:
+    static AssetCache* assetCache;
+
+    struct MeshEntry
+    {
+        std::weak_ptr<Tyra::StaticMesh> mesh;
+        const Tyra::StaticMesh* raw;
+    };
+
+    struct TextureEntry
+    {
+        std::weak_ptr<Tyra::Texture> texture;
+        const Tyra::Texture* raw;
+    };
+
+    static std::string MakeKey(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
+
+    std::shared_ptr<Tyra::StaticMesh> Find(const std::string& key) const;
+    std::shared_ptr<Tyra::StaticMesh> AddMesh(const std::string& key, const Tyra::MeshBuilderData* data, const std::string& texturePath);
+    std::shared_ptr<Tyra::StaticMesh> Share(const std::string& key, std::unique_ptr<Tyra::StaticMesh> mesh, std::shared_ptr<Tyra::StaticMesh> base);
+    void LinkTextures(const Tyra::StaticMesh* base, const Tyra::StaticMesh* lod);
+    void ReleaseMesh(const std::string& key, Tyra::StaticMesh* mesh, bool isLod);
+    void ReleaseTexture(const std::string& key, Tyra::Texture* texture);
+
+    Tyra::Engine* engine;
+    std::map<std::string, MeshEntry> meshes;
+    std::map<std::string, TextureEntry> textures;
+
+};
+
+#endif // ASSET_CACHE_H
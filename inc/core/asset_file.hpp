@@ -0,0 +1,66 @@
+#ifndef ASSET_FILE_H
+#define ASSET_FILE_H
+
+#include <tyra>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/helper.hpp"
+#include "core/asset_archive.hpp"
+
+// Read-only file we load ourselves, path relative to the asset root. Served
+// out of the asset archive when it has the file, loose files otherwise.
+//
+// Compressed archive entries are decoded one block at a time. Reads covering
+// whole blocks decode straight into the destination, only reads that start or
+// end inside a block go through a block sized buffer.
+//
+// Tyra's own loaders (textures, songs, adpcm, OBJ fallback) only take paths,
+// those keep going through Helper::fromCwd.
+class AssetFile
+{
+
+public:
+    AssetFile() = default;
+    ~AssetFile();
+    AssetFile(const AssetFile&) = delete;
+    AssetFile& operator=(const AssetFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return archived || file; }
+    bool IsArchived() const { return archived; }
+
+    u32 GetSize() const { return size; }
+    u32 Tell() const { return position; }
+    bool Seek(u32 newPosition);
+    // Returns how many bytes were actually read
+    u32 Read(void* destination, u32 count);
+
+    // Whole file in one go, nullptr if it is missing or the read failed
+    static std::unique_ptr<u8[]> ReadAll(const std::string& path, u32* size);
+
+private:
+    bool OpenCompressed();
+    bool DecodeBlock(u32 index, u8* destination);
+    u32 ReadCompressed(u8* destination, u32 count);
+
+    bool archived = false;
+    AssetRange range;
+    FILE* file = nullptr;
+    u32 size = 0;
+    u32 position = 0;
+
+    // compressed entries only
+    std::vector<u32> blockTable;
+    std::vector<u32> blockOffsets;
+    std::unique_ptr<u8[]> packedBlock;
+    std::unique_ptr<u8[]> decodedBlock;
+    u32 decodedBlockIndex = 0;
+    bool hasDecodedBlock = false;
+
+};
+
+#endif // ASSET_FILE_H
@@ -0,0 +1,122 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <tyra>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything a level is going to load with MeshLoader, so it can be parsed
+// ahead of time while another level is still running.
+struct AssetManifest
+{
+    struct Mesh
+    {
+        std::string modelPath;
+        Tyra::ObjLoaderOptions options;
+    };
+
+    std::vector<Mesh> meshes;
+
+    void AddMesh(const std::string& modelPath, const Tyra::ObjLoaderOptions& options)
+    {
+        meshes.push_back({modelPath, options});
+    }
+};
+
+// Parses mesh data on a worker thread. Requests are served highest priority
+// first, and finished data stays resident until it is released, so
+// MeshLoader::Load can hand out copies instead of touching the disk.
+//
+// Only the parsing happens here. Textures and sounds still go through Tyra
+// on the main thread, the texture upload needs it and Tyra only loads them
+// from a path anyway.
+//
+// The worker runs a priority below the thread that made the loader. EE
+// threads of the same priority don't preempt each other, at the main thread's
+// it kept the CPU from the first job until the queue was empty. Below it, it
+// only gets the time the main thread spends blocked, waiting for vsync mostly.
+//
+// Without a thread (threaded false) nothing is prefetched, every level is
+// ready right away and parses its meshes in Setup on the main thread, the
+// way it went before there was a loader.
+class AssetLoader
+{
+
+public:
+    AssetLoader(bool threaded = true);
+    ~AssetLoader();
+
+    static AssetLoader* GetAssetLoader();
+    static void SetAssetLoader(AssetLoader* loader);
+
+    // Queues everything in the manifest that isn't queued or resident yet.
+    // Prefetching something already queued only raises its priority.
+    void Prefetch(const AssetManifest& manifest, int priority);
+    bool IsResident(const AssetManifest& manifest);
+    void Release(const AssetManifest& manifest);
+
+    // Copy of the parsed mesh data, waits if the worker is on it right now.
+    // nullptr if it was never prefetched (or failed), a queued request is
+    // dropped as the caller is going to load it on its own anyway.
+    std::unique_ptr<Tyra::MeshBuilderData> Acquire(const std::string& modelPath, const Tyra::ObjLoaderOptions& options);
+
+private:
+    static AssetLoader* assetLoader;
+
+    enum class State
+    {
+        Queued,
+        Loading,
+        Resident,
+        Failed
+    };
+
+    struct Entry
+    {
+        State state;
+        int priority;
+        bool released;
+        std::string modelPath;
+        Tyra::ObjLoaderOptions options;
+        std::unique_ptr<Tyra::MeshBuilderData> data;
+    };
+
+    struct Request
+    {
+        int priority;
+        u32 order;
+        std::string key;
+
+        bool operator<(const Request& other) const
+        {
+            if (priority != other.priority) return priority < other.priority;
+            return order > other.order;
+        }
+    };
+
+    static std::string MakeKey(const std::string& modelPath, const Tyra::ObjLoaderOptions& options);
+
+    void Run();
+
+    bool threaded;
+    int workerPriority;
+
+    std::map<std::string, Entry> entries;
+    std::priority_queue<Request> requests;
+    u32 requestCounter = 0;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable requestAdded;
+    std::condition_variable requestDone;
+    std::thread worker;
+
+};
+
+#endif // ASSET_LOADER_H
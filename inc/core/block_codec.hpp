@@ -0,0 +1,107 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+
+// LZ4 style block compression for archive entries. No Tyra types in here, the
+// host packer includes this file too.
+//
+// A compressed entry is split into BLOCK_CODEC_BLOCK_SIZE blocks that are
+// compressed on their own, so they can be decoded one at a time straight into
+// the destination. The entry data starts with a table of the stored size of
+// every block (BLOCK_CODEC_RAW_FLAG set = the block didn't compress and is
+// stored as is), followed by the blocks.
+//
+// Inside a block it's the LZ4 block format: a token (literal count << 4 |
+// match length - 4), extra length bytes while they are 255, the literals,
+// a 16 bit little endian match offset, extra match length bytes. The last
+// sequence has only literals.
+
+#define BLOCK_CODEC_BLOCK_SIZE 0x10000
+#define BLOCK_CODEC_RAW_FLAG 0x80000000u
+#define BLOCK_CODEC_MIN_MATCH 4
+
+inline uint32_t BlockCodecBlockCount(uint32_t size)
+{
+    return (size + BLOCK_CODEC_BLOCK_SIZE - 1) / BLOCK_CODEC_BLOCK_SIZE;
+}
+
+inline uint32_t BlockCodecStoredSize(uint32_t tableEntry)
+{
+    return tableEntry & ~BLOCK_CODEC_RAW_FLAG;
+}
+
+// Decodes one compressed block. Returns the decoded size, or -1 if the data
+// is broken or doesn't fit into the destination.
+inline int32_t BlockCodecDecode(const uint8_t* source, uint32_t sourceSize, uint8_t* destination, uint32_t capacity)
+{
+    const uint8_t* in = source;
+    const uint8_t* inEnd = source + sourceSize;
+    uint8_t* out = destination;
+    uint8_t* outEnd = destination + capacity;
+
+    while (in < inEnd)
+    {
+        uint32_t token = *in++;
+
+        uint32_t literals = token >> 4;
+        if (literals == 15)
+        {
+            uint8_t extra;
+            do
+            {
+                if (in >= inEnd) return -1;
+                extra = *in++;
+                literals += extra;
+            } while (extra == 255);
+        }
+
+        if (literals > (uint32_t)(inEnd - in) || literals > (uint32_t)(outEnd - out)) return -1;
+        memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+
+        if (in == inEnd)
+        {
+            break; // last sequence, literals only
+        }
+
+        if (inEnd - in < 2) return -1;
+        uint32_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > (uint32_t)(out - destination)) return -1;
+
+        uint32_t length = (token & 15) + BLOCK_CODEC_MIN_MATCH;
+        if ((token & 15) == 15)
+        {
+            uint8_t extra;
+            do
+            {
+                if (in >= inEnd) return -1;
+                extra = *in++;
+                length += extra;
+            } while (extra == 255);
+        }
+
+        if (length > (uint32_t)(outEnd - out)) return -1;
+        const uint8_t* match = out - offset;
+        if (offset >= length)
+        {
+            memcpy(out, match, length);
+        }
+        else
+        {
+            // overlapping match (runs), has to go byte by byte
+            for (uint32_t i = 0; i < length; i++)
+            {
+                out[i] = match[i];
+            }
+        }
+        out += length;
+    }
+
+    return (int32_t)(out - destination);
+}
+
+#endif // BLOCK_CODEC_H
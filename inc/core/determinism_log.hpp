@@ -0,0 +1,83 @@
+#ifndef DETERMINISM_LOG_H
+#define DETERMINISM_LOG_H
+
+#include <tyra>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/tinyphysicsengine.hpp"
+
+// Stream of physics world hashes, one per step, for checking that a change
+// (an optimization, another compiler, the console against the host) doesn't
+// change what the simulation does. Record two runs and Compare them, it
+// names the first step, body, joint and field that differs.
+//
+// The world hash is TPE_worldHash, kept up to date by only rehashing the
+// bodies that were awake: a sleeping body doesn't move, so its last hash still
+// holds. Anything moving a body while it's asleep has to wake it up, like
+// TPE_bodyActivate does, or the log won't see it. Every body whose hash
+// changed also gets its state written, so Compare can say what differs and
+// not only where.
+//
+// The file is a u32 magic and version, then records starting with a tag
+// byte, all little endian:
+//   SEGMENT  a new level, steps count from 0 again so runs that load slower
+//            still line up
+//   STEP     u32 step, u32 world hash, u16 bodies, u16 changed, then changed
+//            times: u16 index, u32 body hash, u8 flags, u8 deactivateCount,
+//            s16 jointMass, friction, elasticity, u8 joints, then joints
+//            times: s32 x, y, z, s16 velocity x, y, z, u8 sizeDivided
+
+#define DETERMINISM_FILE_MAGIC 0x44435747 // "GWCD"
+#define DETERMINISM_FILE_VERSION 1
+#define DETERMINISM_TAG_SEGMENT 1
+#define DETERMINISM_TAG_STEP 2
+
+class DeterminismLog
+{
+
+public:
+    enum class CompareResult
+    {
+        Same,
+        Diverged,
+        Unreadable
+    };
+
+    ~DeterminismLog();
+
+    // nullptr if the file can't be written
+    static std::unique_ptr<DeterminismLog> Create(const std::string& path);
+
+    static DeterminismLog* GetLog();
+    static void SetLog(DeterminismLog* log);
+
+    void StartSegment();
+    // After every TPE_worldStep, returns the world hash
+    u32 Record(const TPE_World* world);
+
+    u32 GetStep() const { return step; }
+
+    // Whether both files hold the same steps, report says where they part or
+    // what's wrong with a file
+    static CompareResult Compare(const std::string& pathA, const std::string& pathB, std::string* report);
+
+private:
+    DeterminismLog(FILE* file);
+
+    static DeterminismLog* log;
+
+    void WriteBody(u16 index, const TPE_Body* body, u32 hash);
+
+    FILE* file;
+    u32 step = 0;
+    const TPE_Body* bodies = nullptr;
+    std::vector<u32> bodyHashes;
+    std::vector<bool> bodyAsleep;
+    std::vector<u8> record;
+
+};
+
+#endif // DETERMINISM_LOG_H
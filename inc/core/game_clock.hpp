@@ -0,0 +1,97 @@
+#ifndef GAME_CLOCK_H
+#define GAME_CLOCK_H
+
+#include <tyra>
+#ifndef _EE
+#include <chrono>
+#endif
+
+// Where the game gets its time from, instead of counting frames and guessing
+// the framerate. Tick it once at the start of every frame, everything after
+// sees the same time for the whole frame:
+//
+//   GetDelta()      real seconds the last frame took, for sounds, the camera
+//                   and anything else that has to keep up with the wall clock
+//   GetGameDelta()  the same times the time scale, for gameplay timers that
+//                   should slow down or stop with the game
+//   GetFps()        smoothed over the last few dozen frames, for showing it
+//
+// Deltas stop at GAME_CLOCK_MAX_DELTA, a hitch (a level switch, a slow disc
+// read) counts as a slow frame instead of throwing every lerp and timer ahead
+// at once. The seconds since startup don't, they're the real thing as long
+// as no single frame outlasts the raw clock wrapping around.
+//
+// SetFixedDelta makes every frame take exactly that long, for headless runs
+// that should behave the same however fast they go.
+//
+// The physics still steps once per frame, TPE has no notion of time.
+
+#define GAME_CLOCK_MAX_DELTA 0.1F
+#define GAME_CLOCK_FPS_SMOOTHING 0.05F
+
+class GameClock
+{
+
+public:
+    GameClock();
+
+    static GameClock* GetClock();
+    static void SetClock(GameClock* clock);
+
+    void Tick();
+
+    float GetDelta() const { return delta; }
+    float GetGameDelta() const { return delta * scale; }
+    float GetFps() const { return smoothedDelta > 0.0F ? 1.0F / smoothedDelta : 0.0F; }
+
+    // Seconds since the clock was made, as of the last Tick. Doubles, floats
+    // start skipping frames after a few hours
+    double GetSeconds() const { return seconds; }
+    double GetGameSeconds() const { return gameSeconds; }
+    u32 GetFrame() const { return frame; }
+
+    float GetScale() const { return scale; }
+    void SetScale(float scale) { this->scale = scale; }
+
+    // 0 goes back to the real clock
+    void SetFixedDelta(float delta) { fixedDelta = delta; }
+
+    // The raw clock, also what the profiler times with. Wraps (the COP0 count
+    // after ~14.5s, the host after ~4.3s), only good for differences
+    static u32 GetTicks()
+    {
+#ifdef _EE
+        // COP0 Count, runs at the CPU clock
+        u32 count;
+        asm volatile("mfc0 %0, $9" : "=r"(count));
+        return count;
+#else
+        return static_cast<u32>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static float TicksToSeconds(u32 ticks)
+    {
+#ifdef _EE
+        return ticks / 294912000.0F;
+#else
+        using Period = std::chrono::steady_clock::period;
+        return ticks * (static_cast<float>(Period::num) / Period::den);
+#endif
+    }
+
+private:
+    static GameClock* clock;
+
+    u32 lastTicks;
+    float fixedDelta = 0.0F;
+    float delta = 0.0F;
+    float smoothedDelta = 0.0F;
+    float scale = 1.0F;
+    double seconds = 0.0;
+    double gameSeconds = 0.0;
+    u32 frame = 0;
+
+};
+
+#endif // GAME_CLOCK_H
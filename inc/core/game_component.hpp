@@ -24,7 +24,7 @@ public:
     virtual void Setup() {};
     virtual void Update() {};
     virtual void Render() {};
-    std::string GetComponentName() { return componentName; }
+    const std::string& GetComponentName() { return componentName; }
     virtual void EventTrigger(ComponentType event, const void* data) = 0;
     void SetOwner(GameObject* owner) { this->owner = owner; }
 };
@@ -6,6 +6,7 @@
 #include <string>
 #include <deque>
 #include "core/game_component.hpp"
+#include "core/game_clock.hpp"
 
 class GameComponent;
 
@@ -19,7 +20,7 @@ public:
     void SetChildID(size_t id);
     size_t GetChildID();
     void GetObjectName(const std::string& newObjectName);
-    std::string GetObjectName();
+    const std::string& GetObjectName();
 
     void AddChild(GameObject* child);
     void DeleteChildById(size_t id);
@@ -51,6 +52,7 @@ public:
     void RotateWithParent(const Tyra::Vec4& rotation);
 
     Tyra::Engine* GetEngine() { return this->engine; }
+    const GameClock* GetClock() { return GameClock::GetClock(); }
 
     void _update();
     void _render();
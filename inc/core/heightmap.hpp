@@ -11,22 +11,98 @@
 #pragma once
 
 #include <tyra>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 #include "core/tinyphysicsengine.hpp"
 #include "core/helper.hpp"
+#include "core/heightmap_format.hpp"
 
 using Tyra::Vec4;
 
+/** Closest point to p on triangle abc (Ericson, Real-Time Collision
+ * Detection 5.1.5). */
+Vec4 closestPointOnTriangle(const Vec4& p, const Vec4& a, const Vec4& b,
+                            const Vec4& c);
+
+/** Cast against the two triangles of a cell with corners v00 (x, z), v10
+ * (x + 1, z), v01 and v11, split like sampleTriangle and grown by radius for
+ * a sphere. Only a hit closer than *best counts, it lowers *best and sets
+ * *normal. */
+bool castCell(const Vec4& origin, const Vec4& direction, const Vec4& v00,
+              const Vec4& v10, const Vec4& v01, const Vec4& v11, float radius,
+              float* best, Vec4* normal);
+
+/** Where a cast ran into the surface. */
+struct HeightmapHit {
+  /** Along the direction, in its units. */
+  float distance;
+  /** Where the ray (or the center of the sphere) stopped. */
+  Vec4 point;
+  /** Of the triangle that got hit, unit length. */
+  Vec4 normal;
+  /** Pyramid nodes the cast looked at, to see what it cost. */
+  int nodesVisited;
+};
+
+/** Heights over the [leftUp, rightDown] XZ rectangle, loaded from a .hmp
+ * made by tools/hmapconv in a single read. Every sample sits in the middle
+ * of its cell, positions outside the map get clamped to its edge. */
 class Heightmap {
  public:
-  Heightmap(const float& minHeight, const float& maxHeight, const Vec4& leftUp,
-            const Vec4& rightDown);
+  Heightmap(const std::string& path, const Vec4& leftUp, const Vec4& rightDown);
   ~Heightmap();
 
-  float getHeightOffset(const Vec4& playerPosition) const;
+  /** False if the file was missing or malformed, every height is 0 then. */
+  bool isLoaded() const { return data != nullptr; }
+
+  /** Height of the nearest sample. */
+  float getHeightOffset(const Vec4& position) const;
+
+  /** Bilinear blend of the four surrounding samples. */
+  float sampleBilinear(const Vec4& position) const;
+
+  /** Height on the triangulated surface, every cell split along its
+   * (x, z) -> (x + 1, z + 1) diagonal. */
+  float sampleTriangle(const Vec4& position) const;
+
+  /** sampleBilinear for n positions at once. There are no branches in the
+   * loop, so it's cheap for wheels, particles and so on. */
+  void sampleHeights(const Vec4* in, float* out, size_t n) const;
+
+  /** Normal (y up) of the cell under position, precomputed on load. */
+  Vec4 sampleNormal(const Vec4& position) const;
+
+  /** Closest point of the (sampleTriangle) surface to position, the way a
+   * TPE environment function wants it: position itself if it's under the
+   * surface. Anything further than maxDistance only has to come back further
+   * than maxDistance, then it's a cheap lower bound off the pyramid.
+   * Past the map edge the terrain is treated as flat. */
+  Vec4 closestPoint(const Vec4& position, float maxDistance) const;
+
+  /** closestPoint in TPE units (TPE_F to a world unit), ready to be returned
+   * from a level's EnvironmentDistance. */
+  TPE_Vec3 environmentDistance(TPE_Vec3 position, TPE_Unit maxDistance) const;
+
+  /** First hit of the ray with the surface within maxDistance. Only the
+   * triangles between the samples get hit, not the flat border the samplers
+   * clamp to around them (half a cell inside the bounds, and everything
+   * past them). hit can be null when all that matters is whether there is
+   * one. */
+  bool raycast(const Vec4& origin, const Vec4& direction, float maxDistance,
+               HeightmapHit* hit = nullptr) const;
+
+  /** raycast from one point to another, hit->distance is in world units. */
+  bool segmentCast(const Vec4& from, const Vec4& to,
+                   HeightmapHit* hit = nullptr) const;
+
+  /** A sphere moved from one point to another, hit->point is its center.
+   * Close to exact: the surface gets grown by radius but its edges aren't
+   * rounded off, so right over a sharp ridge the sphere can sink in a bit
+   * (never more than radius * (1 - normal.y)). */
+  bool sphereCast(const Vec4& from, const Vec4& to, float radius,
+                  HeightmapHit* hit = nullptr) const;
 
   bool isOutside(const Vec4& position) const;
 
@@ -35,9 +111,67 @@ class Heightmap {
   Vec4 leftUp, rightDown;
 
  private:
-    std::vector<std::vector<float>> heightmapData;
-  float getWidthPercentage(const Vec4& playerPosition) const;
-  float getHeightPercentage(const Vec4& playerPosition) const;
-  float getGameHeight(const u8& inputColor, const u8& minColor,
-                      const u8& maxColor) const;
+  /** 8 bits per axis is plenty for a surface normal and keeps it to 4 bytes
+   * a cell. */
+  struct PackedNormal {
+    s8 x, y, z, pad;
+  };
+
+  std::unique_ptr<u8[]> blob;
+  /** Row-major quantized heights, points into blob. */
+  const u16* data;
+  float heightScale;
+
+  /** Turn world XZ into (clamped) sample coordinates with a multiply-add,
+   * instead of dividing by the map size on every query. */
+  float gridScaleX, gridScaleZ;
+  float gridOffsetX, gridOffsetZ;
+  float gridMaxX, gridMaxZ;
+
+  /** World size of a cell, for turning sample indices back into XZ. */
+  float cellSizeX, cellSizeZ;
+
+  /** (mapWidth - 1) * (mapHeight - 1) cells. */
+  std::unique_ptr<PackedNormal[]> normals;
+
+  struct Bounds {
+    u16 min, max;
+  };
+
+  struct PyramidLevel {
+    int width, height;
+    std::unique_ptr<Bounds[]> bounds;
+  };
+
+  /** Quantized height range of every cell in pyramid[0], every level after
+   * that merges 2x2 of the one below, down to a single node. Casts skip
+   * whole nodes the ray misses and closestPoint uses it to find out what's
+   * out of reach. */
+  std::vector<PyramidLevel> pyramid;
+
+  void buildNormals();
+  void buildPyramid();
+
+  /** Cells (clamped to the map) overlapping an XZ rectangle. */
+  void getCellRange(float minX, float minZ, float maxX, float maxZ, int* x0,
+                    int* z0, int* x1, int* z1) const;
+
+  /** First pyramid level where cells x0..x1, z0..z1 fall into 2x2 nodes or
+   * less. */
+  int getCoverLevel(int x0, int z0, int x1, int z1) const;
+
+  /** Range of the node covering cell (x, z) at level, clamped to the top. */
+  const Bounds& getBounds(int level, int x, int z) const;
+
+  bool cast(const Vec4& origin, const Vec4& direction, float maxDistance,
+            float radius, HeightmapHit* hit) const;
+
+  /** Takes over best if cell (x, z) has a point closer than bestDistance
+   * (squared). */
+  void closestInCell(const Vec4& position, int x, int z, Vec4* best,
+                     float* bestDistance) const;
+
+  /** Cell under position and where in it position is, each 0..1. */
+  void getCell(const Vec4& position, int* cellX, int* cellZ, float* fracX,
+               float* fracZ) const;
 };
@@ -0,0 +1,103 @@
+#ifndef HEIGHTMAP_FORMAT_H
+#define HEIGHTMAP_FORMAT_H
+
+#include <stdint.h>
+
+// Binary heightmaps written by tools/hmapconv, a whole one read by Heightmap
+// and a tiled one streamed by TiledHeightmap. No Tyra types in here, the host
+// converter includes this file too.
+//
+// Whole (.hmp), little endian like everything else:
+//   HeightmapFileHeader
+//   uint16_t heights[height][width], row-major, row 0 at leftUp.z
+//
+// A stored value q maps to minHeight + q * (maxHeight - minHeight) / 65535.
+
+#define HEIGHTMAP_FILE_MAGIC 0x48435747 // "GWCH"
+#define HEIGHTMAP_FILE_VERSION 1
+#define HEIGHTMAP_FILE_EXTENSION ".hmp"
+#define HEIGHTMAP_FILE_MAX_VALUE 65535
+
+struct HeightmapFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    float minHeight;
+    float maxHeight;
+    uint32_t totalSize; // size of the whole file, for sanity checks
+    uint32_t reserved;
+};
+
+static_assert(sizeof(HeightmapFileHeader) % 16 == 0, "Heightmap header has to keep the data aligned");
+
+inline uint32_t HeightmapFileSize(uint32_t width, uint32_t height)
+{
+    return sizeof(HeightmapFileHeader) + width * height * sizeof(uint16_t);
+}
+
+// Tiled (.hmt), quantized the same way:
+//   HeightmapTiledHeader
+//   HeightmapTileBounds bounds[tilesZ][tilesX]
+//   uint16_t overview[tilesZ + 1][tilesX + 1], the samples on tile corners
+//   uint16_t tiles[tilesZ][tilesX][tileCells + 1][tileCells + 1]
+//
+// Neighbouring tiles both store the samples on their shared edge, so any
+// cell can be read out of a single tile. Samples past the map edge repeat
+// the last one. Sample (x, z) sits at origin + (x * cellSizeX, z * cellSizeZ).
+
+#define HEIGHTMAP_TILED_MAGIC 0x54435747 // "GWCT"
+#define HEIGHTMAP_TILED_VERSION 1
+#define HEIGHTMAP_TILED_EXTENSION ".hmt"
+
+struct HeightmapTiledHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width; // in samples
+    uint32_t height;
+    uint32_t tileCells; // cells along a tile side
+    uint32_t tilesX;
+    uint32_t tilesZ;
+    float minHeight;
+    float maxHeight;
+    float originX;
+    float originZ;
+    float cellSizeX;
+    float cellSizeZ;
+    uint32_t totalSize;
+    uint32_t reserved[2];
+};
+
+struct HeightmapTileBounds
+{
+    uint16_t min;
+    uint16_t max;
+};
+
+static_assert(sizeof(HeightmapTiledHeader) % 16 == 0, "Tiled heightmap header has to keep the data aligned");
+
+inline uint32_t HeightmapTileSamples(uint32_t tileCells)
+{
+    return (tileCells + 1) * (tileCells + 1);
+}
+
+inline uint32_t HeightmapTiledOverviewOffset(uint32_t tilesX, uint32_t tilesZ)
+{
+    return sizeof(HeightmapTiledHeader) + tilesX * tilesZ * sizeof(HeightmapTileBounds);
+}
+
+inline uint32_t HeightmapTiledTileOffset(uint32_t tilesX, uint32_t tilesZ, uint32_t tileCells, uint32_t tile)
+{
+    uint32_t overview = (tilesX + 1) * (tilesZ + 1) * sizeof(uint16_t);
+    return HeightmapTiledOverviewOffset(tilesX, tilesZ) + overview +
+           tile * HeightmapTileSamples(tileCells) * sizeof(uint16_t);
+}
+
+inline uint32_t HeightmapTiledFileSize(uint32_t tilesX, uint32_t tilesZ, uint32_t tileCells)
+{
+    return HeightmapTiledTileOffset(tilesX, tilesZ, tileCells, tilesX * tilesZ);
+}
+
+#endif // HEIGHTMAP_FORMAT_H
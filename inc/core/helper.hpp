@@ -7,11 +7,30 @@
 
 // #define RUNNING_FROM_DISC
 
+// Where an asset lives inside the packed archive
+struct AssetRange
+{
+    u32 offset;
+    u32 size;       // what it decodes to
+    u32 storedSize; // what it takes in the archive
+    bool compressed;
+};
+
 class Helper
 {
 
 public:
     static std::string fromCwd(const std::string& path);
+    // Where the asset lives inside the packed archive, false if there is no
+    // archive or it doesn't have it (then it's a loose file under fromCwd)
+    static bool resolve(const std::string& path, AssetRange* range);
+
+    // EE threads only give way to higher priority ones, never to their equals,
+    // so a worker at the main thread's priority keeps the CPU until it blocks.
+    // Take the creating thread's priority on that thread and have the worker
+    // set its own relative to it. Both do nothing off the EE
+    static int getThreadPriority();
+    static void setThreadPriority(int priority);
 
 };
 
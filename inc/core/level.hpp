@@ -8,7 +8,7 @@
 #include "core/heightmap.hpp"
 #include "core/world.hpp"
 #include "core/game_object.hpp"
-#include "components/static_mesh_component.hpp"
+#include "components/static_batch_component.hpp"
 
 class Level : public GameObject 
 {
@@ -23,11 +23,17 @@ public:
     TPE_Unit GetGravity();
     std::string GetBasePath();
 
+    // Called by the world once the level and all of its children are set up
+    void FinishLoading();
+
+protected:
+    StaticBatchComponent* GetStaticBatch();
+
 private:
     virtual void Setup();
     virtual void Update() {}
     virtual void Render() {}
-    StaticMeshComponent* staticMeshComponent;
+    StaticBatchComponent* staticBatch = nullptr;
 
     std::string basePath;
     TPE_Unit gravity = TPE_F / 50;
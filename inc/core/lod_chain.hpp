@@ -0,0 +1,50 @@
+#ifndef LOD_CHAIN_H
+#define LOD_CHAIN_H
+
+#include "core/asset_cache.hpp"
+#include <tyra>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A model and its LODs out of the AssetCache, for the mesh components. LODs
+// are requested up front and loaded all at once by Resolve, after that the
+// chain only picks which one to draw at a given distance.
+class LodChain
+{
+
+public:
+    // The mesh switches to a LOD once it's further than distance
+    void AddLod(const std::string& lodModelPath, float distance);
+    void AddGeneratedLod(float distance, int gridResolution);
+    // Fraction of the switch distance used as a dead zone, so meshes don't
+    // flicker between two LODs when the camera sits right at the boundary.
+    void SetHysteresis(float hysteresis);
+
+    // Loads the base mesh and the requested LODs, the ones that come out empty are skipped
+    void Resolve(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options);
+    bool IsResolved() const { return !lods.empty(); }
+
+    // The LOD to draw at distance when current was drawn last
+    size_t Select(size_t current, float distance) const;
+
+    size_t GetCount() const { return lods.size(); }
+    Tyra::StaticMesh* GetMesh(size_t lod) const { return lods[lod].mesh.get(); }
+
+private:
+    struct Lod
+    {
+        std::shared_ptr<Tyra::StaticMesh> mesh;
+        float distance;
+    };
+
+    // lods[0] is the full detail mesh, the rest are sorted by switch distance
+    std::vector<Lod> lods;
+    // requested LODs and their switch distances, until Resolve
+    std::vector<AssetCache::LodSource> sources;
+    std::vector<float> distances;
+    float hysteresis = 0.1f;
+
+};
+
+#endif // LOD_CHAIN_H
@@ -0,0 +1,58 @@
+#ifndef MESH_FORMAT_H
+#define MESH_FORMAT_H
+
+#include <stdint.h>
+
+// Packed mesh blob written by tools/meshconv and read by MeshLoader.
+// No Tyra types in here, the host converter includes this file too.
+//
+// Layout (little endian, every section 16 byte aligned):
+//   MeshFileHeader
+//   MeshFileMaterial[materialCount]
+//   per material: positions, then normals / texture coords / colors if the
+//   header flags say so, each as vertexCount * float[4]
+//
+// Positions are already scaled and UVs already flipped according to the
+// options stored in the header, so loading is a single read plus copies.
+
+#define MESH_FILE_MAGIC 0x4D435747 // "GWCM"
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_EXTENSION ".gwm"
+#define MESH_FILE_NAME_LENGTH 64
+
+#define MESH_FILE_FLAG_NORMALS 1
+#define MESH_FILE_FLAG_TEXTURE_COORDS 2
+#define MESH_FILE_FLAG_COLORS 4
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t materialCount;
+    float scale;        // ObjLoaderOptions::scale the positions were baked with
+    uint32_t flipUVs;   // ObjLoaderOptions::flipUVs the UVs were baked with
+    uint32_t totalSize; // size of the whole file, for sanity checks
+    uint32_t reserved;
+};
+
+struct MeshFileMaterial
+{
+    char name[MESH_FILE_NAME_LENGTH];
+    char texturePath[MESH_FILE_NAME_LENGTH]; // empty = no texture
+    float ambient[4];
+    uint32_t vertexCount;
+    uint32_t dataOffset; // from the start of the file
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(MeshFileHeader) % 16 == 0, "Mesh header has to keep the data aligned");
+static_assert(sizeof(MeshFileMaterial) % 16 == 0, "Mesh material has to keep the data aligned");
+
+inline uint32_t MeshFileAttributeCount(uint32_t flags)
+{
+    return 1 + ((flags & MESH_FILE_FLAG_NORMALS) ? 1 : 0) + ((flags & MESH_FILE_FLAG_TEXTURE_COORDS) ? 1 : 0) +
+           ((flags & MESH_FILE_FLAG_COLORS) ? 1 : 0);
+}
+
+#endif // MESH_FORMAT_H
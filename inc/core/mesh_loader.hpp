@@ -0,0 +1,47 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <tyra>
+#include <string>
+#include <memory>
+
+#include "core/helper.hpp"
+#include "core/mesh_format.hpp"
+
+// Loads mesh data for a model path relative to the asset root. If a baked
+// blob (same path, .gwm extension, made by tools/meshconv) exists it is read
+// in one go (out of the asset archive if it is packed), otherwise we fall
+// back to parsing the OBJ with Tyra. Data the AssetLoader already has
+// resident is copied instead.
+//
+// Built with GWC_VERIFY_MESHES (make VERIFY_MESHES=1), every blob that loads
+// gets its OBJ parsed by Tyra::ObjLoader too. The two are compared attribute
+// by attribute and both load times logged, so meshconv can't drift from what
+// the engine makes of the shipped models without anyone noticing.
+class MeshLoader
+{
+
+public:
+    static std::unique_ptr<Tyra::MeshBuilderData> Load(const std::string& modelPath, const Tyra::ObjLoaderOptions& options);
+    // Same as Load, but never asks the AssetLoader
+    static std::unique_ptr<Tyra::MeshBuilderData> LoadFromDisk(const std::string& modelPath, const Tyra::ObjLoaderOptions& options);
+
+    static std::unique_ptr<Tyra::MeshBuilderData> Clone(const Tyra::MeshBuilderData* data);
+
+    static std::string GetBlobPath(const std::string& modelPath);
+
+    // Builds mesh data out of a blob that is already in memory, nullptr if it is malformed
+    static std::unique_ptr<Tyra::MeshBuilderData> FromBlob(const u8* blob, u32 size, const Tyra::ObjLoaderOptions& options);
+
+private:
+    static std::unique_ptr<Tyra::MeshBuilderData> LoadBlob(const std::string& path, const Tyra::ObjLoaderOptions& options);
+
+#ifdef GWC_VERIFY_MESHES
+    // Empty if they match, the first difference otherwise
+    static std::string Compare(const Tyra::MeshBuilderData* blob, const Tyra::MeshBuilderData* obj);
+    static void Verify(const std::string& modelPath, const Tyra::MeshBuilderData* blob, float blobMs, const Tyra::ObjLoaderOptions& options);
+#endif
+
+};
+
+#endif // MESH_LOADER_H
@@ -0,0 +1,23 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <tyra>
+#include <memory>
+
+// Cheap load-time decimation for assets that don't ship with authored LODs.
+// Vertices are snapped to a uniform grid (vertex clustering) and triangles that
+// collapse are dropped, so it runs in linear time and never needs adjacency.
+class MeshSimplifier
+{
+
+public:
+    // gridResolution is the number of cells along the longest side of the mesh
+    // bounding box, lower = coarser. Only the first frame is used (static meshes).
+    // Returns nullptr if nothing would be left to draw.
+    static std::unique_ptr<Tyra::MeshBuilderData> Simplify(const Tyra::MeshBuilderData* data, int gridResolution);
+
+    static u32 CountVertices(const Tyra::MeshBuilderData* data);
+
+};
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,219 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <tyra>
+#include <string>
+#include <thread>
+#include "core/trace.hpp"
+#include "core/game_clock.hpp"
+
+// Scoped timers for the main loop. Build with -DGWC_PROFILE (make PROFILE=1)
+// to get them, without it the macros are empty and profiler.cpp compiles to
+// nothing.
+//
+//   PROFILE_SCOPE("Physics");          times the rest of the block
+//   PROFILE_COUNT("Env calls", 50, n); adds n to a per frame counter, the
+//                                      overlay draws a pip per 50
+//   PROFILE_FRAME();                   once at the very end of a frame
+//   PROFILE_UNSTEADY();                this frame loads things, don't hold it
+//                                      to the allocation budget
+//
+// A zone adds up its time over a frame, and the last PROFILER_FRAMES frames
+// are kept for min/avg/max/p99. Times are inclusive. A zone entered again
+// while it's still open (GameObject::_update going down the children) only
+// counts the outermost call, so the clock is read twice per zone and frame
+// no matter how deep the tree is.
+//
+// Main thread only, the per frame sums aren't locked.
+//
+// Profiled builds also replace the global operator new and count the main
+// thread's allocations, per frame and per innermost open zone (the frame row
+// gets the ones made outside of any zone too). The loader and music threads
+// allocate whenever they like and aren't counted. SetAllocBudget makes frames
+// going over a number of allocations complain, once the game had
+// PROFILER_SETTLE_FRAMES frames since the last PROFILE_UNSTEADY to settle.
+
+#define PROFILER_FRAMES 256
+#define PROFILER_MAX_ZONES 32
+#define PROFILER_MAX_COUNTERS 16
+#define PROFILER_SETTLE_FRAMES 60
+
+#ifdef GWC_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                                       \
+    static const int PROFILE_CONCAT(profileZone, __LINE__) = Profiler::GetZone(name); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileZone, __LINE__)); \
+    TRACE_SCOPE(name)
+#define PROFILE_COUNT(name, unit, value)                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        static const int profileCounter = Profiler::GetCounter(name, unit);              \
+        Profiler::Count(profileCounter, value);                                           \
+    } while (0)
+#define PROFILE_FRAME() Profiler::EndFrame()
+#define PROFILE_UNSTEADY() Profiler::Unsteady()
+#else
+#define PROFILE_SCOPE(name) TRACE_SCOPE(name)
+#define PROFILE_COUNT(name, unit, value)
+#define PROFILE_FRAME()
+#define PROFILE_UNSTEADY()
+#endif
+
+// In milliseconds (plain counts for counters), calls are per frame
+struct ProfileStats
+{
+    float min;
+    float avg;
+    float max;
+    float p99;
+    float calls;
+};
+
+class Profiler
+{
+
+public:
+    // Zone with that name, registered on first use. -1 once all of them are
+    // taken, the scopes just don't record then
+    static int GetZone(const char* name);
+    static int GetZoneCount() { return zoneCount; }
+    static const char* GetZoneName(int zone) { return zones[zone].name; }
+
+    static void Begin(int zone)
+    {
+        if (zone < 0) return;
+        Zone& z = zones[zone];
+        if (z.depth++ == 0)
+        {
+            z.start = GetTicks();
+            z.parent = currentZone;
+            currentZone = zone;
+        }
+    }
+
+    static void End(int zone)
+    {
+        if (zone < 0) return;
+        Zone& z = zones[zone];
+        if (--z.depth == 0)
+        {
+            z.ticks += GetTicks() - z.start;
+            z.calls++;
+            currentZone = z.parent;
+        }
+    }
+
+    // Same for counters, unit is only for the overlay
+    static int GetCounter(const char* name, u32 unit);
+    static int GetCounterCount() { return counterCount; }
+    static const char* GetCounterName(int counter) { return counters[counter].name; }
+    static u32 GetCounterUnit(int counter) { return counters[counter].unit; }
+
+    static void Count(int counter, u32 value)
+    {
+        if (counter >= 0) counters[counter].value += value;
+    }
+
+    // Called by operator new
+    static void CountAlloc(size_t bytes)
+    {
+        if (std::this_thread::get_id() != mainThread) return;
+        frameAllocs++;
+        frameAllocBytes += bytes;
+        if (currentZone >= 0)
+        {
+            zones[currentZone].allocs++;
+            zones[currentZone].allocBytes += bytes;
+        }
+    }
+
+    // Allocations a settled frame may make, -1 (the default) for no limit.
+    // Going over logs (at most once per PROFILER_FRAMES frames), or asserts if
+    // fatal
+    static void SetAllocBudget(int allocs, bool fatal);
+    static void Unsteady() { framesSettled = 0; }
+
+    // Closes the frame, its wall time is what passed since the last call
+    static void EndFrame();
+
+    // Over the frames in the ring, zeros before the first one is done
+    static ProfileStats GetStats(int zone);
+    static ProfileStats GetFrameStats();
+    static ProfileStats GetCounterStats(int counter);
+    static ProfileStats GetAllocStats(int zone);
+    static ProfileStats GetAllocBytesStats(int zone);
+    static ProfileStats GetFrameAllocStats();
+    static ProfileStats GetFrameAllocBytesStats();
+    static int GetFrameCount() { return frameCount < PROFILER_FRAMES ? frameCount : PROFILER_FRAMES; }
+
+    // One line per zone, the frame first, then the counters and allocations
+    static std::string GetReport();
+    static void LogReport();
+    static bool WriteReport(const std::string& path);
+
+    static u32 GetTicks() { return GameClock::GetTicks(); }
+
+    static float TicksToMs(u32 ticks) { return GameClock::TicksToSeconds(ticks) * 1000.0F; }
+
+private:
+    struct Zone
+    {
+        const char* name;
+        u32 start;
+        u32 depth;
+        u32 ticks;
+        u32 calls;
+        int parent;
+        u32 allocs;
+        u32 allocBytes;
+    };
+
+    struct Counter
+    {
+        const char* name;
+        u32 unit;
+        u32 value;
+    };
+
+    static ProfileStats GetStats(const u32* values, const u16* calls, float scale);
+
+    static Zone zones[PROFILER_MAX_ZONES];
+    static int zoneCount;
+    static Counter counters[PROFILER_MAX_COUNTERS];
+    static int counterCount;
+
+    // [zone][frame], the last row is the frame itself
+    static u32 ticksHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+    static u16 callsHistory[PROFILER_MAX_ZONES][PROFILER_FRAMES];
+    static u32 countersHistory[PROFILER_MAX_COUNTERS][PROFILER_FRAMES];
+    static u32 allocsHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+    static u32 allocBytesHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+    static int frameCount;
+    static u32 frameStart;
+    static bool frameStarted;
+
+    static int currentZone;
+    static const std::thread::id mainThread;
+    static u32 frameAllocs;
+    static u32 frameAllocBytes;
+    static int allocBudget;
+    static bool allocBudgetFatal;
+    static int framesSettled;
+    static int framesSinceBudgetLog;
+
+};
+
+class ProfileScope
+{
+
+public:
+    ProfileScope(int zone) : zone(zone) { Profiler::Begin(zone); }
+    ~ProfileScope() { Profiler::End(zone); }
+
+private:
+    int zone;
+
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,132 @@
+#ifndef RAYCAST_VEHICLE_H
+#define RAYCAST_VEHICLE_H
+
+#include <tyra>
+#include "core/tinyphysicsengine.hpp"
+
+// Car physics as one rigid chassis held up by four suspension rays, a cheaper
+// take than the five joint soft body: no tension, reshape or cancel out
+// passes, and a handful of environment queries a step instead of one per
+// joint and collision iteration. Doesn't collide with TPE bodies, only the
+// level environment.
+//
+// Every step, for each wheel a ray goes down the chassis' up axis from the
+// top of its suspension, marched like TPE_castEnvironmentRay does outside.
+// Where it hits:
+//   the spring (and damper) pushes the chassis up at the wheel
+//   the tyre takes away part of the wheel's sideways velocity, more while it
+//   grips (slip angle up to peakSlip), less once it slides past that
+//   the driven wheels push along the chassis, the tyre forces limited by
+//   friction times what the spring is carrying
+// A few points around the chassis keep it out of the environment when it
+// lands on its roof or hits a wall.
+//
+// Units are TPE's: positions in TPE_Units, velocities per physics step. The
+// mass is 1, so forces are velocity changes per step. The centre of mass is
+// the chassis origin, just above the wheel centers rather than up at center
+// with the chassis box, the handling is tuned with it sitting that low. The
+// inertia is the box's, taken about the origin. Wheels 0 and 1 are the
+// rear (driven) ones, 2 and 3 the front (steered), at the corners the joints
+// of the soft body car are, so it looks the same on screen.
+
+#define RAYCAST_VEHICLE_WHEELS 4
+#define RAYCAST_VEHICLE_HULL_POINTS 5
+#define RAYCAST_VEHICLE_RAY_STEPS 6
+
+struct RaycastVehicleSetup
+{
+    // chassis space: x right, y up, z back, like the soft body's joints, the
+    // origin is the centre of mass
+    Tyra::Vec4 wheels[RAYCAST_VEHICLE_WHEELS]; // wheel centers with the suspension all the way out
+    Tyra::Vec4 hull[RAYCAST_VEHICLE_HULL_POINTS];
+    float hullRadius[RAYCAST_VEHICLE_HULL_POINTS];
+    Tyra::Vec4 center;      // what GetPosition gives, the soft body's joint 4
+    Tyra::Vec4 halfExtents; // of the chassis box around center, for its inertia
+
+    float wheelRadius;
+    float restLength;        // suspension travel
+    float stiffness;         // per unit of compression
+    float damping;           // per unit of compression change
+    float engine;            // all the driven wheels together, at full throttle
+    float maxSteer;          // as the tangent of the angle, like the soft body's turn rate
+    float steerSpeed;        // how fast the steering gets there, per step
+    float grip;              // share of a wheel's sideways velocity the tyre takes per step
+    float peakSlip;          // tangent of the slip angle the tyre grips best up to
+    float slideGrip;         // share of grip left sliding well past that
+    float friction;          // the most a tyre can push, times its load
+    float rollingResistance; // share of the forward velocity lost per step on the ground
+    float angularDamping;    // share of the spin lost per step
+
+    // Sized and tuned after Car's soft body
+    static RaycastVehicleSetup ForCar();
+};
+
+class RaycastVehicle
+{
+
+public:
+    RaycastVehicle(const RaycastVehicleSetup& setup);
+
+    // Moves the chassis origin (its centre of mass) there, not touching the velocity
+    void MoveTo(TPE_Vec3 position);
+    void MoveBy(TPE_Vec3 offset);
+
+    // throttle 1 is full power, negative brakes and reverses. steering 1
+    // turns the way the soft body car's steering 1 does, -1 the other way
+    void Step(TPE_ClosestPointFunction environment, TPE_Unit gravity, float throttle, float steering);
+
+    TPE_Vec3 GetPosition() const;
+    // The angles TPE_bodyGetRotation(body, 0, 2, 1) gives for the soft body
+    TPE_Vec3 GetRotation() const;
+    TPE_Vec3 GetVelocity() const;
+    // Along the chassis, negative going backwards
+    float GetForwardSpeed() const { return -velocity.dot3(axisZ); }
+    bool IsGrounded(int wheel) const { return wheels[wheel].grounded; }
+    // Both driven wheels on the ground
+    bool IsDriving() const { return wheels[0].grounded && wheels[1].grounded; }
+    bool IsUpsideDown() const { return axisY.y < 0.0f; }
+    // In the last Step
+    u32 GetEnvironmentCalls() const { return environmentCalls; }
+
+private:
+    struct Wheel
+    {
+        float compression = 0.0f;
+        bool grounded = false;
+    };
+
+    Tyra::Vec4 ToWorld(const Tyra::Vec4& local) const;
+    Tyra::Vec4 ApplyInverseInertia(const Tyra::Vec4& v) const;
+    Tyra::Vec4 PointVelocity(const Tyra::Vec4& offset) const;
+    void ApplyImpulse(const Tyra::Vec4& offset, const Tyra::Vec4& impulse);
+    // What an impulse along axis at offset takes to change the point's
+    // velocity along it by one
+    float EffectiveMass(const Tyra::Vec4& offset, const Tyra::Vec4& axis) const;
+    // Distance to the environment along the ray, or more than length if it
+    // doesn't hit anything that far
+    float CastRay(TPE_ClosestPointFunction environment, const Tyra::Vec4& from, const Tyra::Vec4& direction, float length);
+    void UpdateWheels(TPE_ClosestPointFunction environment, float throttle);
+    void Integrate();
+    void ResolveHull(TPE_ClosestPointFunction environment);
+
+    RaycastVehicleSetup setup;
+    // rows of the inverse inertia in chassis space
+    Tyra::Vec4 inverseInertia[3];
+    Tyra::Vec4 hullCenter;
+    float hullBound;
+
+    Tyra::Vec4 position;
+    Tyra::Vec4 velocity;
+    Tyra::Vec4 angularVelocity;
+    // the chassis' axes in the world, its rotation
+    Tyra::Vec4 axisX{1.0f, 0.0f, 0.0f};
+    Tyra::Vec4 axisY{0.0f, 1.0f, 0.0f};
+    Tyra::Vec4 axisZ{0.0f, 0.0f, 1.0f};
+
+    Wheel wheels[RAYCAST_VEHICLE_WHEELS];
+    float steer = 0.0f;
+    u32 environmentCalls = 0;
+
+};
+
+#endif // RAYCAST_VEHICLE_H
@@ -0,0 +1,86 @@
+#ifndef SONG_STREAM_H
+#define SONG_STREAM_H
+
+#include <tyra>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "core/asset_file.hpp"
+
+// Music player that never has the whole song in memory. A reader thread pulls
+// the PCM data of a WAV out of an AssetFile in fixed size chunks into a small
+// ring buffer and hands audsrv whatever it has room for, blocking in
+// audsrv_wait_audio when both are full. It runs a priority above the thread
+// that made the stream, so it gets the CPU as soon as audsrv wakes it and a
+// long frame on the main thread can't run the audio dry.
+//
+// Replaces engine->audio.song, which reads the whole file on load.
+class SongStream
+{
+
+public:
+    static constexpr u32 CHUNK_SIZE = 16 * 1024;
+    static constexpr u32 RING_SIZE = 4 * CHUNK_SIZE;
+    // how much room in audsrv wakes the reader up again
+    static constexpr u32 FEED_SIZE = 2 * 1024;
+
+    SongStream();
+    ~SongStream();
+
+    static SongStream* GetSongStream();
+    static void SetSongStream(SongStream* stream);
+
+    // Only reads the WAV header, the data streams in once the reader gets to it
+    bool Load(const std::string& path);
+    void Play();
+    void Stop();
+    // main thread, notices when a song that doesn't loop has run out
+    void Update();
+
+    void SetLoop(bool loop);
+    void SetVolume(int volume);
+    bool IsPlaying() const { return playing; }
+
+private:
+    static SongStream* songStream;
+
+    bool ParseHeader();
+    void Run();
+    // fills chunk with the next bytes of the song, wrapping around if looping
+    u32 ReadChunk(u8* chunk);
+    void FillRing();
+    void FeedAudio();
+
+    AssetFile file;
+    u32 dataOffset = 0;
+    u32 dataSize = 0;
+    u32 dataPosition = 0;
+    audsrv_fmt_t format;
+
+    // reader thread only once it runs
+    std::unique_ptr<u8[]> ring;
+    u32 ringRead = 0;
+    u32 ringUsed = 0;
+    std::unique_ptr<u8[]> chunk;
+    bool ended = false;
+
+    // main thread only
+    bool playing = false;
+
+    // shared, under mutex
+    bool loop = false;
+    bool started = false;
+    bool finished = false;
+    bool stopping = false;
+
+    int readerPriority;
+    std::mutex mutex;
+    std::condition_variable wakeReader;
+    std::thread reader;
+
+};
+
+#endif // SONG_STREAM_H
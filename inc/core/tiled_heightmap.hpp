@@ -0,0 +1,132 @@
+#ifndef TILED_HEIGHTMAP_H
+#define TILED_HEIGHTMAP_H
+
+#include <tyra>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/tinyphysicsengine.hpp"
+#include "core/heightmap.hpp"
+#include "core/heightmap_format.hpp"
+#include "core/asset_file.hpp"
+
+// Heightmap for levels too big to keep in memory, streamed out of a .hmt
+// made by tools/hmapconv -t. Only a fixed number of tiles is resident at
+// once. Update (once a frame, main thread) asks for the ones around the car,
+// a loader thread reads them, and the tiles nobody asked for the longest get
+// reused when a new one needs room.
+//
+// Queries read whatever is resident without locking, the loader only ever
+// writes into tiles that aren't handed out yet. Where a tile isn't loaded
+// (yet) heights come from the low res overview of the whole map, so there is
+// always ground. Neighbouring tiles share their edge samples, so crossing a
+// tile is seamless.
+//
+// Update doesn't allocate, everything it needs is set up for residentTiles
+// tiles in the constructor.
+//
+// Placement comes from the file, not from the level.
+class TiledHeightmap
+{
+
+public:
+    // residentTiles is how many are kept around, it has to fit the
+    // (2 * radius + 1)^2 tiles Update asks for
+    TiledHeightmap(const std::string& path, int residentTiles = 25);
+    ~TiledHeightmap();
+
+    // False if the file was missing or malformed, every height is 0 then
+    bool IsLoaded() const { return loaded; }
+
+    // Asks for every tile within radius tiles of position, nearest first
+    void Update(const Tyra::Vec4& position, int radius = 2);
+    bool IsResident(const Tyra::Vec4& position) const;
+
+    // Same surface and semantics as Heightmap's sampleBilinear,
+    // sampleTriangle, closestPoint and environmentDistance
+    float SampleBilinear(const Tyra::Vec4& position) const;
+    float SampleTriangle(const Tyra::Vec4& position) const;
+    Tyra::Vec4 ClosestPoint(const Tyra::Vec4& position, float maxDistance) const;
+    TPE_Vec3 EnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance) const;
+
+    // Same as Heightmap's raycast, segmentCast and sphereCast, against the
+    // same surface the samplers see, resident tiles or the overview. The tile
+    // bounds stand in for Heightmap's pyramid, inside a tile the cast walks
+    // the cells it passes over. hit->nodesVisited counts tiles and cells
+    bool Raycast(const Tyra::Vec4& origin, const Tyra::Vec4& direction, float maxDistance,
+                 HeightmapHit* hit = nullptr) const;
+    bool SegmentCast(const Tyra::Vec4& from, const Tyra::Vec4& to, HeightmapHit* hit = nullptr) const;
+    bool SphereCast(const Tyra::Vec4& from, const Tyra::Vec4& to, float radius, HeightmapHit* hit = nullptr) const;
+
+    bool IsOutside(const Tyra::Vec4& position) const;
+
+private:
+    enum class SlotState
+    {
+        Free,
+        Loading,
+        Ready
+    };
+
+    struct Slot
+    {
+        SlotState state = SlotState::Free;
+        int tile = -1;
+        u32 lastWanted = 0;
+    };
+
+    void Run();
+
+    bool Cast(const Tyra::Vec4& origin, const Tyra::Vec4& direction, float maxDistance, float radius,
+              HeightmapHit* hit) const;
+
+    // Heights of the four samples of cell (x, z), in world units, in the
+    // order (x, z), (x + 1, z), (x, z + 1), (x + 1, z + 1)
+    void GetCell(int x, int z, float* heights) const;
+    float GetOverviewHeight(int x, int z) const;
+    // Cell under position and where in it position is, each 0..1
+    void GetCellPosition(const Tyra::Vec4& position, int* cellX, int* cellZ, float* fracX, float* fracZ) const;
+    int GetTile(int cellX, int cellZ) const;
+    int AcquireSlot();
+
+    bool loaded = false;
+    HeightmapTiledHeader header = {};
+    float heightScale = 0.0F;
+    float inverseCellSizeX = 0.0F;
+    float inverseCellSizeZ = 0.0F;
+    int tileCells = 0;
+    int tileStride = 0;
+
+    std::vector<HeightmapTileBounds> bounds;
+    std::vector<u16> overview;
+
+    // tile -> slot, -1 if it isn't resident or loading. Only touched on the
+    // main thread, queries check the slot is Ready
+    std::vector<s16> tileSlots;
+    std::vector<Slot> slots;
+    std::unique_ptr<u16[]> samples;
+    u32 frame = 0;
+    // Update's scratch, reserved for every slot
+    std::vector<int> wanted;
+    std::vector<int> missing;
+
+    // only the loader reads the file once it's running
+    AssetFile file;
+    // ring of slots to load, a slot is in it at most once so one per slot fits
+    std::vector<int> requests;
+    size_t requestsStart = 0;
+    size_t requestsCount = 0;
+    std::vector<int> finished;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable requestAdded;
+    std::thread loader;
+
+};
+
+#endif // TILED_HEIGHTMAP_H
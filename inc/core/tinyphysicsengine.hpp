@@ -83,6 +83,13 @@ typedef int16_t TPE_UnitReduced;        ///< Like TPE_Unit but saving space
   #define TPE_LOG(s) ; // redefine to some print function to show debug logs
 #endif
 
+#ifndef TPE_TRACE_BEGIN
+/** Redefine these to time the parts of a step in a profiler. Name is a string
+  literal, arg the index of the body being worked on. */
+  #define TPE_TRACE_BEGIN(name,arg) ;
+  #define TPE_TRACE_END ;
+#endif
+
 #ifndef TPE_LOW_SPEED
 /** Speed, in TPE_Units per ticks, that is considered low (used e.g. for auto
   deactivation of bodies). */
@@ -157,6 +164,15 @@ typedef int16_t TPE_UnitReduced;        ///< Like TPE_Unit but saving space
   #define TPE_NONROTATING_COLLISION_RESOLVE_ATTEMPTS 8
 #endif
 
+#ifndef TPE_CCD_MAX_STEPS
+/** Maximum number of environment queries a joint of a TPE_BODY_FLAG_CCD body
+  makes to sweep through one step. A joint that hasn't made it all the way by
+  then stays where it got to (its velocity stays), so this also limits how far
+  such a joint can slide along a surface in one step, to about this many times
+  its size. */
+  #define TPE_CCD_MAX_STEPS 8
+#endif
+
 #ifndef TPE_APPROXIMATE_NET_SPEED
 /** Whether to use a fast approximation for calculating net speed of bodies
   which increases performance a bit. */
@@ -202,13 +218,13 @@ TPE_Unit TPE_vec2Angle(TPE_Unit x, TPE_Unit y);
   smoothing. */
 TPE_Unit TPE_keepInRange(TPE_Unit x, TPE_Unit xMin, TPE_Unit xMax);
 
-inline TPE_Unit TPE_abs(TPE_Unit x);
-inline TPE_Unit TPE_max(TPE_Unit a, TPE_Unit b);
-inline TPE_Unit TPE_min(TPE_Unit a, TPE_Unit b);
-inline TPE_Unit TPE_nonZero(TPE_Unit x);
-inline TPE_Unit TPE_dist(TPE_Vec3 p1, TPE_Vec3 p2);
-inline TPE_Unit TPE_distApprox(TPE_Vec3 p1, TPE_Vec3 p2);
-inline TPE_Unit TPE_sqrt(TPE_Unit x);
+TPE_Unit TPE_abs(TPE_Unit x);
+TPE_Unit TPE_max(TPE_Unit a, TPE_Unit b);
+TPE_Unit TPE_min(TPE_Unit a, TPE_Unit b);
+TPE_Unit TPE_nonZero(TPE_Unit x);
+TPE_Unit TPE_dist(TPE_Vec3 p1, TPE_Vec3 p2);
+TPE_Unit TPE_distApprox(TPE_Vec3 p1, TPE_Vec3 p2);
+TPE_Unit TPE_sqrt(TPE_Unit x);
 
 /** Compute sine, TPE_FRACTIONS_PER_UNIT as argument corresponds to 2 * PI
   radians. Returns a number from -TPE_FRACTIONS_PER_UNIT to
@@ -250,6 +266,13 @@ typedef struct
                                             performance. */
 #define TPE_BODY_FLAG_ALWAYS_ACTIVE 32 /**< Will never deactivate due to low
                                             energy. */
+#define TPE_BODY_FLAG_CCD 64           /**< Joints moving further than their
+                                            size in a step sweep towards the
+                                            new position instead of jumping
+                                            there, so they can't pass through
+                                            thin environment. Costs up to
+                                            TPE_CCD_MAX_STEPS environment
+                                            queries per such joint. */
 
 /** Function used for defining static environment, working similarly to an SDF
   (signed distance function). The parameters are: 3D point P, max distance D.
@@ -289,12 +312,31 @@ typedef struct
   uint8_t deactivateCount;
 } TPE_Body;
 
+/** Counts of the work done by one TPE_worldStep, see TPE_World::stats. */
+typedef struct
+{
+  uint32_t environmentCalls;     ///< calls of the environment function
+  uint32_t collisionIterations;  /**< iterations spent shifting joints out of
+                                      the environment */
+  uint32_t unresolvedCollisions; /**< joint-environment collisions given up on
+                                      (and undone) */
+  uint32_t reshapePasses;        ///< TPE_bodyReshape calls
+  uint32_t bodyPairsTested;      ///< body pairs whose AABBs were checked
+  uint32_t bodyPairsOverlapping; ///< of those, pairs whose AABBs overlapped
+  uint32_t jointTests;           ///< joint-joint collision tests
+  uint32_t jointsSwept;          ///< joints moved by TPE_BODY_FLAG_CCD sweeps
+  uint32_t bodiesActive;
+  uint32_t bodiesAsleep;         ///< deactivated, not counting disabled ones
+} TPE_WorldStats;
+
 typedef struct
 {
   TPE_Body *bodies;
   uint16_t bodyCount;
   TPE_ClosestPointFunction environmentFunction;
   TPE_CollisionCallback collisionCallback;
+  TPE_WorldStats *stats; /**< If not 0, reset and filled by every step, costs
+                              an extra call per environment query. */
 } TPE_World;
 
 /** Tests the mathematical validity of given closest point function (function
@@ -553,6 +595,11 @@ uint32_t TPE_bodyHash(const TPE_Body *body);
   possibly not all of it, for details check the code. */
 uint32_t TPE_worldHash(const TPE_World *world);
 
+/** Adds the next body's hash (TPE_bodyHash) to a world hash, starting from 0
+  and going in body order gives TPE_worldHash. For keeping the hash up to date
+  without rehashing bodies that didn't change. */
+uint32_t TPE_worldHashAdd(uint32_t worldHash, uint32_t bodyHash);
+
 // FUNCTIONS FOR GENERATING BODIES
 
 void TPE_makeBox(TPE_Joint joints[8], TPE_Connection connections[16],
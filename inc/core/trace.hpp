@@ -0,0 +1,144 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <tyra>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timeline recorder writing the Chrome trace event format, for looking at
+// single frames and hitches in chrome://tracing or ui.perfetto.dev. Build
+// with -DGWC_TRACE (make -C host TRACE=1) to get it, without it the macros
+// are empty and trace.cpp compiles to nothing.
+//
+//   TRACE_SCOPE("ClearLevel");      records the rest of the block
+//   TRACE_SCOPE_ARG("Body", i);     same, with a number shown as its arg
+//   TRACE_THREAD("Asset loader");   names the calling thread in the viewer
+//
+// Every PROFILE_SCOPE is a trace scope too. Unlike the profiler this works
+// on any thread: each one gets its own buffer the first time it records, and
+// only ever appends to it, so recording takes no lock. Write can run at any
+// time from any thread, it takes what every buffer has so far. A buffer keeps
+// TRACE_EVENTS_PER_THREAD events, the ones after that are dropped and counted.
+
+#define TRACE_EVENTS_PER_THREAD (1 << 18)
+#define TRACE_MAX_DEPTH 64
+
+#ifdef GWC_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, arg)
+#define TRACE_THREAD(name) Trace::SetThreadName(name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, arg)
+#define TRACE_THREAD(name)
+#endif
+
+class Trace
+{
+
+public:
+    // Names have to outlive the trace, string literals
+    static void Begin(const char* name, int arg = -1)
+    {
+        ThreadBuffer* buffer = GetBuffer();
+        if (buffer->depth < TRACE_MAX_DEPTH)
+        {
+            buffer->open[buffer->depth] = {name, arg, Now()};
+        }
+        buffer->depth++;
+    }
+
+    static void End()
+    {
+        ThreadBuffer* buffer = GetBuffer();
+        if (buffer->depth == 0 || --buffer->depth >= TRACE_MAX_DEPTH)
+        {
+            return;
+        }
+
+        const Open& open = buffer->open[buffer->depth];
+        u32 count = buffer->count.load(std::memory_order_relaxed);
+        if (count == TRACE_EVENTS_PER_THREAD)
+        {
+            // only its own thread writes, no need for a read-modify-write
+            buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        buffer->events[count] = {open.name, open.arg, open.start, Now() - open.start};
+        // the event has to be in place before Write can see it
+        buffer->count.store(count + 1, std::memory_order_release);
+    }
+
+    static void SetThreadName(const char* name) { GetBuffer()->name = name; }
+
+    static bool Write(const std::string& path);
+    // Write once the program exits normally
+    static void WriteAtExit(const std::string& path);
+
+private:
+    struct Event
+    {
+        const char* name;
+        int arg;
+        u64 start;    // ns since startup
+        u64 duration;
+    };
+
+    struct Open
+    {
+        const char* name;
+        int arg;
+        u64 start;
+    };
+
+    struct ThreadBuffer
+    {
+        int id;
+        std::atomic<const char*> name;
+        Event events[TRACE_EVENTS_PER_THREAD];
+        std::atomic<u32> count;
+        std::atomic<u32> dropped;
+        Open open[TRACE_MAX_DEPTH];
+        u32 depth;
+    };
+
+    static ThreadBuffer* GetBuffer()
+    {
+        static thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer)
+        {
+            buffer = AddBuffer();
+        }
+        return buffer;
+    }
+
+    static ThreadBuffer* AddBuffer();
+
+    // never freed, threads still running at exit may record into theirs
+    static std::mutex buffersMutex;
+    static std::vector<ThreadBuffer*>* buffers;
+
+    static u64 Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static const std::chrono::steady_clock::time_point start;
+
+};
+
+class TraceScope
+{
+
+public:
+    TraceScope(const char* name, int arg = -1) { Trace::Begin(name, arg); }
+    ~TraceScope() { Trace::End(); }
+
+};
+
+#endif // TRACE_H
@@ -7,7 +7,10 @@
 #include "core/level.hpp"
 #include "components/physics_component.hpp"
 #include "core/heightmap.hpp"
-#include <set>
+
+#define WORLD_MAX_BODIES 10
+#define WORLD_MAX_JOINTS 128
+#define WORLD_MAX_CONNECTIONS 256
 
 class Level;
 
@@ -31,11 +34,16 @@ public:
 
     Level* GetLevel();
 
-    void AddEnvironmentCollision(int jointIndex);
+    void AddEnvironmentCollision(int bodyIndex, int jointIndex);
     void RemoveEnvironmentCollision(TPE_Joint* joint);
     bool GetEnvironmentCollision(TPE_Joint* joint);
 
     TPE_Vec3 GetLevelEnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance);
+    // What the TPE world collides with, for anything moving outside of it
+    TPE_ClosestPointFunction GetEnvironmentFunction() const { return tpeWorld.environmentFunction; }
+
+    // What the last physics step did, all zero without GWC_PROFILE
+    const TPE_WorldStats& GetPhysicsStats() const { return physicsStats; }
 
 private:
     static World* world;
@@ -44,6 +52,7 @@ private:
     void Update() override;
 
     TPE_World tpeWorld;
+    TPE_WorldStats physicsStats = {};
     TPE_Body* tpeBodies;
     TPE_Joint* tpeJoints;
     TPE_Connection* tpeConnections;
@@ -53,8 +62,9 @@ private:
     int usedJoints = 0;
     int usedConnections = 0;
 
-    std::set<TPE_Joint*> envCollisions;
-    std::set<TPE_Joint*> lastEnvCollisions;
+    // by index into tpeJoints, flags instead of sets so a step doesn't allocate
+    bool envCollisions[WORLD_MAX_JOINTS] = {};
+    bool lastEnvCollisions[WORLD_MAX_JOINTS] = {};
 
 
 };
@@ -3,15 +3,27 @@
 #include <tyra>
 
 #include "core/helper.hpp"
+#include "core/game_clock.hpp"
+#include "core/asset_archive.hpp"
+#include "core/asset_cache.hpp"
+#include "core/asset_loader.hpp"
+#include "core/song_stream.hpp"
 #include "core/world.hpp"
 #include "core/level.hpp"
+#include "core/profiler.hpp"
 
 #include "objects/car.hpp"
 #include "objects/camera.hpp"
+#include "objects/profiler_overlay.hpp"
 #include "levels/level_studio.hpp"
 #include "levels/level_menu.hpp"
 #include "levels/level01.hpp"
 
+// how much of the way to the camera spot the view moves per frame, and the
+// framerate that's meant for
+#define CAMERA_FOLLOW 0.1f
+#define CAMERA_FOLLOW_RATE 50.0f
+
 namespace Tyra {
 
 class GameWithCar : public Game {
@@ -28,18 +40,44 @@ class GameWithCar : public Game {
   void StartMenu();
   void StartGame();
 
+  // Before init, parse every level's meshes on the main thread in its Setup
+  // instead of ahead of time on the loader thread
+  void SetSynchronousLoading(bool synchronous) { synchronousLoading = synchronous; }
+  // Before init, for runs that have to come out the same every time: rand
+  // starts from seed, level01 always plays the first song and loading is
+  // synchronous
+  void SetDeterministic(unsigned seed);
+  bool IsDeterministic() const { return deterministic; }
+
  private:
   static GameWithCar* gwc;
 
   // I don' like this
   bool shouldStartMenu = false;
   bool shouldStartGame = false;
+  bool synchronousLoading = false;
+  bool deterministic = false;
+  unsigned seed = 0;
 
   Engine* engine;
   
   Vec4 cameraPosition, cameraLookAt;
-  
+
+  void Loop();
+  bool AssetsReady(const AssetManifest& manifest);
+  void LogLevelSwitch(u32 startTicks);
+
+  GameClock clock;
+
+  // declared before the world, so it outlives everything holding cached assets
+  std::unique_ptr<AssetArchive> assetArchive;
+  std::unique_ptr<AssetLoader> assetLoader;
+  std::unique_ptr<SongStream> music;
+  std::unique_ptr<AssetCache> assetCache;
   std::unique_ptr<World> world;
+#ifdef GWC_PROFILE
+  std::unique_ptr<ProfilerOverlay> profilerOverlay;
+#endif
 };
 
 }  // namespace Tyra
@@ -2,13 +2,17 @@
 #define TERRAIN_LEVEL01_H
 
 #include <tyra>
+#include <memory>
 #include <string>
 
 #include "core/tinyphysicsengine.hpp"
 #include "core/tinyphysicsengine.hpp"
 #include "core/heightmap.hpp"
+#include "core/tiled_heightmap.hpp"
 #include "core/level.hpp"
 #include "core/helper.hpp"
+#include "core/asset_loader.hpp"
+#include "core/song_stream.hpp"
 
 #include "objects/car.hpp"
 
@@ -19,12 +23,17 @@ public:
     Level01(Tyra::Engine* engine);
     ~Level01() {};
 
+    static AssetManifest GetManifest();
+
     TPE_Vec3 EnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance) override;
 private:
     void Setup() override;
     void Update() override;
     void Render() override;
 
+    Car* car = nullptr;
+    std::unique_ptr<Heightmap> heightmap;
+    std::unique_ptr<TiledHeightmap> tiledHeightmap;
 };
 
 #endif // TERRAIN_LEVEL01_H
\ No newline at end of file
@@ -8,8 +8,11 @@
 #include "core/heightmap.hpp"
 #include "core/level.hpp"
 #include "core/helper.hpp"
+#include "core/asset_loader.hpp"
+#include "core/song_stream.hpp"
 
 #include "components/sprite_component.hpp"
+#include "components/instanced_mesh_component.hpp"
 
 #include "objects/camera.hpp"
 #include "objects/car_prop.hpp"
@@ -22,12 +25,16 @@ public:
     LevelMenu(Tyra::Engine* engine);
     ~LevelMenu() {};
 
+    static AssetManifest GetManifest();
+
     TPE_Vec3 EnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance) override;
 private:
     void Setup() override;
     void Update() override;
     void Render() override;
 
+    bool prefetched = false;
+
 };
 
 #endif // TERRAIN_LEVEL00_H
\ No newline at end of file
@@ -12,6 +12,9 @@
 
 #include "objects/camera.hpp"
 
+// seconds the splash stays up, at least, the menu may take longer to load
+#define LEVEL_STUDIO_SPLASH_TIME 3.0f
+
 class LevelStudio : public Level // Main Menu
 {
 
@@ -27,7 +30,7 @@ private:
 
     audsrv_adpcm_t* sound;
 
-    int counter = 0;
+    float shown = 0.0f;
 
 };
 
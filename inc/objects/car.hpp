@@ -2,23 +2,42 @@
 #define CAR_H
 
 #include <tyra>
+#include <memory>
 
 #include "core/game_object.hpp"
 #include "core/world.hpp"
 #include "core/helper.hpp"
 #include "components/static_mesh_component.hpp"
+#include "components/instanced_mesh_component.hpp"
 #include "components/physics_component.hpp"
+#include "core/raycast_vehicle.hpp"
 
 #include "objects/wheel.hpp"
 #include "objects/camera.hpp"
 #include "objects/ui.hpp"
 
+// seconds, car/engine.adp gets played again right as it ends
+#define CAR_ENGINE_SOUND_LENGTH 2.0f
+
+// What drives a car: the five joint TPE soft body, or the cheaper rigid
+// chassis on four suspension rays (see raycast_vehicle.hpp)
+enum class CarModel
+{
+    SoftBody,
+    Raycast
+};
+
+// build with -DCAR_MODEL_DEFAULT=CarModel::Raycast to drive that instead
+#ifndef CAR_MODEL_DEFAULT
+#define CAR_MODEL_DEFAULT CarModel::SoftBody
+#endif
+
 class CarWheel;
 
 class Car : public GameObject {
 
 public:
-    Car(Tyra::Engine* engine);
+    Car(Tyra::Engine* engine, CarModel model = CAR_MODEL_DEFAULT);
     ~Car();
     float GetCurrentInputAcceleration();
 private:
@@ -31,6 +50,13 @@ private:
     void Update() override;
     void Render() override;
     void PhysicsUpdate() override;
+    void SoftBodyUpdate();
+    void RaycastUpdate();
+    // Cross and Square into the acceleration, while the car can drive
+    void UpdateAcceleration(bool driving);
+
+    CarModel model;
+    std::unique_ptr<RaycastVehicle> vehicle;
 
     std::vector<CarWheel*> wheels;
     float wheelRotation = 0.f;
@@ -43,13 +69,14 @@ private:
     float minAcceleration = -.85f;
 
     StaticMeshComponent* staticMeshComponent;
+    InstancedMeshComponent* wheelMeshes;
     PhysicsComponent* physicsComponent;
     GameObject* cameraSpot;
     World* world;
 
     audsrv_adpcm_t* engineSound;
     bool engineSoundChannel = 0;
-    u32 engineSoundFramesCounter = 0;
+    float engineSoundTime = 0.0f;
 };
 
 #endif
\ No newline at end of file
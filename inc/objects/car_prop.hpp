@@ -6,6 +6,7 @@
 #include "core/game_object.hpp"
 #include "core/world.hpp"
 #include "components/static_mesh_component.hpp"
+#include "components/instanced_mesh_component.hpp"
 #include "components/physics_component.hpp"
 
 #include "objects/wheel.hpp"
@@ -27,6 +28,7 @@ private:
     std::vector<CarWheel*> wheels;
 
     StaticMeshComponent* staticMeshComponent;
+    InstancedMeshComponent* wheelMeshes;
     PhysicsComponent* physicsComponent;
     World* world;
 
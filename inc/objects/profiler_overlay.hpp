@@ -0,0 +1,48 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <tyra>
+#include <memory>
+
+#include "core/game_object.hpp"
+#include "core/profiler.hpp"
+
+// Profiler numbers on screen, only built with GWC_PROFILE. Select toggles it.
+//
+// There is no font to print with, so every zone is a row of pips, one per
+// millisecond. Solid up to the average, faded up to the p99, the frame itself
+// on top. Counters (the physics step ones from World) follow in grey, a pip
+// per their unit, and the main thread's allocations per frame last in red, a
+// pip each. While it's shown the full table goes to the log every
+// PROFILER_FRAMES frames.
+class ProfilerOverlay : public GameObject
+{
+
+public:
+    ProfilerOverlay(Tyra::Engine* engine);
+    ~ProfilerOverlay();
+
+private:
+    void Setup() override;
+    void Update() override;
+    void Render() override;
+
+    void RenderRow(int row, float solid, float faded, const Tyra::Color& color);
+
+    bool visible = false;
+    int framesShown = 0;
+
+    // sorting the history isn't free, so it's only redone every few frames
+    ProfileStats frameStats = {};
+    ProfileStats zoneStats[PROFILER_MAX_ZONES] = {};
+    int zoneCount = 0;
+    ProfileStats counterStats[PROFILER_MAX_COUNTERS] = {};
+    int counterCount = 0;
+    ProfileStats allocStats = {};
+
+    Tyra::Sprite pip;
+    std::shared_ptr<Tyra::Texture> texture;
+
+};
+
+#endif // PROFILER_OVERLAY_H
@@ -5,12 +5,12 @@
 
 #include "core/game_object.hpp"
 #include "core/world.hpp"
-#include "components/static_mesh_component.hpp"
+#include "components/mesh_instance_component.hpp"
 
 class Tree : public GameObject {
 
 public:
-    Tree(Tyra::Engine* engine);
+    Tree(Tyra::Engine* engine, InstancedMeshComponent* forest);
     ~Tree();
 private:
 
@@ -19,7 +19,8 @@ private:
     void Render() override;
     void PhysicsUpdate() override;
 
-    StaticMeshComponent* staticMeshComponent;
+    InstancedMeshComponent* forest;
+    MeshInstanceComponent* meshInstanceComponent;
     World* world;
 
 };
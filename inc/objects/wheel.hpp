@@ -3,14 +3,14 @@
 
 #include <tyra>
 #include "core/game_object.hpp"
-#include "components/static_mesh_component.hpp"
+#include "components/mesh_instance_component.hpp"
 #include "objects/car.hpp"
 
 class CarWheel : public GameObject
 {
 
 public:
-    CarWheel(Tyra::Engine* engine);
+    CarWheel(Tyra::Engine* engine, InstancedMeshComponent* wheelMeshes);
     ~CarWheel() {}
 
 private:
@@ -18,7 +18,8 @@ private:
     void Render() override;
     void Update() override;
 
-    StaticMeshComponent* staticMeshComponent;
+    InstancedMeshComponent* wheelMeshes;
+    MeshInstanceComponent* meshInstanceComponent;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "components/instanced_mesh_component.hpp"
+#include "objects/camera.hpp"
+
+InstancedMeshComponent::InstancedMeshComponent(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options)
+    : GameComponent("InstancedMesh")
+{
+    this->modelPath = modelPath;
+    this->texturePath = texturePath;
+    this->options = options;
+}
+
+InstancedMeshComponent::~InstancedMeshComponent()
+{
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
+}
+
+void InstancedMeshComponent::SetCullDistance(float distance)
+{
+    cullDistance = distance;
+}
+
+void InstancedMeshComponent::SetBoundingRadius(float radius)
+{
+    boundingRadius = radius;
+}
+
+void InstancedMeshComponent::Setup()
+{
+    lods.Resolve(modelPath, texturePath, options);
+    drawLists.resize(lods.GetCount());
+
+    pipeline.setRenderer(&owner->GetEngine()->renderer.core);
+
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " created");
+}
+
+size_t InstancedMeshComponent::AddInstance()
+{
+    size_t id;
+    if (!freeSlots.empty())
+    {
+        id = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        id = instances.size();
+        instances.emplace_back();
+    }
+
+    auto& instance = instances[id];
+    instance.translation.identity();
+    instance.rotation.identity();
+    instance.scale.identity();
+    instance.lod = 0;
+    instance.active = true;
+    instance.visible = true;
+    return id;
+}
+
+void InstancedMeshComponent::RemoveInstance(size_t id)
+{
+    TYRA_ASSERT(id < instances.size() && instances[id].active, "Removing an instance that doesn't exist");
+    instances[id].active = false;
+    freeSlots.push_back(id);
+}
+
+void InstancedMeshComponent::SetInstanceTransform(size_t id, const Tyra::M4x4& translation, const Tyra::M4x4& rotation)
+{
+    instances[id].translation = translation;
+    instances[id].rotation = rotation;
+}
+
+void InstancedMeshComponent::SetInstanceScale(size_t id, float scale)
+{
+    auto& matrix = instances[id].scale;
+    matrix.identity();
+    matrix.data[0] = scale;
+    matrix.data[5] = scale;
+    matrix.data[10] = scale;
+}
+
+void InstancedMeshComponent::SetInstanceVisible(size_t id, bool visible)
+{
+    instances[id].visible = visible;
+}
+
+void InstancedMeshComponent::Render()
+{
+    if (!lods.IsResolved())
+    {
+        return;
+    }
+
+    Camera* camera = Camera::GetCamera();
+    Tyra::Vec4 cameraPosition, cameraForward;
+    if (camera)
+    {
+        cameraPosition = camera->GetWorldPosition();
+        cameraForward = camera->GetTargetLookAt() - cameraPosition;
+        cameraForward.w = 0.f;
+        cameraForward.normalize();
+    }
+
+    for (auto& drawList : drawLists)
+    {
+        drawList.clear();
+    }
+
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        auto& instance = instances[i];
+        if (!instance.active || !instance.visible)
+        {
+            continue;
+        }
+
+        if (camera)
+        {
+            Tyra::Vec4 position(instance.translation.data[12], instance.translation.data[13], instance.translation.data[14], 1.0f);
+            Tyra::Vec4 offset = position - cameraPosition;
+            offset.w = 0.f;
+            float distance = offset.length();
+            float radius = boundingRadius * instance.scale.data[0];
+
+            if (cullDistance > 0.f && distance - radius > cullDistance)
+            {
+                continue;
+            }
+            if (radius > 0.f && offset.dot3(cameraForward) < -radius)
+            {
+                continue;
+            }
+            instance.lod = lods.Select(instance.lod, distance);
+        }
+
+        drawLists[instance.lod].push_back(i);
+    }
+
+    // one pipeline switch for the whole set, the shared meshes only get the
+    // instance transform written in right before each draw
+    this->owner->GetEngine()->renderer.renderer3D.usePipeline(pipeline);
+    for (size_t lod = 0; lod < lods.GetCount(); lod++)
+    {
+        auto* mesh = lods.GetMesh(lod);
+        for (auto id : drawLists[lod])
+        {
+            const auto& instance = instances[id];
+            mesh->translation = instance.translation;
+            mesh->rotation = instance.rotation;
+            mesh->scale = instance.scale;
+            pipeline.render(mesh, &pipelineOptions);
+        }
+    }
+}
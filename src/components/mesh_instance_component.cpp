@@ -0,0 +1,60 @@
+#include "components/mesh_instance_component.hpp"
+
+MeshInstanceComponent::MeshInstanceComponent(InstancedMeshComponent* instancedMesh, float scale)
+    : GameComponent("MeshInstance"),
+    instancedMesh(instancedMesh),
+    scale(scale)
+{
+    translation.identity();
+    rotation.identity();
+}
+
+MeshInstanceComponent::~MeshInstanceComponent()
+{
+    instancedMesh->RemoveInstance(instanceId);
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
+}
+
+void MeshInstanceComponent::Setup()
+{
+    instanceId = instancedMesh->AddInstance();
+    instancedMesh->SetInstanceScale(instanceId, scale);
+
+    auto newPosition = owner->GetWorldPosition() + owner->GetLocalPosition();
+    newPosition.w = 1.0f;
+    translation.setTranslation(newPosition);
+    rotation.rotate(owner->GetWorldRotation() + owner->GetLocalRotation());
+    Sync();
+
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " created");
+}
+
+void MeshInstanceComponent::Sync()
+{
+    instancedMesh->SetInstanceTransform(instanceId, translation, rotation);
+}
+
+void MeshInstanceComponent::SetVisible(bool visible)
+{
+    instancedMesh->SetInstanceVisible(instanceId, visible);
+}
+
+void MeshInstanceComponent::EventTrigger(ComponentType event, const void* data)
+{
+    switch (event)
+    {
+    case ComponentType::Move:
+        translation.translate(*reinterpret_cast<const Tyra::Vec4*>(data));
+        break;
+    case ComponentType::SetRot:
+        translation.identity();
+        translation.rotate(*reinterpret_cast<const Tyra::Vec4*>(data));
+        break;
+    case ComponentType::SetPos:
+        translation.setTranslation(*reinterpret_cast<const Tyra::Vec4*>(data));
+        break;
+    default:
+        return;
+    }
+    Sync();
+}
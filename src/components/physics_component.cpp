@@ -8,6 +8,15 @@ PhysicsComponent::PhysicsComponent(TPE_Body* body)
     
 }
 
+PhysicsComponent::PhysicsComponent(RaycastVehicle* vehicle)
+    : GameComponent("Physics"),
+    world(World::GetWorld()),
+    body(nullptr),
+    vehicle(vehicle)
+{
+
+}
+
 PhysicsComponent::~PhysicsComponent()
 {
     TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
@@ -20,6 +29,13 @@ void PhysicsComponent::Setup()
 
 void PhysicsComponent::Update()
 {
+    if (vehicle)
+    {
+        // gravity is in its step
+        physicsRotation = vehicle->GetRotation();
+        physicsPosition = TPE_vec3KeepWithinBox(physicsPosition, vehicle->GetPosition(), TPE_vec3(TPE_F / 50,TPE_F / 50,TPE_F / 50));
+        return;
+    }
     TPE_bodyApplyGravity(body, world->GetLevel()->GetGravity());
     physicsRotation = TPE_bodyGetRotation(body, 0, 2, 1);
     physicsPosition = TPE_vec3KeepWithinBox(physicsPosition, body->joints[4].position, TPE_vec3(TPE_F / 50,TPE_F / 50,TPE_F / 50));
@@ -46,4 +62,9 @@ Tyra::Vec4 PhysicsComponent::GetPhysicsRotation()
 TPE_Body* PhysicsComponent::GetBody()
 {
     return body;
+}
+
+RaycastVehicle* PhysicsComponent::GetVehicle()
+{
+    return vehicle;
 }
\ No newline at end of file
@@ -12,12 +12,16 @@ SpriteComponent::SpriteComponent(const std::string& imagePath, const Tyra::Sprit
 SpriteComponent::~SpriteComponent()
 {
     TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
-    owner->GetEngine()->renderer.getTextureRepository().freeBySprite(sprite);
+    if (texture)
+    {
+        texture->removeLinkById(sprite.id);
+    }
 }
 
 void SpriteComponent::Setup()
 {
-    auto texture = owner->GetEngine()->renderer.getTextureRepository().add(Helper::fromCwd(imagePath));
+    // sprites using the same image share a single texture
+    texture = AssetCache::GetAssetCache()->GetTexture(imagePath);
     texture->addLink(this->sprite.id);
     TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " created");
 }
@@ -0,0 +1,273 @@
+#include "components/static_batch_component.hpp"
+#include "objects/camera.hpp"
+
+#include <map>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+struct TriangleSoup
+{
+    Tyra::Color ambient;
+    std::optional<std::string> texturePath;
+    std::vector<Tyra::Vec4> vertices;
+    std::vector<Tyra::Vec4> normals;
+    std::vector<Tyra::Vec4> textureCoords;
+    std::vector<Tyra::Color> colors;
+};
+
+// material name -> triangles, std::map keeps the material order stable between runs
+typedef std::map<std::string, TriangleSoup> SoupsByMaterial;
+
+void AppendVertex(TriangleSoup& soup, const Tyra::MeshBuilderDataMaterialFrame* frame, u32 i)
+{
+    soup.vertices.push_back(frame->vertices[i]);
+    if (frame->normals) soup.normals.push_back(frame->normals[i]);
+    if (frame->textureCoords) soup.textureCoords.push_back(frame->textureCoords[i]);
+    if (frame->colors) soup.colors.push_back(frame->colors[i]);
+}
+
+template <typename T>
+T* CopyArray(const std::vector<T>& source, size_t count)
+{
+    // materials merged from different files may disagree on which attributes
+    // they have, drop the attribute if any of them is missing it
+    if (source.size() != count)
+    {
+        return nullptr;
+    }
+    T* result = new T[count];
+    for (size_t i = 0; i < count; i++)
+    {
+        result[i] = source[i];
+    }
+    return result;
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> ToBuilderData(const SoupsByMaterial& soups, bool loadNormals)
+{
+    auto result = std::make_unique<Tyra::MeshBuilderData>();
+    result->loadNormals = loadNormals;
+
+    for (const auto& entry : soups)
+    {
+        const auto& soup = entry.second;
+        auto frame = std::make_unique<Tyra::MeshBuilderDataMaterialFrame>();
+        frame->count = soup.vertices.size();
+        frame->vertices = CopyArray(soup.vertices, frame->count);
+        frame->normals = CopyArray(soup.normals, frame->count);
+        frame->textureCoords = CopyArray(soup.textureCoords, frame->count);
+        frame->colors = CopyArray(soup.colors, frame->count);
+
+        auto material = std::make_unique<Tyra::MeshBuilderDataMaterial>();
+        material->name = entry.first;
+        material->ambient = soup.ambient;
+        material->texturePath = soup.texturePath;
+        material->frames.push_back(std::move(frame));
+        result->materials.push_back(std::move(material));
+    }
+
+    return result;
+}
+
+std::string NormalizeDirectory(std::string path)
+{
+    while (!path.empty() && path.back() == '/')
+    {
+        path.pop_back();
+    }
+    return path;
+}
+
+}
+
+StaticBatchComponent::StaticBatchComponent(float chunkSize)
+    : GameComponent("StaticBatch"),
+    chunkSize(chunkSize)
+{
+
+}
+
+StaticBatchComponent::~StaticBatchComponent()
+{
+    auto& textureRepository = owner->GetEngine()->renderer.getTextureRepository();
+    for (const auto& chunk : chunks)
+    {
+        textureRepository.freeByMesh(chunk.mesh.get());
+    }
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
+}
+
+void StaticBatchComponent::Setup()
+{
+    pipeline.setRenderer(&owner->GetEngine()->renderer.core);
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " created");
+}
+
+void StaticBatchComponent::AddMesh(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options)
+{
+    TYRA_ASSERT(!built, "Static batch was already built");
+    sources.push_back({modelPath, texturePath, options});
+}
+
+void StaticBatchComponent::SetCullDistance(float distance)
+{
+    cullDistance = distance;
+}
+
+void StaticBatchComponent::Build()
+{
+    TYRA_ASSERT(!built, "Static batch was already built");
+    built = true;
+
+    // texture directory -> chunk -> material -> triangles
+    std::map<std::string, std::map<std::pair<int, int>, SoupsByMaterial>> groups;
+    bool loadNormals = false;
+    size_t sourceMaterials = 0;
+
+    for (const auto& source : sources)
+    {
+        auto data = MeshLoader::Load(source.modelPath, source.options);
+        loadNormals |= data->loadNormals;
+        auto& cells = groups[NormalizeDirectory(source.texturePath)];
+
+        for (const auto& material : data->materials)
+        {
+            if (material->frames.empty()) continue;
+            const auto* frame = material->frames[0].get();
+            sourceMaterials++;
+
+            for (u32 i = 0; i + 2 < frame->count; i += 3)
+            {
+                std::pair<int, int> cell(0, 0);
+                if (chunkSize > 0.f)
+                {
+                    float x = (frame->vertices[i].x + frame->vertices[i + 1].x + frame->vertices[i + 2].x) / 3.f;
+                    float z = (frame->vertices[i].z + frame->vertices[i + 1].z + frame->vertices[i + 2].z) / 3.f;
+                    cell.first = static_cast<int>(std::floor(x / chunkSize));
+                    cell.second = static_cast<int>(std::floor(z / chunkSize));
+                }
+
+                auto& soup = cells[cell][material->name];
+                if (soup.vertices.empty())
+                {
+                    soup.ambient = material->ambient;
+                    soup.texturePath = material->texturePath;
+                }
+                AppendVertex(soup, frame, i);
+                AppendVertex(soup, frame, i + 1);
+                AppendVertex(soup, frame, i + 2);
+            }
+        }
+    }
+
+    auto& textureRepository = owner->GetEngine()->renderer.getTextureRepository();
+    auto position = owner->GetWorldPosition() + owner->GetLocalPosition();
+    position.w = 1.f;
+    size_t chunkMaterials = 0;
+
+    for (const auto& group : groups)
+    {
+        // Upload every texture of this directory once, through a throwaway mesh
+        // with a single triangle per material, the chunks only link to them.
+        SoupsByMaterial textureSoups;
+        for (const auto& cell : group.second)
+        {
+            for (const auto& entry : cell.second)
+            {
+                if (textureSoups.count(entry.first)) continue;
+                auto& soup = textureSoups[entry.first];
+                soup.ambient = entry.second.ambient;
+                soup.texturePath = entry.second.texturePath;
+                soup.vertices.assign(entry.second.vertices.begin(), entry.second.vertices.begin() + 3);
+            }
+        }
+        auto textureData = ToBuilderData(textureSoups, false);
+        auto textureMesh = std::make_unique<Tyra::StaticMesh>(textureData.get());
+        textureRepository.addByMesh(textureMesh.get(), Helper::fromCwd(group.first), "png");
+
+        for (const auto& cell : group.second)
+        {
+            auto data = ToBuilderData(cell.second, loadNormals);
+            Chunk chunk;
+            chunk.mesh = std::make_unique<Tyra::StaticMesh>(data.get());
+            chunk.mesh->setPosition(position);
+
+            Tyra::Vec4 min(FLT_MAX, FLT_MAX, FLT_MAX);
+            Tyra::Vec4 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            for (const auto& entry : cell.second)
+            {
+                for (const auto& v : entry.second.vertices)
+                {
+                    if (v.x < min.x) min.x = v.x;
+                    if (v.y < min.y) min.y = v.y;
+                    if (v.z < min.z) min.z = v.z;
+                    if (v.x > max.x) max.x = v.x;
+                    if (v.y > max.y) max.y = v.y;
+                    if (v.z > max.z) max.z = v.z;
+                }
+            }
+            chunk.center = (min + max) / 2.f + position;
+            chunk.center.w = 1.f;
+            chunk.radius = (max - min).length() / 2.f;
+
+            for (auto* material : chunk.mesh->materials)
+            {
+                for (auto* textureMaterial : textureMesh->materials)
+                {
+                    if (textureMaterial->getName() != material->getName()) continue;
+
+                    auto* texture = textureRepository.getByMeshMaterialId(textureMaterial->getId());
+                    if (texture)
+                    {
+                        texture->addLink(material->getId());
+                    }
+                    break;
+                }
+            }
+
+            chunkMaterials += chunk.mesh->materials.size();
+            chunks.push_back(std::move(chunk));
+        }
+
+        for (auto* textureMaterial : textureMesh->materials)
+        {
+            auto* texture = textureRepository.getByMeshMaterialId(textureMaterial->getId());
+            if (texture)
+            {
+                texture->removeLinkById(textureMaterial->getId());
+            }
+        }
+    }
+
+    TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), ": ", sources.size(), " meshes / ", sourceMaterials,
+             " materials batched into ", chunks.size(), " chunks / ", chunkMaterials, " materials");
+    sources.clear();
+}
+
+void StaticBatchComponent::Render()
+{
+    if (chunks.empty())
+    {
+        return;
+    }
+
+    Camera* camera = Camera::GetCamera();
+    Tyra::Vec4 cameraPosition;
+    bool cull = cullDistance > 0.f && camera;
+    if (cull)
+    {
+        cameraPosition = camera->GetWorldPosition();
+    }
+
+    this->owner->GetEngine()->renderer.renderer3D.usePipeline(pipeline);
+    for (const auto& chunk : chunks)
+    {
+        if (cull && cameraPosition.distanceTo(chunk.center) - chunk.radius > cullDistance)
+        {
+            continue;
+        }
+        pipeline.render(chunk.mesh.get(), &pipelineOptions);
+    }
+}
@@ -1,4 +1,5 @@
 #include "components/static_mesh_component.hpp"
+#include "objects/camera.hpp"
 
 StaticMeshComponent::StaticMeshComponent(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options) 
     : GameComponent("StaticMesh") 
@@ -6,37 +7,61 @@ StaticMeshComponent::StaticMeshComponent(const std::string& modelPath, const std
     this->modelPath = modelPath;
     this->texturePath = texturePath;
     this->options = options;
+    translation.identity();
+    rotation.identity();
 }
 
 StaticMeshComponent::~StaticMeshComponent()
 {
-    this->owner->GetEngine()->renderer.getTextureRepository().freeByMesh(mesh.get());
     TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " deleted");
 }
 
 void StaticMeshComponent::Setup()
 {
-    auto data = Tyra::ObjLoader::load(Helper::fromCwd(modelPath), options);
-    mesh = std::make_unique<Tyra::StaticMesh>(data.get());
-    owner->GetEngine()->renderer.getTextureRepository().addByMesh(mesh.get(), Helper::fromCwd(texturePath), "png");
+    lods.Resolve(modelPath, texturePath, options);
+
     pipeline.setRenderer(&owner->GetEngine()->renderer.core);
     auto newPosition = owner->GetWorldPosition() + owner->GetLocalPosition();
     newPosition.w = 1.0f;
-    mesh->setPosition(newPosition);
-    mesh->rotation.rotate(owner->GetWorldRotation() + owner->GetLocalRotation());
+    SetPosition(newPosition);
+    rotation.rotate(owner->GetWorldRotation() + owner->GetLocalRotation());
 
     TYRA_LOG(owner->GetObjectName(), " -> ", GetComponentName(), " created");
 }
 
-void StaticMeshComponent::Update()
+Tyra::Vec4 StaticMeshComponent::GetPosition() const
+{
+    return Tyra::Vec4(translation.data[12], translation.data[13], translation.data[14], 1.0f);
+}
+
+void StaticMeshComponent::UpdateLod()
 {
+    Camera* camera = Camera::GetCamera();
+    if (!camera)
+    {
+        return;
+    }
 
+    currentLod = lods.Select(currentLod, camera->GetWorldPosition().distanceTo(GetPosition()));
+}
+
+void StaticMeshComponent::Update()
+{
+    if (lods.GetCount() > 1)
+    {
+        UpdateLod();
+    }
 }
 
 void StaticMeshComponent::Render()
 {
+    auto* mesh = lods.GetMesh(currentLod);
+    mesh->translation = translation;
+    mesh->rotation = rotation;
+    mesh->scale = Tyra::M4x4::Identity;
+
     this->owner->GetEngine()->renderer.renderer3D.usePipeline(pipeline);
-    pipeline.render(mesh.get(), &pipelineOptions);
+    pipeline.render(mesh, &pipelineOptions);
 }
 
 void StaticMeshComponent::EventTrigger(ComponentType event, const void* data)
@@ -44,11 +69,11 @@ void StaticMeshComponent::EventTrigger(ComponentType event, const void* data)
     switch (event)
     {
     case ComponentType::Move:
-        mesh->translation.translate(*reinterpret_cast<const Tyra::Vec4*>(data));
+        translation.translate(*reinterpret_cast<const Tyra::Vec4*>(data));
         return;
     case ComponentType::SetRot:
-        mesh->translation.identity();
-        mesh->translation.rotate(*reinterpret_cast<const Tyra::Vec4*>(data));
+        translation.identity();
+        translation.rotate(*reinterpret_cast<const Tyra::Vec4*>(data));
         return;
     case ComponentType::SetPos:
         SetPosition(*reinterpret_cast<const Tyra::Vec4*>(data));
@@ -59,10 +84,10 @@ void StaticMeshComponent::EventTrigger(ComponentType event, const void* data)
 
 void StaticMeshComponent::SetPosition(const Tyra::Vec4& newPosition)
 {
-    mesh->setPosition(newPosition);
+    translation.setTranslation(newPosition);
 }
 
 void StaticMeshComponent::Rotate(const Tyra::Vec4& addedRotation)
 {
-    mesh->rotation.rotate(addedRotation);
-}
\ No newline at end of file
+    rotation.rotate(addedRotation);
+}
@@ -0,0 +1,100 @@
+#include "core/asset_archive.hpp"
+
+#include <cstring>
+
+AssetArchive* AssetArchive::archive;
+
+AssetArchive* AssetArchive::GetArchive()
+{
+    return archive;
+}
+
+void AssetArchive::SetArchive(AssetArchive* archive_)
+{
+    archive = archive_;
+}
+
+std::unique_ptr<AssetArchive> AssetArchive::Open(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return nullptr;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    ArchiveFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != ARCHIVE_FILE_MAGIC ||
+        header.version != ARCHIVE_FILE_VERSION || header.totalSize != static_cast<u32>(size))
+    {
+        TYRA_LOG("Asset archive ", path, " is malformed, using loose files");
+        fclose(file);
+        return nullptr;
+    }
+
+    std::vector<ArchiveFileEntry> entries(header.entryCount);
+    if (header.entryCount && fread(entries.data(), sizeof(ArchiveFileEntry), header.entryCount, file) != header.entryCount)
+    {
+        TYRA_LOG("Asset archive ", path, " TOC is truncated, using loose files");
+        fclose(file);
+        return nullptr;
+    }
+
+    for (const auto& entry : entries)
+    {
+        bool compressed = entry.flags & ARCHIVE_ENTRY_FLAG_COMPRESSED;
+        // written so a huge offset or size can't wrap around past the check
+        if (entry.storedSize > header.totalSize || entry.offset > header.totalSize - entry.storedSize ||
+            (!compressed && entry.storedSize != entry.size) || entry.path[ARCHIVE_FILE_PATH_LENGTH - 1] != '\0')
+        {
+            TYRA_LOG("Asset archive ", path, " has a broken entry, using loose files");
+            fclose(file);
+            return nullptr;
+        }
+    }
+
+    TYRA_LOG("Asset archive ", path, ": ", header.entryCount, " files");
+    return std::unique_ptr<AssetArchive>(new AssetArchive(file, header.totalSize, std::move(entries)));
+}
+
+AssetArchive::AssetArchive(FILE* file, u32 totalSize, std::vector<ArchiveFileEntry> entries)
+    : file(file), totalSize(totalSize), entries(std::move(entries))
+{
+    for (size_t i = 0; i < this->entries.size(); i++)
+    {
+        index[this->entries[i].path] = i;
+    }
+}
+
+AssetArchive::~AssetArchive()
+{
+    fclose(file);
+}
+
+const ArchiveFileEntry* AssetArchive::Find(const std::string& path) const
+{
+    auto it = index.find(path);
+    if (it == index.end())
+    {
+        return nullptr;
+    }
+    return &entries[it->second];
+}
+
+bool AssetArchive::Read(u32 offset, void* destination, u32 size)
+{
+    if (offset > totalSize || size > totalSize - offset)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fseek(file, offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    return fread(destination, 1, size, file) == size;
+}
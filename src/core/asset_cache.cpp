@@ -0,0 +1,214 @@
+#include "core/asset_cache.hpp"
+
+#include <sstream>
+
+#include "core/profiler.hpp"
+
+AssetCache* AssetCache::assetCache;
+
+AssetCache* AssetCache::GetAssetCache()
+{
+    return assetCache;
+}
+
+void AssetCache::SetAssetCache(AssetCache* cache)
+{
+    assetCache = cache;
+}
+
+AssetCache::AssetCache(Tyra::Engine* engine) : engine(engine) {}
+
+AssetCache::~AssetCache()
+{
+    TYRA_ASSERT(meshes.empty() && textures.empty(), "Asset cache destroyed while its assets are still in use");
+}
+
+std::string AssetCache::MakeKey(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options)
+{
+    std::stringstream key;
+    key << modelPath << '|' << texturePath << '|' << options.scale << '|' << options.flipUVs;
+    return key.str();
+}
+
+std::shared_ptr<Tyra::StaticMesh> AssetCache::Find(const std::string& key) const
+{
+    auto it = meshes.find(key);
+    if (it != meshes.end())
+    {
+        return it->second.mesh.lock();
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Tyra::StaticMesh> AssetCache::AddMesh(const std::string& key, const Tyra::MeshBuilderData* data, const std::string& texturePath)
+{
+    auto mesh = std::make_unique<Tyra::StaticMesh>(data);
+    engine->renderer.getTextureRepository().addByMesh(mesh.get(), Helper::fromCwd(texturePath), "png");
+    TYRA_LOG("AssetCache: loaded ", key);
+
+    return Share(key, std::move(mesh), nullptr);
+}
+
+std::shared_ptr<Tyra::StaticMesh> AssetCache::GetMesh(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options)
+{
+    PROFILE_SCOPE("Assets");
+    auto key = MakeKey(modelPath, texturePath, options);
+    if (auto mesh = Find(key))
+    {
+        return mesh;
+    }
+
+    auto data = MeshLoader::Load(modelPath, options);
+    return AddMesh(key, data.get(), texturePath);
+}
+
+std::vector<std::shared_ptr<Tyra::StaticMesh>> AssetCache::GetMeshAndLods(const std::string& modelPath, const std::string& texturePath,
+                                                                          const Tyra::ObjLoaderOptions& options, const std::vector<LodSource>& sources)
+{
+    PROFILE_SCOPE("Assets");
+    auto key = MakeKey(modelPath, texturePath, options);
+
+    // the base mesh data is only around while the chain is being built, and
+    // only loaded if something has to be built from it
+    std::unique_ptr<Tyra::MeshBuilderData> baseData;
+    auto base = Find(key);
+    if (!base)
+    {
+        baseData = MeshLoader::Load(modelPath, options);
+        base = AddMesh(key, baseData.get(), texturePath);
+    }
+
+    std::vector<std::shared_ptr<Tyra::StaticMesh>> chain;
+    chain.reserve(sources.size() + 1);
+    chain.push_back(base);
+
+    for (const auto& source : sources)
+    {
+        std::stringstream lodKey;
+        lodKey << key << "|lod|" << source.modelPath << '|' << source.gridResolution;
+        auto lod = Find(lodKey.str());
+        if (lod)
+        {
+            chain.push_back(lod);
+            continue;
+        }
+
+        std::unique_ptr<Tyra::MeshBuilderData> data;
+        if (source.modelPath.empty())
+        {
+            if (!baseData)
+            {
+                baseData = MeshLoader::Load(modelPath, options);
+            }
+            data = MeshSimplifier::Simplify(baseData.get(), source.gridResolution);
+            if (data)
+            {
+                TYRA_LOG("AssetCache: generated ", lodKey.str(), ": ", MeshSimplifier::CountVertices(baseData.get()), " -> ",
+                         MeshSimplifier::CountVertices(data.get()), " vertices");
+            }
+        }
+        else
+        {
+            data = MeshLoader::Load(source.modelPath, options);
+            TYRA_LOG("AssetCache: loaded ", lodKey.str());
+        }
+
+        if (data)
+        {
+            auto mesh = std::make_unique<Tyra::StaticMesh>(data.get());
+            LinkTextures(base.get(), mesh.get());
+            lod = Share(lodKey.str(), std::move(mesh), base);
+        }
+        chain.push_back(lod);
+    }
+    return chain;
+}
+
+std::shared_ptr<Tyra::StaticMesh> AssetCache::Share(const std::string& key, std::unique_ptr<Tyra::StaticMesh> mesh, std::shared_ptr<Tyra::StaticMesh> base)
+{
+    // LODs hold on to their base mesh, so the textures they link to stay alive
+    bool isLod = base != nullptr;
+    std::shared_ptr<Tyra::StaticMesh> shared(mesh.release(), [this, key, base, isLod](Tyra::StaticMesh* mesh) {
+        ReleaseMesh(key, mesh, isLod);
+    });
+    meshes[key] = {shared, shared.get()};
+    return shared;
+}
+
+void AssetCache::LinkTextures(const Tyra::StaticMesh* base, const Tyra::StaticMesh* lod)
+{
+    auto& textureRepository = engine->renderer.getTextureRepository();
+    for (auto* lodMaterial : lod->materials)
+    {
+        for (auto* material : base->materials)
+        {
+            if (material->getName() != lodMaterial->getName()) continue;
+
+            auto* texture = textureRepository.getByMeshMaterialId(material->getId());
+            if (texture)
+            {
+                texture->addLink(lodMaterial->getId());
+            }
+            break;
+        }
+    }
+}
+
+void AssetCache::ReleaseMesh(const std::string& key, Tyra::StaticMesh* mesh, bool isLod)
+{
+    auto& textureRepository = engine->renderer.getTextureRepository();
+    if (isLod)
+    {
+        for (auto* material : mesh->materials)
+        {
+            auto* texture = textureRepository.getByMeshMaterialId(material->getId());
+            if (texture)
+            {
+                texture->removeLinkById(material->getId());
+            }
+        }
+    }
+    else
+    {
+        textureRepository.freeByMesh(mesh);
+    }
+
+    auto it = meshes.find(key);
+    if (it != meshes.end() && it->second.raw == mesh)
+    {
+        meshes.erase(it);
+    }
+
+    TYRA_LOG("AssetCache: released ", key);
+    delete mesh;
+}
+
+std::shared_ptr<Tyra::Texture> AssetCache::GetTexture(const std::string& imagePath)
+{
+    PROFILE_SCOPE("Assets");
+    auto it = textures.find(imagePath);
+    if (it != textures.end())
+    {
+        if (auto texture = it->second.texture.lock())
+        {
+            return texture;
+        }
+    }
+
+    auto* texture = engine->renderer.getTextureRepository().add(Helper::fromCwd(imagePath));
+    std::shared_ptr<Tyra::Texture> shared(texture, [this, imagePath](Tyra::Texture* texture) {
+        ReleaseTexture(imagePath, texture);
+    });
+    textures[imagePath] = {shared, texture};
+    return shared;
+}
+
+void AssetCache::ReleaseTexture(const std::string& key, Tyra::Texture* texture)
+{
+    auto it = textures.find(key);
+    if (it != textures.end() && it->second.raw == texture)
+    {
+        textures.erase(it);
+    }
+    engine->renderer.getTextureRepository().free(texture);
+}
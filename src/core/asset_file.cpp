@@ -0,0 +1,211 @@
+#include "core/asset_file.hpp"
+#include "core/block_codec.hpp"
+
+#include <cstring>
+
+AssetFile::~AssetFile()
+{
+    Close();
+}
+
+bool AssetFile::Open(const std::string& path)
+{
+    Close();
+
+    if (Helper::resolve(path, &range))
+    {
+        archived = true;
+        size = range.size;
+        if (range.compressed && !OpenCompressed())
+        {
+            TYRA_LOG("Archived ", path, " has a broken block table");
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    file = fopen(Helper::fromCwd(path).c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    return true;
+}
+
+void AssetFile::Close()
+{
+    if (file)
+    {
+        fclose(file);
+    }
+    archived = false;
+    file = nullptr;
+    blockTable.clear();
+    blockOffsets.clear();
+    packedBlock.reset();
+    decodedBlock.reset();
+    hasDecodedBlock = false;
+    size = 0;
+    position = 0;
+}
+
+bool AssetFile::Seek(u32 newPosition)
+{
+    if (!IsOpen() || newPosition > size)
+    {
+        return false;
+    }
+    if (file && fseek(file, newPosition, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    position = newPosition;
+    return true;
+}
+
+u32 AssetFile::Read(void* destination, u32 count)
+{
+    if (!IsOpen())
+    {
+        return 0;
+    }
+
+    if (count > size - position)
+    {
+        count = size - position;
+    }
+
+    if (archived && range.compressed)
+    {
+        count = ReadCompressed(static_cast<u8*>(destination), count);
+    }
+    else if (archived)
+    {
+        if (!AssetArchive::GetArchive()->Read(range.offset + position, destination, count))
+        {
+            return 0;
+        }
+    }
+    else
+    {
+        count = fread(destination, 1, count, file);
+    }
+
+    position += count;
+    return count;
+}
+
+bool AssetFile::OpenCompressed()
+{
+    u32 blockCount = BlockCodecBlockCount(size);
+    u32 tableSize = blockCount * sizeof(u32);
+    if (tableSize > range.storedSize)
+    {
+        return false;
+    }
+
+    blockTable.resize(blockCount);
+    if (blockCount && !AssetArchive::GetArchive()->Read(range.offset, blockTable.data(), tableSize))
+    {
+        return false;
+    }
+
+    u32 largest = 0;
+    u32 offset = range.offset + tableSize;
+    blockOffsets.resize(blockCount);
+    for (u32 i = 0; i < blockCount; i++)
+    {
+        u32 stored = BlockCodecStoredSize(blockTable[i]);
+        blockOffsets[i] = offset;
+        offset += stored;
+        if (stored > largest) largest = stored;
+    }
+
+    if (offset != range.offset + range.storedSize)
+    {
+        return false;
+    }
+
+    packedBlock.reset(new u8[largest]);
+    return true;
+}
+
+bool AssetFile::DecodeBlock(u32 index, u8* destination)
+{
+    u32 blockSize = size - index * BLOCK_CODEC_BLOCK_SIZE;
+    if (blockSize > BLOCK_CODEC_BLOCK_SIZE) blockSize = BLOCK_CODEC_BLOCK_SIZE;
+    u32 stored = BlockCodecStoredSize(blockTable[index]);
+    auto* archive = AssetArchive::GetArchive();
+
+    if (blockTable[index] & BLOCK_CODEC_RAW_FLAG)
+    {
+        return stored == blockSize && archive->Read(blockOffsets[index], destination, blockSize);
+    }
+
+    if (!archive->Read(blockOffsets[index], packedBlock.get(), stored))
+    {
+        return false;
+    }
+    return BlockCodecDecode(packedBlock.get(), stored, destination, blockSize) == static_cast<s32>(blockSize);
+}
+
+u32 AssetFile::ReadCompressed(u8* destination, u32 count)
+{
+    u32 done = 0;
+    while (done < count)
+    {
+        u32 current = position + done;
+        u32 index = current / BLOCK_CODEC_BLOCK_SIZE;
+        u32 within = current % BLOCK_CODEC_BLOCK_SIZE;
+        u32 blockSize = size - index * BLOCK_CODEC_BLOCK_SIZE;
+        if (blockSize > BLOCK_CODEC_BLOCK_SIZE) blockSize = BLOCK_CODEC_BLOCK_SIZE;
+        u32 chunk = blockSize - within;
+        if (chunk > count - done) chunk = count - done;
+
+        if (within == 0 && chunk == blockSize)
+        {
+            if (!DecodeBlock(index, destination + done)) break;
+        }
+        else
+        {
+            if (!hasDecodedBlock || decodedBlockIndex != index)
+            {
+                if (!decodedBlock) decodedBlock.reset(new u8[BLOCK_CODEC_BLOCK_SIZE]);
+                hasDecodedBlock = DecodeBlock(index, decodedBlock.get());
+                decodedBlockIndex = index;
+                if (!hasDecodedBlock) break;
+            }
+            memcpy(destination + done, decodedBlock.get() + within, chunk);
+        }
+        done += chunk;
+    }
+
+    if (done < count)
+    {
+        TYRA_LOG("Failed to decode an archived block");
+    }
+    return done;
+}
+
+std::unique_ptr<u8[]> AssetFile::ReadAll(const std::string& path, u32* size)
+{
+    AssetFile file;
+    if (!file.Open(path) || file.GetSize() == 0)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<u8[]> data(new u8[file.GetSize()]);
+    if (file.Read(data.get(), file.GetSize()) != file.GetSize())
+    {
+        TYRA_LOG("Failed to read ", path);
+        return nullptr;
+    }
+
+    *size = file.GetSize();
+    return data;
+}
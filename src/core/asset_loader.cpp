@@ -0,0 +1,195 @@
+#include "core/asset_loader.hpp"
+#include "core/mesh_loader.hpp"
+#include "core/trace.hpp"
+#include "core/helper.hpp"
+
+#include <sstream>
+
+AssetLoader* AssetLoader::assetLoader;
+
+AssetLoader* AssetLoader::GetAssetLoader()
+{
+    return assetLoader;
+}
+
+void AssetLoader::SetAssetLoader(AssetLoader* loader)
+{
+    assetLoader = loader;
+}
+
+AssetLoader::AssetLoader(bool threaded) : threaded(threaded)
+{
+    workerPriority = Helper::getThreadPriority() + 1;
+    if (threaded)
+    {
+        worker = std::thread(&AssetLoader::Run, this);
+    }
+}
+
+AssetLoader::~AssetLoader()
+{
+    if (!threaded)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    requestAdded.notify_all();
+    worker.join();
+}
+
+std::string AssetLoader::MakeKey(const std::string& modelPath, const Tyra::ObjLoaderOptions& options)
+{
+    std::stringstream key;
+    key << modelPath << '|' << options.scale << '|' << options.flipUVs;
+    return key.str();
+}
+
+void AssetLoader::Prefetch(const AssetManifest& manifest, int priority)
+{
+    if (!threaded)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& mesh : manifest.meshes)
+        {
+            auto key = MakeKey(mesh.modelPath, mesh.options);
+            auto it = entries.find(key);
+            if (it != entries.end())
+            {
+                it->second.released = false;
+                // stale requests with the old priority are skipped by the worker
+                if (it->second.state != State::Queued || it->second.priority >= priority) continue;
+                it->second.priority = priority;
+            }
+            else
+            {
+                entries[key] = {State::Queued, priority, false, mesh.modelPath, mesh.options, nullptr};
+            }
+            requests.push({priority, requestCounter++, key});
+        }
+    }
+    requestAdded.notify_one();
+}
+
+bool AssetLoader::IsResident(const AssetManifest& manifest)
+{
+    if (!threaded)
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& mesh : manifest.meshes)
+    {
+        auto it = entries.find(MakeKey(mesh.modelPath, mesh.options));
+        // failed ones will be loaded (or fail loudly) on the main thread
+        if (it == entries.end() || it->second.state == State::Queued || it->second.state == State::Loading)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetLoader::Release(const AssetManifest& manifest)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& mesh : manifest.meshes)
+    {
+        auto it = entries.find(MakeKey(mesh.modelPath, mesh.options));
+        if (it == entries.end()) continue;
+
+        if (it->second.state == State::Loading)
+        {
+            // the worker drops it once it's done
+            it->second.released = true;
+        }
+        else
+        {
+            entries.erase(it);
+        }
+    }
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> AssetLoader::Acquire(const std::string& modelPath, const Tyra::ObjLoaderOptions& options)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto key = MakeKey(modelPath, options);
+    auto it = entries.find(key);
+    if (it == entries.end())
+    {
+        return nullptr;
+    }
+
+    if (it->second.state == State::Queued)
+    {
+        entries.erase(it);
+        return nullptr;
+    }
+
+    requestDone.wait(lock, [&] {
+        it = entries.find(key);
+        return it == entries.end() || it->second.state != State::Loading;
+    });
+
+    if (it == entries.end() || it->second.state != State::Resident)
+    {
+        return nullptr;
+    }
+    return MeshLoader::Clone(it->second.data.get());
+}
+
+void AssetLoader::Run()
+{
+    TRACE_THREAD("Asset loader");
+    Helper::setThreadPriority(workerPriority);
+    while (true)
+    {
+        std::string key;
+        std::string modelPath;
+        Tyra::ObjLoaderOptions options;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            requestAdded.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+
+            auto request = requests.top();
+            requests.pop();
+
+            auto it = entries.find(request.key);
+            if (it == entries.end() || it->second.state != State::Queued || it->second.priority != request.priority)
+            {
+                continue;
+            }
+
+            it->second.state = State::Loading;
+            key = request.key;
+            modelPath = it->second.modelPath;
+            options = it->second.options;
+        }
+
+        auto data = MeshLoader::LoadFromDisk(modelPath, options);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it->second.released)
+            {
+                entries.erase(it);
+            }
+            else
+            {
+                it->second.state = data ? State::Resident : State::Failed;
+                it->second.data = std::move(data);
+            }
+        }
+        requestDone.notify_all();
+    }
+}
@@ -0,0 +1,380 @@
+#include "core/determinism_log.hpp"
+#include <cstring>
+
+namespace {
+
+// Both the EE and the hosts we build on are little endian, so values go in
+// and out with memcpy like the asset formats do
+template <typename T>
+void Put(std::vector<u8>& record, T value)
+{
+    size_t at = record.size();
+    record.resize(at + sizeof(T));
+    memcpy(&record[at], &value, sizeof(T));
+}
+
+struct Reader
+{
+    const u8* at;
+    const u8* end;
+    bool ok = true;
+
+    template <typename T>
+    T Get()
+    {
+        T value = 0;
+        if (end - at < static_cast<long>(sizeof(T)))
+        {
+            ok = false;
+            at = end;
+            return value;
+        }
+        memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    bool Done() const { return at == end; }
+};
+
+struct JointState
+{
+    s32 position[3];
+    s16 velocity[3];
+    u8 sizeDivided;
+};
+
+struct BodyState
+{
+    u32 hash = 0;
+    u8 flags = 0;
+    u8 deactivateCount = 0;
+    s16 jointMass = 0;
+    s16 friction = 0;
+    s16 elasticity = 0;
+    std::vector<JointState> joints;
+};
+
+// What one file has said so far, bodies only get written when they change
+struct RunState
+{
+    Reader reader;
+    u32 segment = 0;
+    u32 step = 0;
+    u32 worldHash = 0;
+    std::vector<BodyState> bodies;
+
+    // Reads the next record, false on the end or a broken file
+    bool Next(u8* tag)
+    {
+        if (reader.Done())
+        {
+            return false;
+        }
+        *tag = reader.Get<u8>();
+        if (*tag == DETERMINISM_TAG_SEGMENT)
+        {
+            segment++;
+            bodies.clear();
+            return true;
+        }
+        if (*tag != DETERMINISM_TAG_STEP)
+        {
+            reader.ok = false;
+            return false;
+        }
+
+        step = reader.Get<u32>();
+        worldHash = reader.Get<u32>();
+        bodies.resize(reader.Get<u16>());
+        u16 changed = reader.Get<u16>();
+        for (u16 i = 0; i < changed && reader.ok; i++)
+        {
+            u16 index = reader.Get<u16>();
+            BodyState body;
+            body.hash = reader.Get<u32>();
+            body.flags = reader.Get<u8>();
+            body.deactivateCount = reader.Get<u8>();
+            body.jointMass = reader.Get<s16>();
+            body.friction = reader.Get<s16>();
+            body.elasticity = reader.Get<s16>();
+            body.joints.resize(reader.Get<u8>());
+            for (auto& joint : body.joints)
+            {
+                for (auto& p : joint.position) p = reader.Get<s32>();
+                for (auto& v : joint.velocity) v = reader.Get<s16>();
+                joint.sizeDivided = reader.Get<u8>();
+            }
+            if (index >= bodies.size())
+            {
+                reader.ok = false;
+                break;
+            }
+            bodies[index] = std::move(body);
+        }
+        return reader.ok;
+    }
+};
+
+bool ReadFile(const std::string& path, std::vector<u8>* data, std::string* report)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        *report += "can't read " + path + "\n";
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    data->resize(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    bool ok = fread(data->data(), 1, data->size(), file) == data->size();
+    fclose(file);
+
+    u32 header[2] = {};
+    if (ok && data->size() >= sizeof(header))
+    {
+        memcpy(header, data->data(), sizeof(header));
+    }
+    if (header[0] != DETERMINISM_FILE_MAGIC)
+    {
+        *report += path + " isn't a determinism log\n";
+        return false;
+    }
+    if (header[1] != DETERMINISM_FILE_VERSION)
+    {
+        *report += path + " is version " + std::to_string(header[1]) + ", expected " + std::to_string(DETERMINISM_FILE_VERSION) + "\n";
+        return false;
+    }
+    return true;
+}
+
+void Field(std::string* report, const std::string& where, const char* name, long a, long b)
+{
+    if (a != b)
+    {
+        *report += "  " + where + name + ": " + std::to_string(a) + " vs " + std::to_string(b) + "\n";
+    }
+}
+
+// Names every field of the first body that differs
+void ReportBodies(const RunState& a, const RunState& b, std::string* report)
+{
+    if (a.bodies.size() != b.bodies.size())
+    {
+        *report += "  body count: " + std::to_string(a.bodies.size()) + " vs " + std::to_string(b.bodies.size()) + "\n";
+        return;
+    }
+
+    for (size_t i = 0; i < a.bodies.size(); i++)
+    {
+        const BodyState& bodyA = a.bodies[i];
+        const BodyState& bodyB = b.bodies[i];
+        if (bodyA.hash == bodyB.hash)
+        {
+            continue;
+        }
+
+        std::string where = "body " + std::to_string(i) + " ";
+        size_t before = report->size();
+        Field(report, where, "flags", bodyA.flags, bodyB.flags);
+        Field(report, where, "deactivateCount", bodyA.deactivateCount, bodyB.deactivateCount);
+        Field(report, where, "jointMass", bodyA.jointMass, bodyB.jointMass);
+        Field(report, where, "friction", bodyA.friction, bodyB.friction);
+        Field(report, where, "elasticity", bodyA.elasticity, bodyB.elasticity);
+        Field(report, where, "jointCount", bodyA.joints.size(), bodyB.joints.size());
+        for (size_t j = 0; j < bodyA.joints.size() && j < bodyB.joints.size(); j++)
+        {
+            const JointState& jointA = bodyA.joints[j];
+            const JointState& jointB = bodyB.joints[j];
+            std::string joint = where + "joint " + std::to_string(j) + " ";
+            Field(report, joint, "position.x", jointA.position[0], jointB.position[0]);
+            Field(report, joint, "position.y", jointA.position[1], jointB.position[1]);
+            Field(report, joint, "position.z", jointA.position[2], jointB.position[2]);
+            Field(report, joint, "velocity.x", jointA.velocity[0], jointB.velocity[0]);
+            Field(report, joint, "velocity.y", jointA.velocity[1], jointB.velocity[1]);
+            Field(report, joint, "velocity.z", jointA.velocity[2], jointB.velocity[2]);
+            Field(report, joint, "sizeDivided", jointA.sizeDivided, jointB.sizeDivided);
+        }
+        if (report->size() == before)
+        {
+            *report += "  " + where + "hashes differ but the logged fields match, its connections then\n";
+        }
+        return;
+    }
+    *report += "  every body hash matches, the bodies are in a different order\n";
+}
+
+}
+
+DeterminismLog* DeterminismLog::log;
+
+DeterminismLog* DeterminismLog::GetLog()
+{
+    return log;
+}
+
+void DeterminismLog::SetLog(DeterminismLog* log_)
+{
+    log = log_;
+}
+
+std::unique_ptr<DeterminismLog> DeterminismLog::Create(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        TYRA_LOG("DeterminismLog: can't write ", path);
+        return nullptr;
+    }
+    u32 header[2] = {DETERMINISM_FILE_MAGIC, DETERMINISM_FILE_VERSION};
+    fwrite(header, sizeof(header), 1, file);
+    return std::unique_ptr<DeterminismLog>(new DeterminismLog(file));
+}
+
+DeterminismLog::DeterminismLog(FILE* file) : file(file)
+{
+    record.reserve(4096);
+}
+
+DeterminismLog::~DeterminismLog()
+{
+    if (log == this)
+    {
+        log = nullptr;
+    }
+    fclose(file);
+}
+
+void DeterminismLog::StartSegment()
+{
+    u8 tag = DETERMINISM_TAG_SEGMENT;
+    fwrite(&tag, 1, 1, file);
+    step = 0;
+    bodies = nullptr;
+}
+
+u32 DeterminismLog::Record(const TPE_World* world)
+{
+    // a new body array or count means a new scene, hash it all again
+    bool everything = world->bodies != bodies || world->bodyCount != bodyHashes.size();
+    if (everything)
+    {
+        bodies = world->bodies;
+        bodyHashes.assign(world->bodyCount, 0);
+        bodyAsleep.assign(world->bodyCount, false);
+    }
+
+    record.clear();
+    Put<u8>(record, DETERMINISM_TAG_STEP);
+    Put<u32>(record, step);
+    size_t worldHashAt = record.size();
+    Put<u32>(record, 0);
+    Put<u16>(record, world->bodyCount);
+    size_t changedAt = record.size();
+    Put<u16>(record, 0);
+
+    u32 worldHash = 0;
+    u16 changed = 0;
+    for (u16 i = 0; i < world->bodyCount; i++)
+    {
+        const TPE_Body* body = &world->bodies[i];
+        bool asleep = (body->flags & TPE_BODY_FLAG_DEACTIVATED) != 0;
+        // asleep now and at the last record, the step didn't touch it
+        if (everything || !asleep || !bodyAsleep[i])
+        {
+            u32 hash = TPE_bodyHash(body);
+            if (everything || hash != bodyHashes[i])
+            {
+                bodyHashes[i] = hash;
+                WriteBody(i, body, hash);
+                changed++;
+            }
+        }
+        bodyAsleep[i] = asleep;
+        worldHash = TPE_worldHashAdd(worldHash, bodyHashes[i]);
+    }
+
+    memcpy(&record[worldHashAt], &worldHash, sizeof(worldHash));
+    memcpy(&record[changedAt], &changed, sizeof(changed));
+    fwrite(record.data(), 1, record.size(), file);
+    step++;
+    return worldHash;
+}
+
+void DeterminismLog::WriteBody(u16 index, const TPE_Body* body, u32 hash)
+{
+    Put<u16>(record, index);
+    Put<u32>(record, hash);
+    Put<u8>(record, body->flags);
+    Put<u8>(record, body->deactivateCount);
+    Put<s16>(record, body->jointMass);
+    Put<s16>(record, body->friction);
+    Put<s16>(record, body->elasticity);
+    Put<u8>(record, body->jointCount);
+    for (u8 j = 0; j < body->jointCount; j++)
+    {
+        const TPE_Joint& joint = body->joints[j];
+        Put<s32>(record, joint.position.x);
+        Put<s32>(record, joint.position.y);
+        Put<s32>(record, joint.position.z);
+        Put<s16>(record, joint.velocity[0]);
+        Put<s16>(record, joint.velocity[1]);
+        Put<s16>(record, joint.velocity[2]);
+        Put<u8>(record, joint.sizeDivided);
+    }
+}
+
+DeterminismLog::CompareResult DeterminismLog::Compare(const std::string& pathA, const std::string& pathB, std::string* report)
+{
+    std::vector<u8> dataA, dataB;
+    if (!ReadFile(pathA, &dataA, report) || !ReadFile(pathB, &dataB, report))
+    {
+        return CompareResult::Unreadable;
+    }
+
+    const u32 headerSize = 2 * sizeof(u32);
+    RunState a{{dataA.data() + headerSize, dataA.data() + dataA.size()}};
+    RunState b{{dataB.data() + headerSize, dataB.data() + dataB.size()}};
+    u32 steps = 0;
+    while (true)
+    {
+        u8 tagA = 0, tagB = 0;
+        bool moreA = a.Next(&tagA);
+        bool moreB = b.Next(&tagB);
+        if (!a.reader.ok || !b.reader.ok)
+        {
+            *report += (a.reader.ok ? pathB : pathA) + " is broken after " + std::to_string(steps) + " matching steps\n";
+            return CompareResult::Unreadable;
+        }
+        if (!moreA || !moreB)
+        {
+            if (moreA == moreB)
+            {
+                *report += std::to_string(steps) + " steps in " + std::to_string(a.segment) + " segments, all the same\n";
+                return CompareResult::Same;
+            }
+            *report += "both match for " + std::to_string(steps) + " steps, then " + (moreA ? pathB : pathA) + " ends\n";
+            return CompareResult::Diverged;
+        }
+
+        std::string where = "segment " + std::to_string(a.segment) + " step " + std::to_string(a.step);
+        if (tagA != tagB)
+        {
+            *report += (tagA == DETERMINISM_TAG_SEGMENT ? pathA : pathB) + " starts a new segment where the other is at " + where + "\n";
+            return CompareResult::Diverged;
+        }
+        if (tagA == DETERMINISM_TAG_SEGMENT)
+        {
+            continue;
+        }
+        if (a.worldHash != b.worldHash || a.bodies.size() != b.bodies.size())
+        {
+            char hashes[64];
+            snprintf(hashes, sizeof(hashes), ": world hash %08x vs %08x\n", a.worldHash, b.worldHash);
+            *report += "first divergence at " + where + hashes;
+            ReportBodies(a, b, report);
+            return CompareResult::Diverged;
+        }
+        steps++;
+    }
+}
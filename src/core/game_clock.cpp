@@ -0,0 +1,34 @@
+#include "core/game_clock.hpp"
+
+GameClock* GameClock::clock;
+
+GameClock* GameClock::GetClock()
+{
+    return clock;
+}
+
+void GameClock::SetClock(GameClock* clock_)
+{
+    clock = clock_;
+}
+
+GameClock::GameClock() : lastTicks(GetTicks()) {}
+
+void GameClock::Tick()
+{
+    u32 ticks = GetTicks();
+    float real = fixedDelta > 0.0F ? fixedDelta : TicksToSeconds(ticks - lastTicks);
+    lastTicks = ticks;
+
+    delta = real < GAME_CLOCK_MAX_DELTA ? real : GAME_CLOCK_MAX_DELTA;
+    seconds += real;
+    gameSeconds += delta * scale;
+    frame++;
+
+    // the fps shows what really happened, hitches too
+    if (smoothedDelta == 0.0F)
+    {
+        smoothedDelta = real;
+    }
+    smoothedDelta += (real - smoothedDelta) * GAME_CLOCK_FPS_SMOOTHING;
+}
@@ -1,4 +1,5 @@
 #include "core/game_object.hpp"
+#include "core/profiler.hpp"
 
 GameObject::GameObject(const std::string& objectName, const Tyra::Vec4& worldPosition, const Tyra::Vec4 worldRotation, Tyra::Engine* engine)
 {
@@ -35,7 +36,7 @@ void GameObject::GetObjectName(const std::string& newObjectName)
 {
     objectName = newObjectName;
 }
-std::string GameObject::GetObjectName()
+const std::string& GameObject::GetObjectName()
 {
     return objectName;
 }
@@ -204,6 +205,7 @@ void GameObject::SetWorldRotation(const Tyra::Vec4& rotation)
 
 void GameObject::_update()
 {
+    PROFILE_SCOPE("Update");
     Update();
     for (const auto& component : components) {
         component->Update();
@@ -216,6 +218,7 @@ void GameObject::_update()
 
 void GameObject::_render()
 {
+    PROFILE_SCOPE("Render");
     Render();
     for (const auto& component : components) {
         component->Render();
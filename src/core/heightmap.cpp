@@ -9,46 +9,173 @@
 */
 
 #include "core/heightmap.hpp"
+#include "core/asset_file.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 
-using Tyra::FileUtils;
-using Tyra::PngLoader;
-using Tyra::PngPixel3;
 using Tyra::Vec4;
 
-Heightmap::Heightmap(const float& t_minHeight, const float& t_maxHeight,
-                     const Vec4& t_leftUp, const Vec4& t_rightDown)
-    : minHeight(t_minHeight),
-      maxHeight(t_maxHeight),
+Heightmap::Heightmap(const std::string& path, const Vec4& t_leftUp,
+                     const Vec4& t_rightDown)
+    : mapWidth(0),
+      mapHeight(0),
+      minHeight(0.0F),
+      maxHeight(0.0F),
       leftUp(t_leftUp),
-      rightDown(t_rightDown) {
-  std::ifstream heightmapFile;
-  // testing
-
-  heightmapFile.open(Helper::fromCwd("level01/heightmap.csv"));
-  TYRA_ASSERT(heightmapFile.is_open(), "Failed to open the heightmap");
-
-  std::string line, val;
-  while (std::getline(heightmapFile, line)) {
-    std::vector<float> v;
-    std::stringstream s(line);
-    while (getline(s, val, ';')) {
-      v.push_back(std::stof(val));
+      rightDown(t_rightDown),
+      data(nullptr),
+      heightScale(0.0F),
+      gridScaleX(0.0F),
+      gridScaleZ(0.0F),
+      gridOffsetX(0.0F),
+      gridOffsetZ(0.0F),
+      gridMaxX(0.0F),
+      gridMaxZ(0.0F),
+      cellSizeX(0.0F),
+      cellSizeZ(0.0F) {
+  u32 size;
+  blob = AssetFile::ReadAll(path, &size);
+  if (!blob) {
+    TYRA_WARN("Heightmap ", path, " is missing");
+    return;
+  }
+
+  const auto* header = reinterpret_cast<const HeightmapFileHeader*>(blob.get());
+  if (size < sizeof(HeightmapFileHeader) ||
+      header->magic != HEIGHTMAP_FILE_MAGIC ||
+      header->version != HEIGHTMAP_FILE_VERSION || header->width < 2 ||
+      header->height < 2 || header->width > 0x7FFF ||
+      header->height > 0x7FFF || header->totalSize != size ||
+      HeightmapFileSize(header->width, header->height) != size) {
+    TYRA_WARN("Heightmap ", path, " is malformed");
+    blob.reset();
+    return;
+  }
+
+  mapWidth = header->width;
+  mapHeight = header->height;
+  minHeight = header->minHeight;
+  maxHeight = header->maxHeight;
+  heightScale = (maxHeight - minHeight) / HEIGHTMAP_FILE_MAX_VALUE;
+  data = reinterpret_cast<const u16*>(blob.get() + sizeof(HeightmapFileHeader));
+
+  // sample i sits at leftUp + (i + 0.5) cells
+  gridScaleX = mapWidth / (rightDown.x - leftUp.x);
+  gridScaleZ = mapHeight / (rightDown.z - leftUp.z);
+  gridOffsetX = -leftUp.x * gridScaleX - 0.5F;
+  gridOffsetZ = -leftUp.z * gridScaleZ - 0.5F;
+  gridMaxX = static_cast<float>(mapWidth - 1);
+  gridMaxZ = static_cast<float>(mapHeight - 1);
+  cellSizeX = 1.0F / gridScaleX;
+  cellSizeZ = 1.0F / gridScaleZ;
+
+  buildNormals();
+  buildPyramid();
+}
+
+Heightmap::~Heightmap() {
+
+}
+
+void Heightmap::buildNormals() {
+  const int cellsX = mapWidth - 1;
+  const int cellsZ = mapHeight - 1;
+  normals.reset(new PackedNormal[cellsX * cellsZ]);
+
+  // quantized steps -> slope in world units
+  const float slopeX = heightScale * gridScaleX * 0.5F;
+  const float slopeZ = heightScale * gridScaleZ * 0.5F;
+
+  for (int z = 0; z < cellsZ; z++) {
+    const u16* row = data + z * mapWidth;
+    const u16* next = row + mapWidth;
+    for (int x = 0; x < cellsX; x++) {
+      // average of the slopes along both edges of the cell
+      float dx = ((row[x + 1] - row[x]) + (next[x + 1] - next[x])) * slopeX;
+      float dz = ((next[x] - row[x]) + (next[x + 1] - row[x + 1])) * slopeZ;
+      float invLength = 1.0F / std::sqrt(dx * dx + 1.0F + dz * dz);
+
+      auto& normal = normals[z * cellsX + x];
+      normal.x = static_cast<s8>(std::lround(-dx * invLength * 127.0F));
+      normal.y = static_cast<s8>(std::lround(invLength * 127.0F));
+      normal.z = static_cast<s8>(std::lround(-dz * invLength * 127.0F));
+      normal.pad = 0;
     }
-    heightmapData.push_back(v);
   }
+}
 
-  heightmapFile.close();
+void Heightmap::buildPyramid() {
+  PyramidLevel cells;
+  cells.width = mapWidth - 1;
+  cells.height = mapHeight - 1;
+  cells.bounds.reset(new Bounds[cells.width * cells.height]);
+  for (int z = 0; z < cells.height; z++) {
+    const u16* row = data + z * mapWidth;
+    const u16* next = row + mapWidth;
+    for (int x = 0; x < cells.width; x++) {
+      auto& bounds = cells.bounds[z * cells.width + x];
+      bounds.min = std::min(std::min(row[x], row[x + 1]),
+                            std::min(next[x], next[x + 1]));
+      bounds.max = std::max(std::max(row[x], row[x + 1]),
+                            std::max(next[x], next[x + 1]));
+    }
+  }
+  pyramid.push_back(std::move(cells));
 
-  mapWidth = heightmapData[0].size();
-  mapHeight = heightmapData.size();
+  while (pyramid.back().width > 1 || pyramid.back().height > 1) {
+    const auto& below = pyramid.back();
+    PyramidLevel level;
+    level.width = (below.width + 1) / 2;
+    level.height = (below.height + 1) / 2;
+    level.bounds.reset(new Bounds[level.width * level.height]);
 
-  PngLoader loader;
-  auto* data = loader.load(Helper::fromCwd("level01/heightmap.png"));
-  // allocateMap(data->data, data->width, data->height);
+    for (int z = 0; z < level.height; z++) {
+      for (int x = 0; x < level.width; x++) {
+        // odd sizes leave the last row / column with fewer children
+        int x1 = std::min(x * 2 + 1, below.width - 1);
+        int z1 = std::min(z * 2 + 1, below.height - 1);
+        Bounds merged = below.bounds[z * 2 * below.width + x * 2];
+        for (int cz = z * 2; cz <= z1; cz++) {
+          for (int cx = x * 2; cx <= x1; cx++) {
+            const auto& child = below.bounds[cz * below.width + cx];
+            merged.min = std::min(merged.min, child.min);
+            merged.max = std::max(merged.max, child.max);
+          }
+        }
+        level.bounds[z * level.width + x] = merged;
+      }
+    }
+    pyramid.push_back(std::move(level));
+  }
+}
 
-  delete data;
+void Heightmap::getCellRange(float minX, float minZ, float maxX, float maxZ,
+                             int* x0, int* z0, int* x1, int* z1) const {
+  auto toCell = [](float g, float gridMax, int lastCell) {
+    return std::min(static_cast<int>(std::min(std::max(g, 0.0F), gridMax)),
+                    lastCell);
+  };
+  *x0 = toCell(minX * gridScaleX + gridOffsetX, gridMaxX, mapWidth - 2);
+  *x1 = toCell(maxX * gridScaleX + gridOffsetX, gridMaxX, mapWidth - 2);
+  *z0 = toCell(minZ * gridScaleZ + gridOffsetZ, gridMaxZ, mapHeight - 2);
+  *z1 = toCell(maxZ * gridScaleZ + gridOffsetZ, gridMaxZ, mapHeight - 2);
+}
+
+int Heightmap::getCoverLevel(int x0, int z0, int x1, int z1) const {
+  int level = 0;
+  while ((x1 >> level) - (x0 >> level) > 1 ||
+         (z1 >> level) - (z0 >> level) > 1) {
+    level++;
+  }
+  return std::min(level, static_cast<int>(pyramid.size()) - 1);
+}
+
+const Heightmap::Bounds& Heightmap::getBounds(int level, int x,
+                                              int z) const {
+  level = std::min(level, static_cast<int>(pyramid.size()) - 1);
+  const auto& nodes = pyramid[level];
+  return nodes.bounds[(z >> level) * nodes.width + (x >> level)];
 }
 
 bool Heightmap::isOutside(const Vec4& position) const {
@@ -56,31 +183,433 @@ bool Heightmap::isOutside(const Vec4& position) const {
          position.z <= leftUp.z || position.z >= rightDown.z;
 }
 
-Heightmap::~Heightmap() {
+void Heightmap::getCell(const Vec4& position, int* cellX, int* cellZ,
+                        float* fracX, float* fracZ) const {
+  float gx = std::min(std::max(position.x * gridScaleX + gridOffsetX, 0.0F),
+                      gridMaxX);
+  float gz = std::min(std::max(position.z * gridScaleZ + gridOffsetZ, 0.0F),
+                      gridMaxZ);
+
+  // clamped to >= 0, so the cast floors. The last sample belongs to the
+  // last cell, at fraction 1
+  *cellX = std::min(static_cast<int>(gx), mapWidth - 2);
+  *cellZ = std::min(static_cast<int>(gz), mapHeight - 2);
+  *fracX = gx - *cellX;
+  *fracZ = gz - *cellZ;
+}
+
+Vec4 closestPointOnTriangle(const Vec4& p, const Vec4& a, const Vec4& b,
+                            const Vec4& c) {
+  Vec4 ab = b - a, ac = c - a, ap = p - a;
+  float d1 = ab.dot3(ap), d2 = ac.dot3(ap);
+  if (d1 <= 0.0F && d2 <= 0.0F) return a;
+
+  Vec4 bp = p - b;
+  float d3 = ab.dot3(bp), d4 = ac.dot3(bp);
+  if (d3 >= 0.0F && d4 <= d3) return b;
+
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0F && d1 >= 0.0F && d3 <= 0.0F) return a + ab * (d1 / (d1 - d3));
+
+  Vec4 cp = p - c;
+  float d5 = ab.dot3(cp), d6 = ac.dot3(cp);
+  if (d6 >= 0.0F && d5 <= d6) return c;
+
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0F && d2 >= 0.0F && d6 <= 0.0F) return a + ac * (d2 / (d2 - d6));
+
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.0F && d4 - d3 >= 0.0F && d5 - d6 >= 0.0F)
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+  float denominator = 1.0F / (va + vb + vc);
+  return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+Vec4 Heightmap::closestPoint(const Vec4& position, float maxDistance) const {
+  float surface = sampleTriangle(position);
+  if (position.y <= surface) return position;
+
+  if (!data || isOutside(position)) {
+    return Vec4(position.x, surface, position.z);
+  }
+
+  // nothing on the surface is further than straight down, and nothing can be
+  // closer than the highest point around
+  float gap = position.y - surface;
+  float radius = std::min(gap, maxDistance);
+
+  int x0, z0, x1, z1;
+  getCellRange(position.x - radius, position.z - radius, position.x + radius,
+               position.z + radius, &x0, &z0, &x1, &z1);
+
+  // the highest point in reach
+  int level = getCoverLevel(x0, z0, x1, z1);
+  u16 top = std::max(
+      std::max(getBounds(level, x0, z0).max, getBounds(level, x1, z0).max),
+      std::max(getBounds(level, x0, z1).max, getBounds(level, x1, z1).max));
+  float above = position.y - (minHeight + top * heightScale);
+  if (above > maxDistance) {
+    return Vec4(position.x, position.y - above, position.z);
+  }
+
+  // wheels are a lot smaller than a cell, so this is a couple of cells at
+  // most. Big queries only look at the cells right around position
+  const int reach = 2;
+  int cellX, cellZ;
+  float fracX, fracZ;
+  getCell(position, &cellX, &cellZ, &fracX, &fracZ);
+  x0 = std::max(x0, cellX - reach);
+  x1 = std::min(x1, cellX + reach);
+  z0 = std::max(z0, cellZ - reach);
+  z1 = std::min(z1, cellZ + reach);
+
+  // straight down is the answer unless a cell has something closer. The cell
+  // under position goes first, it's usually the one and then most of the
+  // others get skipped
+  Vec4 best(position.x, surface, position.z);
+  float bestDistance = radius * radius;
+  closestInCell(position, cellX, cellZ, &best, &bestDistance);
+  for (int z = z0; z <= z1; z++) {
+    for (int x = x0; x <= x1; x++) {
+      if (x != cellX || z != cellZ) {
+        closestInCell(position, x, z, &best, &bestDistance);
+      }
+    }
+  }
+  return best;
+}
+
+void Heightmap::closestInCell(const Vec4& position, int x, int z, Vec4* best,
+                              float* bestDistance) const {
+  const u16* h = data + z * mapWidth + x;
+  float worldX = leftUp.x + (x + 0.5F) * cellSizeX;
+  float worldZ = leftUp.z + (z + 0.5F) * cellSizeZ;
+
+  // nothing in the cell can be closer than its box
+  float outX = std::max(
+      std::max(worldX - position.x, position.x - worldX - cellSizeX), 0.0F);
+  float outZ = std::max(
+      std::max(worldZ - position.z, position.z - worldZ - cellSizeZ), 0.0F);
+  u16 top = std::max(std::max(h[0], h[1]),
+                     std::max(h[mapWidth], h[mapWidth + 1]));
+  float outY = std::max(position.y - (minHeight + top * heightScale), 0.0F);
+  if (outX * outX + outY * outY + outZ * outZ >= *bestDistance) return;
+
+  Vec4 v00(worldX, minHeight + h[0] * heightScale, worldZ);
+  Vec4 v10(worldX + cellSizeX, minHeight + h[1] * heightScale, worldZ);
+  Vec4 v01(worldX, minHeight + h[mapWidth] * heightScale, worldZ + cellSizeZ);
+  Vec4 v11(worldX + cellSizeX, minHeight + h[mapWidth + 1] * heightScale,
+           worldZ + cellSizeZ);
+
+  // same split as sampleTriangle
+  Vec4 candidates[2] = {closestPointOnTriangle(position, v00, v10, v11),
+                        closestPointOnTriangle(position, v00, v11, v01)};
+  for (const auto& candidate : candidates) {
+    Vec4 offset = position - candidate;
+    float distance = offset.dot3(offset);
+    if (distance < *bestDistance) {
+      *bestDistance = distance;
+      *best = candidate;
+    }
+  }
+}
+
+TPE_Vec3 Heightmap::environmentDistance(TPE_Vec3 position,
+                                        TPE_Unit maxDistance) const {
+  // dividing by a power of two and multiplying back is exact, so a position
+  // under the surface comes back untouched like TPE wants it
+  const float toWorld = 1.0F / TPE_F;
+  Vec4 closest = closestPoint(
+      Vec4(position.x * toWorld, position.y * toWorld, position.z * toWorld),
+      maxDistance * toWorld);
+  return TPE_vec3(std::lround(closest.x * TPE_F),
+                  std::lround(closest.y * TPE_F),
+                  std::lround(closest.z * TPE_F));
+}
+
+bool Heightmap::raycast(const Vec4& origin, const Vec4& direction,
+                        float maxDistance, HeightmapHit* hit) const {
+  return cast(origin, direction, maxDistance, 0.0F, hit);
+}
+
+bool Heightmap::segmentCast(const Vec4& from, const Vec4& to,
+                            HeightmapHit* hit) const {
+  return sphereCast(from, to, 0.0F, hit);
+}
+
+bool Heightmap::sphereCast(const Vec4& from, const Vec4& to, float radius,
+                           HeightmapHit* hit) const {
+  Vec4 delta = to - from;
+  float length = delta.length();
+  if (length <= 0.0F) return false;
+  return cast(from, delta * (1.0F / length), length, radius, hit);
+}
+
+namespace {
+
+/** Ray against triangle abc (Moller-Trumbore), both sides count. */
+bool castTriangle(const Vec4& origin, const Vec4& direction, const Vec4& a,
+                  const Vec4& b, const Vec4& c, float* distance) {
+  Vec4 ab = b - a, ac = c - a;
+  Vec4 p = direction.cross(ac);
+  float determinant = ab.dot3(p);
+  if (std::fabs(determinant) < 1e-8F) return false;
+
+  float inverse = 1.0F / determinant;
+  Vec4 toOrigin = origin - a;
+  float u = toOrigin.dot3(p) * inverse;
+  if (u < 0.0F || u > 1.0F) return false;
+
+  Vec4 q = toOrigin.cross(ab);
+  float v = direction.dot3(q) * inverse;
+  if (v < 0.0F || u + v > 1.0F) return false;
 
+  *distance = ac.dot3(q) * inverse;
+  return true;
 }
 
-float Heightmap::getHeightOffset(const Vec4& playerPosition) const {
-  float widthPercentage = getWidthPercentage(playerPosition);
-  float heightPercentage = getHeightPercentage(playerPosition);
-  auto x = static_cast<int>(widthPercentage * mapWidth);
-  auto y = static_cast<int>(heightPercentage * mapHeight);
+}  // namespace
+
+bool castCell(const Vec4& origin, const Vec4& direction, const Vec4& v00,
+              const Vec4& v10, const Vec4& v01, const Vec4& v11, float radius,
+              float* best, Vec4* normal) {
+  bool found = false;
+  // same split as sampleTriangle, wound so the normals point up
+  const Vec4* triangles[2][3] = {{&v00, &v11, &v10}, {&v00, &v01, &v11}};
+  for (const auto& triangle : triangles) {
+    const Vec4& a = *triangle[0];
+    const Vec4& b = *triangle[1];
+    const Vec4& c = *triangle[2];
+    Vec4 faceNormal = (b - a).cross(c - a);
+    faceNormal.normalize();
+
+    // for a sphere, the faces pushed out along their normals leave gaps
+    // over ridges. The surface lifted straight up by radius has none and
+    // is exactly radius over the ridge, so it fills them in
+    Vec4 offsets[2] = {faceNormal * radius, Vec4(0.0F, radius, 0.0F, 0.0F)};
+    for (int i = 0; i < (radius > 0.0F ? 2 : 1); i++) {
+      float distance;
+      if (castTriangle(origin, direction, a + offsets[i], b + offsets[i],
+                       c + offsets[i], &distance) &&
+          distance >= 0.0F && distance <= *best) {
+        *best = distance;
+        *normal = faceNormal;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+bool Heightmap::cast(const Vec4& origin, const Vec4& direction,
+                     float maxDistance, float radius,
+                     HeightmapHit* hit) const {
+  if (hit) hit->nodesVisited = 0;
+  if (!data) return false;
+
+  // no infinities on the EE, a huge number slabs just as well
+  const float huge = 1e30F;
+  float inverseX = direction.x != 0.0F ? 1.0F / direction.x : huge;
+  float inverseY = direction.y != 0.0F ? 1.0F / direction.y : huge;
+  float inverseZ = direction.z != 0.0F ? 1.0F / direction.z : huge;
+
+  float best = maxDistance;
+  bool found = false;
+  Vec4 bestNormal;
+
+  // a bit over radius sideways, or a ray right on a cell edge can round its
+  // way out of the boxes on both sides
+  const float reach = radius + 1e-3F * std::min(cellSizeX, cellSizeZ);
+
+  // where the ray enters the box of a node, false if it misses it or only
+  // gets there after the best hit so far
+  auto enter = [&](int level, int x, int z, float* entry) {
+    const int cellsX = mapWidth - 1, cellsZ = mapHeight - 1;
+    const auto& bounds = pyramid[level].bounds[z * pyramid[level].width + x];
+    float boxMinX = leftUp.x + ((x << level) + 0.5F) * cellSizeX - reach;
+    float boxMaxX = leftUp.x +
+                    (std::min((x + 1) << level, cellsX) + 0.5F) * cellSizeX +
+                    reach;
+    float boxMinZ = leftUp.z + ((z << level) + 0.5F) * cellSizeZ - reach;
+    float boxMaxZ = leftUp.z +
+                    (std::min((z + 1) << level, cellsZ) + 0.5F) * cellSizeZ +
+                    reach;
+    float boxMinY = minHeight + bounds.min * heightScale - radius;
+    float boxMaxY = minHeight + bounds.max * heightScale + radius;
+
+    float nearX = (boxMinX - origin.x) * inverseX;
+    float farX = (boxMaxX - origin.x) * inverseX;
+    float nearY = (boxMinY - origin.y) * inverseY;
+    float farY = (boxMaxY - origin.y) * inverseY;
+    float nearZ = (boxMinZ - origin.z) * inverseZ;
+    float farZ = (boxMaxZ - origin.z) * inverseZ;
+    float in = std::max(std::max(std::min(nearX, farX), std::min(nearY, farY)),
+                        std::min(nearZ, farZ));
+    float out = std::min(std::min(std::max(nearX, farX), std::max(nearY, farY)),
+                         std::max(nearZ, farZ));
+    *entry = std::max(in, 0.0F);
+    return in <= out && out >= 0.0F && *entry <= best;
+  };
+
+  struct Node {
+    int level, x, z;
+    float entry;
+  };
+  // every level pushes at most 4 children and pops one of them
+  Node stack[4 * 16];
+  int size = 0;
+
+  // start from the first level that covers the whole cast with at most 2x2
+  // nodes, short casts don't have to walk down from the top
+  Vec4 end = origin + direction * maxDistance;
+  int x0, z0, x1, z1;
+  getCellRange(std::min(origin.x, end.x) - reach,
+               std::min(origin.z, end.z) - reach,
+               std::max(origin.x, end.x) + reach,
+               std::max(origin.z, end.z) + reach, &x0, &z0, &x1, &z1);
+  int level = getCoverLevel(x0, z0, x1, z1);
+  for (int z = z0 >> level; z <= z1 >> level; z++) {
+    for (int x = x0 >> level; x <= x1 >> level; x++) {
+      Node start = {level, x, z, 0.0F};
+      if (enter(level, x, z, &start.entry)) stack[size++] = start;
+    }
+  }
+
+  while (size > 0) {
+    Node node = stack[--size];
+    if (node.entry > best) continue;
+    if (hit) hit->nodesVisited++;
+
+    if (node.level == 0) {
+      const u16* h = data + node.z * mapWidth + node.x;
+      // corners worked out the same way from every cell sharing them, or a
+      // ray right on the edge between two cells can slip through the gap
+      float worldX = leftUp.x + (node.x + 0.5F) * cellSizeX;
+      float worldZ = leftUp.z + (node.z + 0.5F) * cellSizeZ;
+      float nextX = leftUp.x + (node.x + 1.5F) * cellSizeX;
+      float nextZ = leftUp.z + (node.z + 1.5F) * cellSizeZ;
+      Vec4 v00(worldX, minHeight + h[0] * heightScale, worldZ);
+      Vec4 v10(nextX, minHeight + h[1] * heightScale, worldZ);
+      Vec4 v01(worldX, minHeight + h[mapWidth] * heightScale, nextZ);
+      Vec4 v11(nextX, minHeight + h[mapWidth + 1] * heightScale, nextZ);
+
+      if (castCell(origin, direction, v00, v10, v01, v11, radius, &best,
+                   &bestNormal)) {
+        found = true;
+      }
+      continue;
+    }
+
+    // nearest child goes on the stack last, so it's looked at first and a hit
+    // in it culls the rest
+    Node children[4];
+    int count = 0;
+    const auto& below = pyramid[node.level - 1];
+    for (int z = node.z * 2; z <= std::min(node.z * 2 + 1, below.height - 1);
+         z++) {
+      for (int x = node.x * 2; x <= std::min(node.x * 2 + 1, below.width - 1);
+           x++) {
+        Node child = {node.level - 1, x, z, 0.0F};
+        if (enter(child.level, x, z, &child.entry)) {
+          int i = count++;
+          for (; i > 0 && children[i - 1].entry < child.entry; i--) {
+            children[i] = children[i - 1];
+          }
+          children[i] = child;
+        }
+      }
+    }
+    for (int i = 0; i < count; i++) stack[size++] = children[i];
+  }
 
-  if (!(x >= 0 && x < mapWidth) || !(y >= 0 && y < mapHeight)) {
-    TYRA_LOG("RIP");
-    return heightmapData[0][0];
+  if (found && hit) {
+    hit->distance = best;
+    hit->point = origin + direction * best;
+    hit->normal = bestNormal;
   }
+  return found;
+}
+
+float Heightmap::getHeightOffset(const Vec4& position) const {
+  if (!data) return 0.0F;
 
-  TYRA_ASSERT(x >= 0 && x < mapWidth, "x is out of range");
-  TYRA_ASSERT(y >= 0 && y < mapHeight, "y is out of range");
+  float gx = std::min(std::max(position.x * gridScaleX + gridOffsetX, 0.0F),
+                      gridMaxX);
+  float gz = std::min(std::max(position.z * gridScaleZ + gridOffsetZ, 0.0F),
+                      gridMaxZ);
+  auto x = static_cast<int>(gx + 0.5F);
+  auto y = static_cast<int>(gz + 0.5F);
 
-  return heightmapData[y][x];
+  return minHeight + data[y * mapWidth + x] * heightScale;
 }
 
-float Heightmap::getWidthPercentage(const Vec4& playerPosition) const {
-  return (playerPosition.x - leftUp.x) / (rightDown.x - leftUp.x);
+float Heightmap::sampleBilinear(const Vec4& position) const {
+  if (!data) return 0.0F;
+
+  int x, z;
+  float fx, fz;
+  getCell(position, &x, &z, &fx, &fz);
+
+  const u16* h = data + z * mapWidth + x;
+  float top = h[0] + (h[1] - h[0]) * fx;
+  float bottom = h[mapWidth] + (h[mapWidth + 1] - h[mapWidth]) * fx;
+  return minHeight + (top + (bottom - top) * fz) * heightScale;
 }
 
-float Heightmap::getHeightPercentage(const Vec4& playerPosition) const {
-  return (playerPosition.z - leftUp.z) / (rightDown.z - leftUp.z);
-}
\ No newline at end of file
+float Heightmap::sampleTriangle(const Vec4& position) const {
+  if (!data) return 0.0F;
+
+  int x, z;
+  float fx, fz;
+  getCell(position, &x, &z, &fx, &fz);
+
+  const u16* h = data + z * mapWidth + x;
+  float h00 = h[0], h10 = h[1], h01 = h[mapWidth], h11 = h[mapWidth + 1];
+  float q = fx >= fz ? h00 + (h10 - h00) * fx + (h11 - h10) * fz
+                     : h00 + (h11 - h01) * fx + (h01 - h00) * fz;
+  return minHeight + q * heightScale;
+}
+
+void Heightmap::sampleHeights(const Vec4* in, float* out, size_t n) const {
+  if (!data) {
+    std::fill(out, out + n, 0.0F);
+    return;
+  }
+
+  // same as sampleBilinear, with everything the loop reads pulled into
+  // locals so the compiler doesn't reload it after every store to out
+  const u16* const heights = data;
+  const int width = mapWidth;
+  const int lastCellX = mapWidth - 2, lastCellZ = mapHeight - 2;
+  const float scaleX = gridScaleX, scaleZ = gridScaleZ;
+  const float offsetX = gridOffsetX, offsetZ = gridOffsetZ;
+  const float maxX = gridMaxX, maxZ = gridMaxZ;
+  const float base = minHeight, scale = heightScale;
+
+  for (size_t i = 0; i < n; i++) {
+    float gx = std::min(std::max(in[i].x * scaleX + offsetX, 0.0F), maxX);
+    float gz = std::min(std::max(in[i].z * scaleZ + offsetZ, 0.0F), maxZ);
+    int x = std::min(static_cast<int>(gx), lastCellX);
+    int z = std::min(static_cast<int>(gz), lastCellZ);
+    float fx = gx - x;
+    float fz = gz - z;
+
+    const u16* h = heights + z * width + x;
+    float top = h[0] + (h[1] - h[0]) * fx;
+    float bottom = h[width] + (h[width + 1] - h[width]) * fx;
+    out[i] = base + (top + (bottom - top) * fz) * scale;
+  }
+}
+
+Vec4 Heightmap::sampleNormal(const Vec4& position) const {
+  if (!data) return Vec4(0.0F, 1.0F, 0.0F);
+
+  int x, z;
+  float fx, fz;
+  getCell(position, &x, &z, &fx, &fz);
+
+  const auto& normal = normals[z * (mapWidth - 1) + x];
+  const float unpack = 1.0F / 127.0F;
+  return Vec4(normal.x * unpack, normal.y * unpack, normal.z * unpack);
+}
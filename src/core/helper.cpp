@@ -1,4 +1,8 @@
 #include "core/helper.hpp"
+#include "core/asset_archive.hpp"
+#ifdef _EE
+#include <kernel.h>
+#endif
 
 std::string Helper::fromCwd(const std::string& path)
 {
@@ -13,4 +17,45 @@ std::string Helper::fromCwd(const std::string& path)
     return cdfsPath.str();
 
     #endif
-}
\ No newline at end of file
+}
+
+bool Helper::resolve(const std::string& path, AssetRange* range)
+{
+    auto* archive = AssetArchive::GetArchive();
+    if (!archive)
+    {
+        return false;
+    }
+
+    const auto* entry = archive->Find(path);
+    if (!entry)
+    {
+        return false;
+    }
+
+    range->offset = entry->offset;
+    range->size = entry->size;
+    range->storedSize = entry->storedSize;
+    range->compressed = entry->flags & ARCHIVE_ENTRY_FLAG_COMPRESSED;
+    return true;
+}
+
+int Helper::getThreadPriority()
+{
+#ifdef _EE
+    ee_thread_status_t status;
+    if (ReferThreadStatus(GetThreadId(), &status) >= 0)
+    {
+        return status.current_priority;
+    }
+#endif
+    return 0;
+}
+
+void Helper::setThreadPriority(int priority)
+{
+#ifdef _EE
+    // 0 is the highest, 127 the lowest, leave 0 to the kernel
+    ChangeThreadPriority(GetThreadId(), priority < 1 ? 1 : priority > 127 ? 127 : priority);
+#endif
+}
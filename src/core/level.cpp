@@ -5,8 +5,9 @@ Level::Level(const std::string& basePath, const std::string& modelPath, const st
 {
     this->basePath = basePath;
 
-    staticMeshComponent = new StaticMeshComponent(modelPath, texturePath, options);
-    AddComponent(staticMeshComponent);
+    staticBatch = new StaticBatchComponent(128.f);
+    AddComponent(staticBatch);
+    staticBatch->AddMesh(modelPath, texturePath, options);
 
     Setup();
 }
@@ -41,4 +42,17 @@ TPE_Unit Level::GetGravity()
 std::string Level::GetBasePath()
 {
     return basePath;
+}
+
+StaticBatchComponent* Level::GetStaticBatch()
+{
+    return staticBatch;
+}
+
+void Level::FinishLoading()
+{
+    if (staticBatch)
+    {
+        staticBatch->Build();
+    }
 }
\ No newline at end of file
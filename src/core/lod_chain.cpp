@@ -0,0 +1,54 @@
+#include "core/lod_chain.hpp"
+
+#include <algorithm>
+
+void LodChain::AddLod(const std::string& lodModelPath, float distance)
+{
+    TYRA_ASSERT(lods.empty(), "LODs have to be added before Setup");
+    sources.push_back({lodModelPath, 0});
+    distances.push_back(distance);
+}
+
+void LodChain::AddGeneratedLod(float distance, int gridResolution)
+{
+    TYRA_ASSERT(lods.empty(), "LODs have to be added before Setup");
+    sources.push_back({"", gridResolution});
+    distances.push_back(distance);
+}
+
+void LodChain::SetHysteresis(float hysteresis)
+{
+    this->hysteresis = hysteresis;
+}
+
+void LodChain::Resolve(const std::string& modelPath, const std::string& texturePath, const Tyra::ObjLoaderOptions& options)
+{
+    auto meshes = AssetCache::GetAssetCache()->GetMeshAndLods(modelPath, texturePath, options, sources);
+
+    lods.push_back({meshes[0], 0.f});
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (!meshes[i + 1])
+        {
+            TYRA_LOG("LodChain: ", modelPath, " LOD at ", distances[i], " is empty, skipping");
+            continue;
+        }
+        lods.push_back({meshes[i + 1], distances[i]});
+    }
+    sources.clear();
+    distances.clear();
+    std::sort(lods.begin() + 1, lods.end(), [](const Lod& a, const Lod& b) { return a.distance < b.distance; });
+}
+
+size_t LodChain::Select(size_t current, float distance) const
+{
+    while (current + 1 < lods.size() && distance > lods[current + 1].distance * (1.f + hysteresis))
+    {
+        current++;
+    }
+    while (current > 0 && distance < lods[current].distance * (1.f - hysteresis))
+    {
+        current--;
+    }
+    return current;
+}
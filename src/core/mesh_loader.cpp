@@ -0,0 +1,294 @@
+#include "core/mesh_loader.hpp"
+#include "core/asset_loader.hpp"
+#include "core/asset_file.hpp"
+#include "core/profiler.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+std::string MeshLoader::GetBlobPath(const std::string& modelPath)
+{
+    auto dot = modelPath.find_last_of('.');
+    auto slash = modelPath.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return modelPath + MESH_FILE_EXTENSION;
+    }
+    return modelPath.substr(0, dot) + MESH_FILE_EXTENSION;
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshLoader::Load(const std::string& modelPath, const Tyra::ObjLoaderOptions& options)
+{
+    // main thread only, the loader thread goes straight to LoadFromDisk
+    PROFILE_SCOPE("Assets");
+    auto* assetLoader = AssetLoader::GetAssetLoader();
+    if (assetLoader)
+    {
+        auto data = assetLoader->Acquire(modelPath, options);
+        if (data)
+        {
+            return data;
+        }
+    }
+    return LoadFromDisk(modelPath, options);
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshLoader::LoadFromDisk(const std::string& modelPath, const Tyra::ObjLoaderOptions& options)
+{
+    TRACE_SCOPE("Decode");
+#ifdef GWC_VERIFY_MESHES
+    u32 start = GameClock::GetTicks();
+#endif
+    auto data = LoadBlob(GetBlobPath(modelPath), options);
+    if (data)
+    {
+#ifdef GWC_VERIFY_MESHES
+        Verify(modelPath, data.get(), GameClock::TicksToSeconds(GameClock::GetTicks() - start) * 1000.0F, options);
+#endif
+        return data;
+    }
+    return Tyra::ObjLoader::load(Helper::fromCwd(modelPath), options);
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshLoader::LoadBlob(const std::string& path, const Tyra::ObjLoaderOptions& options)
+{
+    u32 size;
+    auto blob = AssetFile::ReadAll(path, &size);
+    if (!blob)
+    {
+        return nullptr;
+    }
+
+    auto data = FromBlob(blob.get(), size, options);
+    if (!data)
+    {
+        TYRA_LOG("Mesh blob ", path, " is malformed, falling back to OBJ");
+    }
+    return data;
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshLoader::FromBlob(const u8* blob, u32 size, const Tyra::ObjLoaderOptions& options)
+{
+    if (size < sizeof(MeshFileHeader))
+    {
+        return nullptr;
+    }
+
+    const auto* header = reinterpret_cast<const MeshFileHeader*>(blob);
+    // bounds written so a corrupt count or offset can't wrap around them
+    if (header->magic != MESH_FILE_MAGIC || header->version != MESH_FILE_VERSION || header->totalSize != size ||
+        header->materialCount > (size - sizeof(MeshFileHeader)) / sizeof(MeshFileMaterial) || header->scale == 0.f)
+    {
+        return nullptr;
+    }
+
+    // blobs are baked with some options, only the difference has to be applied here
+    const float scale = options.scale / header->scale;
+    const bool flipUVs = options.flipUVs != (header->flipUVs != 0);
+    const u32 attributes = MeshFileAttributeCount(header->flags);
+    const auto* materials = reinterpret_cast<const MeshFileMaterial*>(blob + sizeof(MeshFileHeader));
+
+    auto result = std::make_unique<Tyra::MeshBuilderData>();
+    result->loadNormals = header->flags & MESH_FILE_FLAG_NORMALS;
+
+    for (u32 m = 0; m < header->materialCount; m++)
+    {
+        const auto& source = materials[m];
+        const u32 count = source.vertexCount;
+        if (source.dataOffset % 16 != 0 || source.dataOffset > size || count > (size - source.dataOffset) / (attributes * 16))
+        {
+            return nullptr;
+        }
+
+        const float* floats = reinterpret_cast<const float*>(blob + source.dataOffset);
+        auto frame = std::make_unique<Tyra::MeshBuilderDataMaterialFrame>();
+        frame->count = count;
+
+        frame->vertices = new Tyra::Vec4[count];
+        for (u32 i = 0; i < count; i++, floats += 4)
+        {
+            frame->vertices[i] = Tyra::Vec4(floats[0] * scale, floats[1] * scale, floats[2] * scale, 1.f);
+        }
+
+        if (header->flags & MESH_FILE_FLAG_NORMALS)
+        {
+            frame->normals = new Tyra::Vec4[count];
+            for (u32 i = 0; i < count; i++, floats += 4)
+            {
+                frame->normals[i] = Tyra::Vec4(floats[0], floats[1], floats[2], floats[3]);
+            }
+        }
+
+        if (header->flags & MESH_FILE_FLAG_TEXTURE_COORDS)
+        {
+            frame->textureCoords = new Tyra::Vec4[count];
+            for (u32 i = 0; i < count; i++, floats += 4)
+            {
+                frame->textureCoords[i] = Tyra::Vec4(floats[0], flipUVs ? 1.f - floats[1] : floats[1], floats[2], floats[3]);
+            }
+        }
+
+        if (header->flags & MESH_FILE_FLAG_COLORS)
+        {
+            frame->colors = new Tyra::Color[count];
+            for (u32 i = 0; i < count; i++, floats += 4)
+            {
+                frame->colors[i] = Tyra::Color(floats[0], floats[1], floats[2], floats[3]);
+            }
+        }
+
+        auto material = std::make_unique<Tyra::MeshBuilderDataMaterial>();
+        material->name = std::string(source.name, strnlen(source.name, MESH_FILE_NAME_LENGTH));
+        material->ambient = Tyra::Color(source.ambient[0], source.ambient[1], source.ambient[2], source.ambient[3]);
+        if (source.texturePath[0])
+        {
+            material->texturePath = std::string(source.texturePath, strnlen(source.texturePath, MESH_FILE_NAME_LENGTH));
+        }
+        material->frames.push_back(std::move(frame));
+        result->materials.push_back(std::move(material));
+    }
+
+    return result;
+}
+
+#ifdef GWC_VERIFY_MESHES
+
+namespace {
+
+bool Near(float a, float b)
+{
+    return std::fabs(a - b) <= 1e-4F * std::max(1.0F, std::fabs(a));
+}
+
+template <typename T, typename Same>
+std::string CompareArray(const char* name, const T* blob, const T* obj, u32 count, Same same)
+{
+    if (!blob != !obj)
+    {
+        return std::string(name) + (blob ? " only in the blob" : " only in the OBJ");
+    }
+    for (u32 i = 0; blob && i < count; i++)
+    {
+        if (!same(blob[i], obj[i]))
+        {
+            return std::string(name) + " " + std::to_string(i) + " differs";
+        }
+    }
+    return "";
+}
+
+}
+
+std::string MeshLoader::Compare(const Tyra::MeshBuilderData* blob, const Tyra::MeshBuilderData* obj)
+{
+    if (blob->materials.size() != obj->materials.size())
+    {
+        return std::to_string(blob->materials.size()) + " materials vs " + std::to_string(obj->materials.size());
+    }
+
+    auto sameVec4 = [](const Tyra::Vec4& a, const Tyra::Vec4& b)
+    { return Near(a.x, b.x) && Near(a.y, b.y) && Near(a.z, b.z) && Near(a.w, b.w); };
+    auto sameColor = [](const Tyra::Color& a, const Tyra::Color& b)
+    { return Near(a.r, b.r) && Near(a.g, b.g) && Near(a.b, b.b) && Near(a.a, b.a); };
+
+    for (size_t m = 0; m < blob->materials.size(); m++)
+    {
+        const auto& a = *blob->materials[m];
+        const auto& b = *obj->materials[m];
+        std::string where = "material " + std::to_string(m) + " (" + b.name + "): ";
+        if (a.name != b.name)
+        {
+            return where + "named " + a.name;
+        }
+        if (a.texturePath != b.texturePath)
+        {
+            return where + "texture " + a.texturePath.value_or("none") + " vs " + b.texturePath.value_or("none");
+        }
+        if (!sameColor(a.ambient, b.ambient))
+        {
+            return where + "ambient differs";
+        }
+        if (a.frames.size() != 1 || b.frames.size() != 1)
+        {
+            return where + std::to_string(a.frames.size()) + " frames vs " + std::to_string(b.frames.size());
+        }
+
+        const auto& fa = *a.frames[0];
+        const auto& fb = *b.frames[0];
+        if (fa.count != fb.count)
+        {
+            return where + std::to_string(fa.count) + " vertices vs " + std::to_string(fb.count);
+        }
+        std::string difference = CompareArray("vertex", fa.vertices, fb.vertices, fa.count, sameVec4);
+        if (difference.empty()) difference = CompareArray("normal", fa.normals, fb.normals, fa.count, sameVec4);
+        if (difference.empty()) difference = CompareArray("texture coord", fa.textureCoords, fb.textureCoords, fa.count, sameVec4);
+        if (difference.empty()) difference = CompareArray("color", fa.colors, fb.colors, fa.count, sameColor);
+        if (!difference.empty())
+        {
+            return where + difference;
+        }
+    }
+    return "";
+}
+
+void MeshLoader::Verify(const std::string& modelPath, const Tyra::MeshBuilderData* blob, float blobMs, const Tyra::ObjLoaderOptions& options)
+{
+    u32 start = GameClock::GetTicks();
+    auto obj = Tyra::ObjLoader::load(Helper::fromCwd(modelPath), options);
+    float objMs = GameClock::TicksToSeconds(GameClock::GetTicks() - start) * 1000.0F;
+
+    std::string difference = obj ? Compare(blob, obj.get()) : "the OBJ doesn't load";
+    TYRA_LOG("MeshLoader: ", modelPath, " blob ", blobMs, "ms, OBJ ", objMs, "ms, ",
+             difference.empty() ? "same" : "DIFFERENT, " + difference);
+}
+
+#endif
+
+namespace {
+
+template <typename T>
+T* CopyArray(const T* source, u32 count)
+{
+    if (!source)
+    {
+        return nullptr;
+    }
+    T* result = new T[count];
+    for (u32 i = 0; i < count; i++)
+    {
+        result[i] = source[i];
+    }
+    return result;
+}
+
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshLoader::Clone(const Tyra::MeshBuilderData* data)
+{
+    auto result = std::make_unique<Tyra::MeshBuilderData>();
+    result->loadNormals = data->loadNormals;
+    result->loadLightmap = data->loadLightmap;
+
+    for (const auto& sourceMaterial : data->materials)
+    {
+        auto material = std::make_unique<Tyra::MeshBuilderDataMaterial>();
+        material->name = sourceMaterial->name;
+        material->ambient = sourceMaterial->ambient;
+        material->texturePath = sourceMaterial->texturePath;
+
+        for (const auto& sourceFrame : sourceMaterial->frames)
+        {
+            auto frame = std::make_unique<Tyra::MeshBuilderDataMaterialFrame>();
+            frame->count = sourceFrame->count;
+            frame->vertices = CopyArray(sourceFrame->vertices, frame->count);
+            frame->normals = CopyArray(sourceFrame->normals, frame->count);
+            frame->textureCoords = CopyArray(sourceFrame->textureCoords, frame->count);
+            frame->colors = CopyArray(sourceFrame->colors, frame->count);
+            material->frames.push_back(std::move(frame));
+        }
+        result->materials.push_back(std::move(material));
+    }
+
+    return result;
+}
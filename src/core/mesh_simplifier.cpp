@@ -0,0 +1,142 @@
+#include "core/mesh_simplifier.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <cfloat>
+
+namespace {
+
+struct Cluster
+{
+    Tyra::Vec4 sum{0.f, 0.f, 0.f, 0.f};
+    u32 count = 0;
+};
+
+}
+
+u32 MeshSimplifier::CountVertices(const Tyra::MeshBuilderData* data)
+{
+    u32 result = 0;
+    for (const auto& material : data->materials)
+    {
+        if (!material->frames.empty())
+        {
+            result += material->frames[0]->count;
+        }
+    }
+    return result;
+}
+
+std::unique_ptr<Tyra::MeshBuilderData> MeshSimplifier::Simplify(const Tyra::MeshBuilderData* data, int gridResolution)
+{
+    TYRA_ASSERT(gridResolution > 0, "Grid resolution has to be positive");
+
+    Tyra::Vec4 min(FLT_MAX, FLT_MAX, FLT_MAX);
+    Tyra::Vec4 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const auto& material : data->materials)
+    {
+        if (material->frames.empty()) continue;
+        const auto* frame = material->frames[0].get();
+        for (u32 i = 0; i < frame->count; i++)
+        {
+            const auto& v = frame->vertices[i];
+            if (v.x < min.x) min.x = v.x;
+            if (v.y < min.y) min.y = v.y;
+            if (v.z < min.z) min.z = v.z;
+            if (v.x > max.x) max.x = v.x;
+            if (v.y > max.y) max.y = v.y;
+            if (v.z > max.z) max.z = v.z;
+        }
+    }
+
+    float longest = max.x - min.x;
+    if (max.y - min.y > longest) longest = max.y - min.y;
+    if (max.z - min.z > longest) longest = max.z - min.z;
+    if (longest <= 0.f)
+    {
+        return nullptr;
+    }
+    const float invCellSize = gridResolution / longest;
+
+    // 21 bits per axis is way more than any sane grid resolution
+    auto cellKey = [&](const Tyra::Vec4& v) -> u64 {
+        u64 x = static_cast<u64>((v.x - min.x) * invCellSize);
+        u64 y = static_cast<u64>((v.y - min.y) * invCellSize);
+        u64 z = static_cast<u64>((v.z - min.z) * invCellSize);
+        return (x & 0x1FFFFF) | ((y & 0x1FFFFF) << 21) | ((z & 0x1FFFFF) << 42);
+    };
+
+    // clusters are shared between materials, so seams between them stay closed
+    std::unordered_map<u64, Cluster> clusters;
+    for (const auto& material : data->materials)
+    {
+        if (material->frames.empty()) continue;
+        const auto* frame = material->frames[0].get();
+        for (u32 i = 0; i < frame->count; i++)
+        {
+            auto& cluster = clusters[cellKey(frame->vertices[i])];
+            cluster.sum += frame->vertices[i];
+            cluster.count++;
+        }
+    }
+
+    auto result = std::make_unique<Tyra::MeshBuilderData>();
+    result->loadNormals = data->loadNormals;
+    result->loadLightmap = data->loadLightmap;
+
+    std::vector<u32> kept;
+    for (const auto& material : data->materials)
+    {
+        if (material->frames.empty()) continue;
+        const auto* frame = material->frames[0].get();
+
+        kept.clear();
+        for (u32 i = 0; i + 2 < frame->count; i += 3)
+        {
+            u64 a = cellKey(frame->vertices[i]);
+            u64 b = cellKey(frame->vertices[i + 1]);
+            u64 c = cellKey(frame->vertices[i + 2]);
+            if (a != b && b != c && a != c)
+            {
+                kept.push_back(i);
+            }
+        }
+
+        if (kept.empty()) continue;
+
+        auto newFrame = std::make_unique<Tyra::MeshBuilderDataMaterialFrame>();
+        newFrame->count = kept.size() * 3;
+        newFrame->vertices = new Tyra::Vec4[newFrame->count];
+        if (frame->normals) newFrame->normals = new Tyra::Vec4[newFrame->count];
+        if (frame->textureCoords) newFrame->textureCoords = new Tyra::Vec4[newFrame->count];
+        if (frame->colors) newFrame->colors = new Tyra::Color[newFrame->count];
+
+        u32 out = 0;
+        for (const auto& first : kept)
+        {
+            for (u32 i = first; i < first + 3; i++, out++)
+            {
+                const auto& cluster = clusters[cellKey(frame->vertices[i])];
+                newFrame->vertices[out] = cluster.sum / static_cast<float>(cluster.count);
+                newFrame->vertices[out].w = 1.f;
+                if (frame->normals) newFrame->normals[out] = frame->normals[i];
+                if (frame->textureCoords) newFrame->textureCoords[out] = frame->textureCoords[i];
+                if (frame->colors) newFrame->colors[out] = frame->colors[i];
+            }
+        }
+
+        auto newMaterial = std::make_unique<Tyra::MeshBuilderDataMaterial>();
+        newMaterial->name = material->name;
+        newMaterial->ambient = material->ambient;
+        newMaterial->texturePath = material->texturePath;
+        newMaterial->frames.push_back(std::move(newFrame));
+        result->materials.push_back(std::move(newMaterial));
+    }
+
+    if (result->materials.empty())
+    {
+        return nullptr;
+    }
+
+    return result;
+}
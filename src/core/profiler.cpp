@@ -0,0 +1,328 @@
+#include "core/profiler.hpp"
+
+#ifdef GWC_PROFILE
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+Profiler::Zone Profiler::zones[PROFILER_MAX_ZONES];
+int Profiler::zoneCount = 0;
+Profiler::Counter Profiler::counters[PROFILER_MAX_COUNTERS];
+int Profiler::counterCount = 0;
+u32 Profiler::ticksHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+u16 Profiler::callsHistory[PROFILER_MAX_ZONES][PROFILER_FRAMES];
+u32 Profiler::countersHistory[PROFILER_MAX_COUNTERS][PROFILER_FRAMES];
+int Profiler::frameCount = 0;
+u32 Profiler::frameStart = 0;
+bool Profiler::frameStarted = false;
+u32 Profiler::allocsHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+u32 Profiler::allocBytesHistory[PROFILER_MAX_ZONES + 1][PROFILER_FRAMES];
+int Profiler::currentZone = -1;
+const std::thread::id Profiler::mainThread = std::this_thread::get_id();
+u32 Profiler::frameAllocs = 0;
+u32 Profiler::frameAllocBytes = 0;
+int Profiler::allocBudget = -1;
+bool Profiler::allocBudgetFatal = false;
+int Profiler::framesSettled = 0;
+int Profiler::framesSinceBudgetLog = PROFILER_FRAMES;
+
+int Profiler::GetZone(const char* name)
+{
+    for (int i = 0; i < zoneCount; i++)
+    {
+        if (strcmp(zones[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    if (zoneCount == PROFILER_MAX_ZONES)
+    {
+        TYRA_LOG("Profiler: out of zones, ", name, " won't be recorded");
+        return -1;
+    }
+    zones[zoneCount] = {name, 0, 0, 0, 0, -1, 0, 0};
+    return zoneCount++;
+}
+
+int Profiler::GetCounter(const char* name, u32 unit)
+{
+    for (int i = 0; i < counterCount; i++)
+    {
+        if (strcmp(counters[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    if (counterCount == PROFILER_MAX_COUNTERS)
+    {
+        TYRA_LOG("Profiler: out of counters, ", name, " won't be recorded");
+        return -1;
+    }
+    counters[counterCount] = {name, unit > 0 ? unit : 1, 0};
+    return counterCount++;
+}
+
+void Profiler::SetAllocBudget(int allocs, bool fatal)
+{
+    allocBudget = allocs;
+    allocBudgetFatal = fatal;
+}
+
+void Profiler::EndFrame()
+{
+    u32 now = GetTicks();
+    u32 allocs = frameAllocs;
+
+    // the first call only starts the clock
+    if (frameStarted)
+    {
+        int index = frameCount % PROFILER_FRAMES;
+        for (int i = 0; i < zoneCount; i++)
+        {
+            ticksHistory[i][index] = zones[i].ticks;
+            callsHistory[i][index] = static_cast<u16>(std::min<u32>(zones[i].calls, 0xFFFF));
+            allocsHistory[i][index] = zones[i].allocs;
+            allocBytesHistory[i][index] = zones[i].allocBytes;
+        }
+        for (int i = 0; i < counterCount; i++)
+        {
+            countersHistory[i][index] = counters[i].value;
+        }
+        ticksHistory[PROFILER_MAX_ZONES][index] = now - frameStart;
+        allocsHistory[PROFILER_MAX_ZONES][index] = allocs;
+        allocBytesHistory[PROFILER_MAX_ZONES][index] = frameAllocBytes;
+        frameCount++;
+
+        framesSinceBudgetLog++;
+        if (allocBudget >= 0 && framesSettled >= PROFILER_SETTLE_FRAMES && allocs > static_cast<u32>(allocBudget))
+        {
+            int worst = -1;
+            for (int i = 0; i < zoneCount; i++)
+            {
+                if (worst < 0 || zones[i].allocs > zones[worst].allocs) worst = i;
+            }
+            const char* worstName = worst >= 0 && zones[worst].allocs > 0 ? zones[worst].name : "no zone";
+            TYRA_ASSERT(!allocBudgetFatal, "Profiler: ", allocs, " allocations in frame ", frameCount, ", the budget is ",
+                        allocBudget, ", most in ", worstName);
+            if (framesSinceBudgetLog >= PROFILER_FRAMES)
+            {
+                TYRA_LOG("Profiler: ", allocs, " allocations in frame ", frameCount, ", the budget is ", allocBudget,
+                         ", most in ", worstName);
+                framesSinceBudgetLog = 0;
+            }
+        }
+    }
+    framesSettled++;
+
+    for (int i = 0; i < zoneCount; i++)
+    {
+        zones[i].ticks = 0;
+        zones[i].calls = 0;
+        zones[i].allocs = 0;
+        zones[i].allocBytes = 0;
+    }
+    for (int i = 0; i < counterCount; i++)
+    {
+        counters[i].value = 0;
+    }
+    // whatever the logging above allocated goes too
+    frameAllocs = 0;
+    frameAllocBytes = 0;
+    frameStart = now;
+    frameStarted = true;
+}
+
+ProfileStats Profiler::GetStats(const u32* values, const u16* calls, float scale)
+{
+    ProfileStats stats = {};
+    int count = GetFrameCount();
+    if (count == 0)
+    {
+        return stats;
+    }
+
+    u32 sorted[PROFILER_FRAMES];
+    u64 total = 0;
+    u32 totalCalls = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sorted[i] = values[i];
+        total += values[i];
+        if (calls)
+        {
+            totalCalls += calls[i];
+        }
+    }
+    std::sort(sorted, sorted + count);
+
+    stats.min = sorted[0] * scale;
+    stats.max = sorted[count - 1] * scale;
+    stats.avg = static_cast<float>(total) / count * scale;
+    stats.p99 = sorted[(count - 1) * 99 / 100] * scale;
+    stats.calls = calls ? static_cast<float>(totalCalls) / count : 1.0F;
+    return stats;
+}
+
+ProfileStats Profiler::GetStats(int zone)
+{
+    return GetStats(ticksHistory[zone], callsHistory[zone], TicksToMs(1));
+}
+
+ProfileStats Profiler::GetFrameStats()
+{
+    return GetStats(ticksHistory[PROFILER_MAX_ZONES], nullptr, TicksToMs(1));
+}
+
+ProfileStats Profiler::GetCounterStats(int counter)
+{
+    return GetStats(countersHistory[counter], nullptr, 1.0F);
+}
+
+ProfileStats Profiler::GetAllocStats(int zone)
+{
+    return GetStats(allocsHistory[zone], nullptr, 1.0F);
+}
+
+ProfileStats Profiler::GetAllocBytesStats(int zone)
+{
+    return GetStats(allocBytesHistory[zone], nullptr, 1.0F);
+}
+
+ProfileStats Profiler::GetFrameAllocStats()
+{
+    return GetAllocStats(PROFILER_MAX_ZONES);
+}
+
+ProfileStats Profiler::GetFrameAllocBytesStats()
+{
+    return GetAllocBytesStats(PROFILER_MAX_ZONES);
+}
+
+std::string Profiler::GetReport()
+{
+    std::stringstream report;
+    char line[128];
+    snprintf(line, sizeof(line), "%-20s %8s %8s %8s %8s %8s  (ms over %d frames)\n", "zone", "min", "avg", "max", "p99", "calls", GetFrameCount());
+    report << line;
+
+    auto print = [&](const char* name, const ProfileStats& stats) {
+        snprintf(line, sizeof(line), "%-20s %8.3f %8.3f %8.3f %8.3f %8.1f\n", name, stats.min, stats.avg, stats.max, stats.p99, stats.calls);
+        report << line;
+    };
+
+    print("Frame", GetFrameStats());
+    for (int i = 0; i < zoneCount; i++)
+    {
+        print(zones[i].name, GetStats(i));
+    }
+
+    if (counterCount > 0)
+    {
+        snprintf(line, sizeof(line), "%-20s %8s %8s %8s %8s  (per frame)\n", "counter", "min", "avg", "max", "p99");
+        report << line;
+        for (int i = 0; i < counterCount; i++)
+        {
+            auto stats = GetCounterStats(i);
+            snprintf(line, sizeof(line), "%-20s %8.0f %8.1f %8.0f %8.0f\n", counters[i].name, stats.min, stats.avg, stats.max, stats.p99);
+            report << line;
+        }
+    }
+
+    snprintf(line, sizeof(line), "%-20s %8s %8s %8s %8s %8s  (main thread, per frame)\n", "allocations", "min", "avg", "max",
+             "p99", "avg B");
+    report << line;
+    auto printAllocs = [&](const char* name, const ProfileStats& stats, const ProfileStats& bytes) {
+        snprintf(line, sizeof(line), "%-20s %8.0f %8.1f %8.0f %8.0f %8.0f\n", name, stats.min, stats.avg, stats.max, stats.p99, bytes.avg);
+        report << line;
+    };
+    printAllocs("Frame", GetFrameAllocStats(), GetFrameAllocBytesStats());
+    for (int i = 0; i < zoneCount; i++)
+    {
+        printAllocs(zones[i].name, GetAllocStats(i), GetAllocBytesStats(i));
+    }
+    return report.str();
+}
+
+void Profiler::LogReport()
+{
+    TYRA_LOG("Profiler:\n", GetReport());
+}
+
+bool Profiler::WriteReport(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        TYRA_LOG("Profiler: can't write ", path);
+        return false;
+    }
+    auto report = GetReport();
+    bool written = fwrite(report.data(), 1, report.size(), file) == report.size();
+    fclose(file);
+    return written;
+}
+
+// every variant, or the runtime's own ones (ASan's among them) would end up
+// freeing what these allocated
+void* operator new(size_t size)
+{
+    Profiler::CountAlloc(size);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    Profiler::CountAlloc(size);
+    return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) noexcept
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t size) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+#endif
@@ -0,0 +1,406 @@
+#include "core/raycast_vehicle.hpp"
+#include <algorithm>
+#include <cmath>
+
+using Tyra::Vec4;
+
+namespace {
+
+Vec4 FromTPE(TPE_Vec3 v)
+{
+    return Vec4(v.x, v.y, v.z);
+}
+
+TPE_Vec3 ToTPE(const Vec4& v)
+{
+    return TPE_vec3(static_cast<TPE_Unit>(std::lround(v.x)), static_cast<TPE_Unit>(std::lround(v.y)),
+                    static_cast<TPE_Unit>(std::lround(v.z)));
+}
+
+float Clamp(float value, float min, float max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+}
+
+RaycastVehicleSetup RaycastVehicleSetup::ForCar()
+{
+    RaycastVehicleSetup setup;
+
+    // Car's MakeCenterRectFull(1000, 1800, 400): joints 0 and 1 at the back,
+    // 2 and 3 at the front, joint 4 raised 700 and half again as big
+    setup.wheels[0] = Vec4(500.0f, -100.0f, 900.0f);
+    setup.wheels[1] = Vec4(-500.0f, -100.0f, 900.0f);
+    setup.wheels[2] = Vec4(500.0f, -100.0f, -900.0f);
+    setup.wheels[3] = Vec4(-500.0f, -100.0f, -900.0f);
+    for (int i = 0; i < 4; i++)
+    {
+        setup.hull[i] = Vec4(setup.wheels[i].x, 300.0f, setup.wheels[i].z);
+        setup.hullRadius[i] = 250.0f;
+    }
+    setup.hull[4] = Vec4(0.0f, 700.0f, 0.0f);
+    setup.hullRadius[4] = 576.0f;
+    setup.center = setup.hull[4];
+    setup.halfExtents = Vec4(500.0f, 350.0f, 900.0f);
+
+    // the spring carries the car 100 into its 300 of travel, so the chassis
+    // sits where the soft body's joints would, and bounces about 2.5 times a
+    // second at 50 fps
+    setup.wheelRadius = 384.0f;
+    setup.restLength = 300.0f;
+    setup.stiffness = (TPE_F / 50) / 4.0f / 100.0f;
+    setup.damping = 0.06f;
+
+    setup.engine = 3.5f;
+    setup.maxSteer = 0.5f;
+    setup.steerSpeed = 0.1f;
+    setup.grip = 0.3f;
+    setup.peakSlip = 0.2f;
+    setup.slideGrip = 0.5f;
+    setup.friction = 1.2f;
+    setup.rollingResistance = 0.012f;
+    setup.angularDamping = 0.02f;
+    return setup;
+}
+
+RaycastVehicle::RaycastVehicle(const RaycastVehicleSetup& setup) : setup(setup)
+{
+    // a box of mass 1 around center, moved over to the origin (parallel axis)
+    const Vec4& e = setup.halfExtents;
+    const Vec4& d = setup.center;
+    float box[3] = {(e.y * e.y + e.z * e.z) / 3.0f, (e.x * e.x + e.z * e.z) / 3.0f, (e.x * e.x + e.y * e.y) / 3.0f};
+    float offset[3] = {d.x, d.y, d.z};
+    float inertia[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            inertia[i][j] = (i == j ? box[i] + d.dot3(d) : 0.0f) - offset[i] * offset[j];
+        }
+    }
+
+    // symmetric, so the inverse is the cofactors over the determinant
+    for (int i = 0; i < 3; i++)
+    {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        float row[3];
+        for (int j = 0; j < 3; j++)
+        {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            row[j] = inertia[i1][j1] * inertia[i2][j2] - inertia[i1][j2] * inertia[i2][j1];
+        }
+        inverseInertia[i] = Vec4(row[0], row[1], row[2]);
+    }
+    float determinant = inertia[0][0] * inverseInertia[0].x + inertia[0][1] * inverseInertia[0].y + inertia[0][2] * inverseInertia[0].z;
+    for (auto& row : inverseInertia)
+    {
+        row /= determinant;
+    }
+
+    hullCenter = Vec4(0.0f);
+    for (const auto& point : setup.hull)
+    {
+        hullCenter += point / RAYCAST_VEHICLE_HULL_POINTS;
+    }
+    hullBound = 0.0f;
+    for (int i = 0; i < RAYCAST_VEHICLE_HULL_POINTS; i++)
+    {
+        float bound = (setup.hull[i] - hullCenter).length() + setup.hullRadius[i];
+        hullBound = bound > hullBound ? bound : hullBound;
+    }
+
+    position = Vec4(0.0f);
+    velocity = Vec4(0.0f);
+    angularVelocity = Vec4(0.0f);
+}
+
+void RaycastVehicle::MoveTo(TPE_Vec3 position)
+{
+    this->position = FromTPE(position);
+}
+
+void RaycastVehicle::MoveBy(TPE_Vec3 offset)
+{
+    position += FromTPE(offset);
+}
+
+TPE_Vec3 RaycastVehicle::GetPosition() const
+{
+    return ToTPE(position + ToWorld(setup.center));
+}
+
+TPE_Vec3 RaycastVehicle::GetRotation() const
+{
+    // the soft body's joint 0 to 2 and 0 to 1
+    return TPE_rotationFromVecs(ToTPE(axisZ * -TPE_F), ToTPE(axisX * -TPE_F));
+}
+
+TPE_Vec3 RaycastVehicle::GetVelocity() const
+{
+    return ToTPE(velocity);
+}
+
+Vec4 RaycastVehicle::ToWorld(const Vec4& local) const
+{
+    return axisX * local.x + axisY * local.y + axisZ * local.z;
+}
+
+Vec4 RaycastVehicle::ApplyInverseInertia(const Vec4& v) const
+{
+    // over to chassis space, where the inertia is constant, and back
+    Vec4 local(v.dot3(axisX), v.dot3(axisY), v.dot3(axisZ));
+    return axisX * inverseInertia[0].dot3(local) + axisY * inverseInertia[1].dot3(local) + axisZ * inverseInertia[2].dot3(local);
+}
+
+Vec4 RaycastVehicle::PointVelocity(const Vec4& offset) const
+{
+    return velocity + angularVelocity.cross(offset);
+}
+
+void RaycastVehicle::ApplyImpulse(const Vec4& offset, const Vec4& impulse)
+{
+    velocity += impulse;
+    angularVelocity += ApplyInverseInertia(offset.cross(impulse));
+}
+
+float RaycastVehicle::EffectiveMass(const Vec4& offset, const Vec4& axis) const
+{
+    Vec4 turn = offset.cross(axis);
+    return 1.0f / (1.0f + turn.dot3(ApplyInverseInertia(turn)));
+}
+
+float RaycastVehicle::CastRay(TPE_ClosestPointFunction environment, const Vec4& from, const Vec4& direction, float length)
+{
+    // nothing is closer than the closest point, so a step that long can't
+    // pass through anything
+    float travelled = 0.0f;
+    for (int i = 0; i < RAYCAST_VEHICLE_RAY_STEPS; i++)
+    {
+        Vec4 point = from + direction * travelled;
+        TPE_Vec3 p = ToTPE(point);
+        float remaining = length - travelled;
+        environmentCalls++;
+        float distance = FromTPE(environment(p, static_cast<TPE_Unit>(remaining) + 1)).distanceTo(FromTPE(p));
+        if (distance >= remaining)
+        {
+            return length + 1.0f;
+        }
+        if (distance < TPE_COLLISION_RESOLUTION_MARGIN)
+        {
+            return travelled + distance;
+        }
+        travelled += distance;
+    }
+
+    // Out of steps, still closing in on a slope. If the end of the ray is in
+    // the environment the surface is somewhere past travelled, halve the way
+    // to it, otherwise it's a miss rather than a made up hit
+    float inside = length;
+    TPE_Vec3 end = ToTPE(from + direction * length);
+    environmentCalls++;
+    if (FromTPE(environment(end, TPE_COLLISION_RESOLUTION_MARGIN)).distanceTo(FromTPE(end)) >= TPE_COLLISION_RESOLUTION_MARGIN)
+    {
+        return length + 1.0f;
+    }
+    for (int i = 0; i < RAYCAST_VEHICLE_RAY_STEPS && inside - travelled >= TPE_COLLISION_RESOLUTION_MARGIN; i++)
+    {
+        float middle = (travelled + inside) / 2.0f;
+        TPE_Vec3 p = ToTPE(from + direction * middle);
+        environmentCalls++;
+        float distance = FromTPE(environment(p, static_cast<TPE_Unit>(inside - middle) + 1)).distanceTo(FromTPE(p));
+        if (distance < TPE_COLLISION_RESOLUTION_MARGIN)
+        {
+            inside = middle;
+        }
+        else
+        {
+            // still nothing closer than distance, so that much past it is free too
+            travelled = std::min(middle + distance, inside);
+        }
+    }
+    return travelled;
+}
+
+void RaycastVehicle::Step(TPE_ClosestPointFunction environment, TPE_Unit gravity, float throttle, float steering)
+{
+    environmentCalls = 0;
+
+    float target = Clamp(steering, -1.0f, 1.0f) * setup.maxSteer;
+    steer += Clamp(target - steer, -setup.steerSpeed, setup.steerSpeed);
+
+    velocity.y -= gravity;
+    UpdateWheels(environment, throttle);
+    Integrate();
+    ResolveHull(environment);
+}
+
+void RaycastVehicle::UpdateWheels(TPE_ClosestPointFunction environment, float throttle)
+{
+    Vec4 down = -axisY;
+    Vec4 forward = -axisZ;
+    float length = setup.restLength + setup.wheelRadius;
+
+    // falling faster than the rays reach, look as far as it'll fall too, so
+    // landing from a drop doesn't put the wheels through the ground
+    float fall = velocity.dot3(down);
+    float reach = fall > 0.0f ? length + fall : length;
+    float landing = reach;
+
+    // every wheel works off the state the step started with, applying them
+    // one by one would have the first ones steer the rest
+    Vec4 contacts[RAYCAST_VEHICLE_WHEELS];
+    Vec4 impulses[RAYCAST_VEHICLE_WHEELS];
+    int grounded = 0;
+    for (int i = 0; i < RAYCAST_VEHICLE_WHEELS; i++)
+    {
+        impulses[i] = Vec4(0.0f);
+        Wheel& wheel = wheels[i];
+        Vec4 top = ToWorld(setup.wheels[i] + Vec4(0.0f, setup.restLength, 0.0f));
+        float distance = CastRay(environment, position + top, down, reach);
+        float lastCompression = wheel.compression;
+
+        // the most it can go down before the suspension is all the way in
+        if (distance <= reach && distance - setup.wheelRadius < landing)
+        {
+            landing = distance - setup.wheelRadius;
+        }
+
+        wheel.grounded = distance <= length;
+        if (!wheel.grounded)
+        {
+            wheel.compression = 0.0f;
+            continue;
+        }
+        grounded++;
+
+        // past its travel the hull takes over, the spring just stays at its stiffest
+        wheel.compression = Clamp(length - distance, 0.0f, setup.restLength);
+        float load = setup.stiffness * wheel.compression + setup.damping * (wheel.compression - lastCompression);
+        if (load <= 0.0f)
+        {
+            continue;
+        }
+        Vec4 contact = top + down * distance;
+        contacts[i] = contact;
+        impulses[i] = axisY * load;
+
+        // sideways, for the front wheels turned by the steering the way the
+        // soft body turns their friction axis
+        Vec4 side = axisX;
+        if (i >= 2)
+        {
+            side = (axisX + forward * steer).getNormalized();
+        }
+        Vec4 pointVelocity = PointVelocity(contact);
+        float sideways = pointVelocity.dot3(side);
+        float along = pointVelocity.dot3(side.cross(axisY));
+        float slip = std::fabs(sideways) / (std::fabs(along) + 1.0f);
+
+        // full grip up to the peak, then down to sliding by three times that
+        float curve = 1.0f;
+        if (slip > setup.peakSlip)
+        {
+            curve = slip >= 3.0f * setup.peakSlip
+                        ? setup.slideGrip
+                        : 1.0f - (1.0f - setup.slideGrip) * (slip - setup.peakSlip) / (2.0f * setup.peakSlip);
+        }
+        float maxPush = setup.friction * load;
+        float push = Clamp(-sideways * setup.grip * curve * EffectiveMass(contact, side), -maxPush, maxPush);
+        impulses[i] += side * push;
+
+        // the rear wheels drive, what's left of the tyre's friction
+        if (i < 2)
+        {
+            float drive = Clamp(throttle * setup.engine / 2.0f, -maxPush, maxPush);
+            Vec4 rolling = forward - axisY * forward.dot3(axisY);
+            impulses[i] += rolling * drive;
+        }
+    }
+
+    for (int i = 0; i < RAYCAST_VEHICLE_WHEELS; i++)
+    {
+        if (impulses[i].dot3(impulses[i]) > 0.0f)
+        {
+            ApplyImpulse(contacts[i], impulses[i]);
+        }
+    }
+
+    // land on the bump stops instead of going on through, the hull pushes out the rest
+    fall = velocity.dot3(down);
+    if (landing < 0.0f)
+    {
+        landing = 0.0f;
+    }
+    if (fall > landing)
+    {
+        velocity -= down * (fall - landing);
+    }
+
+    if (grounded > 0)
+    {
+        float speed = velocity.dot3(forward);
+        velocity -= forward * (speed * setup.rollingResistance * grounded / RAYCAST_VEHICLE_WHEELS);
+    }
+}
+
+void RaycastVehicle::Integrate()
+{
+    angularVelocity *= 1.0f - setup.angularDamping;
+    position += velocity;
+
+    // rotate the axes by the spin, then square them up again
+    axisY += angularVelocity.cross(axisY);
+    axisZ += angularVelocity.cross(axisZ);
+    axisY.normalize();
+    axisZ = (axisZ - axisY * axisZ.dot3(axisY)).getNormalized();
+    axisX = axisY.cross(axisZ);
+}
+
+void RaycastVehicle::ResolveHull(TPE_ClosestPointFunction environment)
+{
+    // one query says whether any of the points can be touching anything
+    TPE_Vec3 center = ToTPE(position + ToWorld(hullCenter));
+    environmentCalls++;
+    if (TPE_DISTANCE(center, environment(center, static_cast<TPE_Unit>(hullBound))) > hullBound)
+    {
+        return;
+    }
+
+    for (int i = 0; i < RAYCAST_VEHICLE_HULL_POINTS; i++)
+    {
+        Vec4 offset = ToWorld(setup.hull[i]);
+        Vec4 point = position + offset;
+        float radius = setup.hullRadius[i];
+        TPE_Vec3 p = ToTPE(point);
+        environmentCalls++;
+        Vec4 closest = FromTPE(environment(p, static_cast<TPE_Unit>(radius)));
+        Vec4 away = point - closest;
+        float distance = away.length();
+        if (distance >= radius)
+        {
+            continue;
+        }
+
+        // inside, out the way the chassis' top faces is the best guess
+        Vec4 normal = distance > 0.0f ? away / distance : axisY;
+        float depth = distance > 0.0f ? radius - distance : radius;
+        position += normal * depth;
+
+        // stop it going in, and scrape some of the rest off
+        Vec4 pointVelocity = PointVelocity(offset);
+        float in = pointVelocity.dot3(normal);
+        if (in < 0.0f)
+        {
+            ApplyImpulse(offset, normal * (-in * EffectiveMass(offset, normal)));
+            Vec4 scrape = PointVelocity(offset);
+            scrape -= normal * scrape.dot3(normal);
+            float scrapeSpeed = scrape.length();
+            if (scrapeSpeed > 0.0f)
+            {
+                Vec4 direction = scrape / scrapeSpeed;
+                ApplyImpulse(offset, direction * (-scrapeSpeed * 0.1f * EffectiveMass(offset, direction)));
+            }
+        }
+    }
+}
@@ -0,0 +1,269 @@
+#include "core/song_stream.hpp"
+#include "core/trace.hpp"
+#include "core/helper.hpp"
+
+#include <cstring>
+
+SongStream* SongStream::songStream;
+
+SongStream* SongStream::GetSongStream()
+{
+    return songStream;
+}
+
+void SongStream::SetSongStream(SongStream* stream)
+{
+    songStream = stream;
+}
+
+SongStream::SongStream()
+{
+    ring.reset(new u8[RING_SIZE]);
+    chunk.reset(new u8[CHUNK_SIZE]);
+    readerPriority = Helper::getThreadPriority() - 1;
+}
+
+SongStream::~SongStream()
+{
+    Stop();
+}
+
+bool SongStream::Load(const std::string& path)
+{
+    Stop();
+
+    if (!file.Open(path) || !ParseHeader())
+    {
+        TYRA_LOG("Can't stream song ", path);
+        file.Close();
+        return false;
+    }
+
+    ringRead = 0;
+    ringUsed = 0;
+    dataPosition = 0;
+    ended = false;
+    started = false;
+    finished = false;
+    stopping = false;
+    file.Seek(dataOffset);
+    reader = std::thread(&SongStream::Run, this);
+    return true;
+}
+
+bool SongStream::ParseHeader()
+{
+    u8 riff[12];
+    if (file.Read(riff, 12) != 12 || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4))
+    {
+        return false;
+    }
+
+    bool hasFormat = false;
+    u8 header[8];
+    while (file.Read(header, 8) == 8)
+    {
+        u32 size = header[4] | (header[5] << 8) | (header[6] << 16) | (header[7] << 24);
+
+        if (!memcmp(header, "fmt ", 4) && size >= 16)
+        {
+            u8 fmt[16];
+            if (file.Read(fmt, 16) != 16) return false;
+            u16 audioFormat = fmt[0] | (fmt[1] << 8);
+            format.channels = fmt[2] | (fmt[3] << 8);
+            format.freq = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | (fmt[7] << 24);
+            format.bits = fmt[14] | (fmt[15] << 8);
+            if (audioFormat != 1)
+            {
+                TYRA_LOG("Only PCM WAVs can be streamed");
+                return false;
+            }
+            hasFormat = true;
+            size -= 16;
+        }
+        else if (!memcmp(header, "data", 4))
+        {
+            dataOffset = file.Tell();
+            dataSize = size;
+            if (dataSize > file.GetSize() - dataOffset) dataSize = file.GetSize() - dataOffset;
+            return hasFormat && dataSize > 0;
+        }
+
+        // chunks are padded to an even size
+        if (!file.Seek(file.Tell() + size + (size & 1))) return false;
+    }
+    return false;
+}
+
+void SongStream::Play()
+{
+    if (!reader.joinable())
+    {
+        return;
+    }
+    audsrv_set_format(&format);
+    playing = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = true;
+    }
+    wakeReader.notify_all();
+}
+
+void SongStream::Stop()
+{
+    if (reader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeReader.notify_all();
+        reader.join();
+    }
+
+    if (playing)
+    {
+        audsrv_stop_audio();
+        playing = false;
+    }
+    file.Close();
+}
+
+void SongStream::SetLoop(bool loop)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->loop = loop;
+}
+
+void SongStream::SetVolume(int volume)
+{
+    audsrv_set_volume(volume * MAX_VOLUME / 100);
+}
+
+u32 SongStream::ReadChunk(u8* chunk)
+{
+    u32 filled = 0;
+    while (filled < CHUNK_SIZE)
+    {
+        if (dataPosition == dataSize)
+        {
+            bool wrap;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wrap = loop;
+            }
+            if (!wrap || !file.Seek(dataOffset))
+            {
+                break;
+            }
+            dataPosition = 0;
+        }
+
+        u32 wanted = CHUNK_SIZE - filled;
+        if (wanted > dataSize - dataPosition) wanted = dataSize - dataPosition;
+        u32 got = file.Read(chunk + filled, wanted);
+        if (got == 0)
+        {
+            break;
+        }
+        filled += got;
+        dataPosition += got;
+    }
+    return filled;
+}
+
+void SongStream::FillRing()
+{
+    u32 filled;
+    {
+        TRACE_SCOPE("Read chunk");
+        filled = ReadChunk(chunk.get());
+    }
+
+    u32 write = (ringRead + ringUsed) % RING_SIZE;
+    u32 first = RING_SIZE - write < filled ? RING_SIZE - write : filled;
+    memcpy(ring.get() + write, chunk.get(), first);
+    memcpy(ring.get(), chunk.get() + first, filled - first);
+    ringUsed += filled;
+
+    if (filled < CHUNK_SIZE)
+    {
+        ended = true;
+    }
+}
+
+void SongStream::FeedAudio()
+{
+    int available = audsrv_available();
+    while (available > 0 && ringUsed > 0)
+    {
+        u32 count = ringUsed;
+        if (count > RING_SIZE - ringRead) count = RING_SIZE - ringRead;
+        if (count > static_cast<u32>(available)) count = available;
+        audsrv_play_audio(reinterpret_cast<const char*>(ring.get() + ringRead), count);
+        available -= count;
+        ringRead = (ringRead + count) % RING_SIZE;
+        ringUsed -= count;
+    }
+}
+
+void SongStream::Run()
+{
+    TRACE_THREAD("Song reader");
+    Helper::setThreadPriority(readerPriority);
+    while (true)
+    {
+        bool play;
+        {
+            // read ahead until the ring is full, then wait for Play
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeReader.wait(lock, [this] { return stopping || started || (!ended && RING_SIZE - ringUsed >= CHUNK_SIZE); });
+            if (stopping)
+            {
+                return;
+            }
+            play = started;
+        }
+
+        // top audsrv up before every read, a slow read eats into what it has
+        if (play)
+        {
+            FeedAudio();
+        }
+
+        if (!ended && RING_SIZE - ringUsed >= CHUNK_SIZE)
+        {
+            FillRing();
+            continue;
+        }
+
+        if (ringUsed == 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            return;
+        }
+
+        // everything's full, sleep until audsrv played some of it. Not a
+        // whole chunk, audsrv's own buffer could be smaller than that
+        if (play)
+        {
+            audsrv_wait_audio(ringUsed < FEED_SIZE ? ringUsed : FEED_SIZE);
+        }
+    }
+}
+
+void SongStream::Update()
+{
+    if (!playing)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+    {
+        playing = false;
+    }
+}
@@ -0,0 +1,567 @@
+#include "core/tiled_heightmap.hpp"
+#include "core/heightmap.hpp"
+#include "core/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+TiledHeightmap::TiledHeightmap(const std::string& path, int residentTiles)
+{
+    if (!file.Open(path))
+    {
+        TYRA_LOG("Tiled heightmap ", path, " is missing");
+        return;
+    }
+
+    if (file.Read(&header, sizeof(header)) != sizeof(header) || header.magic != HEIGHTMAP_TILED_MAGIC ||
+        header.version != HEIGHTMAP_TILED_VERSION || header.width < 2 || header.height < 2 || header.tileCells == 0 ||
+        header.tilesX != (header.width - 2) / header.tileCells + 1 ||
+        header.tilesZ != (header.height - 2) / header.tileCells + 1 || header.totalSize != file.GetSize() ||
+        HeightmapTiledFileSize(header.tilesX, header.tilesZ, header.tileCells) != file.GetSize())
+    {
+        TYRA_WARN("Tiled heightmap ", path, " is malformed");
+        file.Close();
+        return;
+    }
+
+    // the small parts stay resident the whole time
+    bounds.resize(header.tilesX * header.tilesZ);
+    overview.resize((header.tilesX + 1) * (header.tilesZ + 1));
+    u32 boundsSize = bounds.size() * sizeof(HeightmapTileBounds);
+    u32 overviewSize = overview.size() * sizeof(u16);
+    if (file.Read(bounds.data(), boundsSize) != boundsSize || file.Read(overview.data(), overviewSize) != overviewSize)
+    {
+        TYRA_WARN("Tiled heightmap ", path, " is truncated");
+        file.Close();
+        return;
+    }
+
+    heightScale = (header.maxHeight - header.minHeight) / HEIGHTMAP_FILE_MAX_VALUE;
+    inverseCellSizeX = 1.0F / header.cellSizeX;
+    inverseCellSizeZ = 1.0F / header.cellSizeZ;
+    tileCells = header.tileCells;
+    tileStride = tileCells + 1;
+
+    tileSlots.assign(header.tilesX * header.tilesZ, -1);
+    slots.resize(std::max(residentTiles, 1));
+    samples.reset(new u16[slots.size() * HeightmapTileSamples(tileCells)]);
+    // Update can't want more than fits, (2 * radius + 1)^2 <= slots
+    wanted.reserve(slots.size());
+    missing.reserve(slots.size());
+    requests.resize(slots.size());
+    finished.reserve(slots.size());
+
+    loaded = true;
+    loader = std::thread(&TiledHeightmap::Run, this);
+
+    TYRA_LOG("Tiled heightmap ", path, ": ", header.width, "x", header.height, ", ", header.tilesX * header.tilesZ,
+             " tiles, ", slots.size(), " resident");
+}
+
+TiledHeightmap::~TiledHeightmap()
+{
+    if (loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        requestAdded.notify_all();
+        loader.join();
+    }
+}
+
+void TiledHeightmap::Run()
+{
+    TRACE_THREAD("Heightmap tiles");
+    const u32 tileSize = HeightmapTileSamples(tileCells) * sizeof(u16);
+
+    while (true)
+    {
+        int slot;
+        int tile;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            requestAdded.wait(lock, [this] { return stopping || requestsCount > 0; });
+            if (stopping)
+            {
+                return;
+            }
+            slot = requests[requestsStart];
+            requestsStart = (requestsStart + 1) % requests.size();
+            requestsCount--;
+            tile = slots[slot].tile;
+        }
+
+        // nobody reads a slot while it's loading
+        TRACE_SCOPE_ARG("Load tile", tile);
+        u16* destination = samples.get() + slot * HeightmapTileSamples(tileCells);
+        u32 offset = HeightmapTiledTileOffset(header.tilesX, header.tilesZ, tileCells, tile);
+        if (!file.Seek(offset) || file.Read(destination, tileSize) != tileSize)
+        {
+            TYRA_WARN("Failed to read heightmap tile ", tile);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(slot);
+    }
+}
+
+void TiledHeightmap::Update(const Tyra::Vec4& position, int radius)
+{
+    if (!loaded)
+    {
+        return;
+    }
+
+    // hand out whatever the loader got done since last frame
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int slot : finished)
+        {
+            slots[slot].state = SlotState::Ready;
+        }
+        finished.clear();
+    }
+
+    frame++;
+    int cellX, cellZ;
+    float fracX, fracZ;
+    GetCellPosition(position, &cellX, &cellZ, &fracX, &fracZ);
+    int centerX = cellX / tileCells;
+    int centerZ = cellZ / tileCells;
+
+    // rings around the center, so the closest tiles get queued first
+    wanted.clear();
+    for (int ring = 0; ring <= radius; ring++)
+    {
+        for (int z = centerZ - ring; z <= centerZ + ring; z++)
+        {
+            for (int x = centerX - ring; x <= centerX + ring; x++)
+            {
+                bool onRing = std::abs(x - centerX) == ring || std::abs(z - centerZ) == ring;
+                if (!onRing || x < 0 || z < 0 || x >= static_cast<int>(header.tilesX) ||
+                    z >= static_cast<int>(header.tilesZ))
+                {
+                    continue;
+                }
+                wanted.push_back(z * header.tilesX + x);
+            }
+        }
+    }
+
+    // mark everything wanted first, so none of it gets evicted for the rest
+    missing.clear();
+    for (int tile : wanted)
+    {
+        if (tileSlots[tile] >= 0)
+        {
+            slots[tileSlots[tile]].lastWanted = frame;
+        }
+        else
+        {
+            missing.push_back(tile);
+        }
+    }
+
+    bool queued = false;
+    for (int tile : missing)
+    {
+        int slot = AcquireSlot();
+        if (slot < 0)
+        {
+            break;
+        }
+        slots[slot].state = SlotState::Loading;
+        slots[slot].tile = tile;
+        slots[slot].lastWanted = frame;
+        tileSlots[tile] = slot;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        requests[(requestsStart + requestsCount) % requests.size()] = slot;
+        requestsCount++;
+        queued = true;
+    }
+
+    if (queued)
+    {
+        requestAdded.notify_one();
+    }
+}
+
+int TiledHeightmap::AcquireSlot()
+{
+    int oldest = -1;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        if (slots[i].state == SlotState::Free)
+        {
+            return static_cast<int>(i);
+        }
+        // loading ones finish first, wanted ones stay
+        if (slots[i].state == SlotState::Ready && slots[i].lastWanted != frame &&
+            (oldest < 0 || slots[i].lastWanted < slots[oldest].lastWanted))
+        {
+            oldest = static_cast<int>(i);
+        }
+    }
+
+    if (oldest >= 0)
+    {
+        tileSlots[slots[oldest].tile] = -1;
+        slots[oldest].state = SlotState::Free;
+        slots[oldest].tile = -1;
+    }
+    return oldest;
+}
+
+bool TiledHeightmap::IsResident(const Tyra::Vec4& position) const
+{
+    if (!loaded)
+    {
+        return false;
+    }
+
+    int cellX, cellZ;
+    float fracX, fracZ;
+    GetCellPosition(position, &cellX, &cellZ, &fracX, &fracZ);
+    int slot = tileSlots[GetTile(cellX, cellZ)];
+    return slot >= 0 && slots[slot].state == SlotState::Ready;
+}
+
+bool TiledHeightmap::IsOutside(const Tyra::Vec4& position) const
+{
+    float right = header.originX + (header.width - 1) * header.cellSizeX;
+    float down = header.originZ + (header.height - 1) * header.cellSizeZ;
+    return position.x <= header.originX || position.x >= right || position.z <= header.originZ || position.z >= down;
+}
+
+int TiledHeightmap::GetTile(int cellX, int cellZ) const
+{
+    return (cellZ / tileCells) * header.tilesX + cellX / tileCells;
+}
+
+void TiledHeightmap::GetCellPosition(const Tyra::Vec4& position, int* cellX, int* cellZ, float* fracX, float* fracZ) const
+{
+    float gx = (position.x - header.originX) * inverseCellSizeX;
+    float gz = (position.z - header.originZ) * inverseCellSizeZ;
+    gx = std::min(std::max(gx, 0.0F), static_cast<float>(header.width - 1));
+    gz = std::min(std::max(gz, 0.0F), static_cast<float>(header.height - 1));
+
+    *cellX = std::min(static_cast<int>(gx), static_cast<int>(header.width) - 2);
+    *cellZ = std::min(static_cast<int>(gz), static_cast<int>(header.height) - 2);
+    *fracX = gx - *cellX;
+    *fracZ = gz - *cellZ;
+}
+
+float TiledHeightmap::GetOverviewHeight(int x, int z) const
+{
+    // bilinear over the tile corners. The last tile of a row or column can be
+    // short, its far corners are the map's last samples, not a whole tile on
+    int tileX = std::min(x / tileCells, static_cast<int>(header.tilesX) - 1);
+    int tileZ = std::min(z / tileCells, static_cast<int>(header.tilesZ) - 1);
+    int extentX = std::min(tileCells, static_cast<int>(header.width) - 1 - tileX * tileCells);
+    int extentZ = std::min(tileCells, static_cast<int>(header.height) - 1 - tileZ * tileCells);
+    float fx = static_cast<float>(x - tileX * tileCells) / extentX;
+    float fz = static_cast<float>(z - tileZ * tileCells) / extentZ;
+
+    const u16* corner = overview.data() + tileZ * (header.tilesX + 1) + tileX;
+    float top = corner[0] + (corner[1] - corner[0]) * fx;
+    float bottom = corner[header.tilesX + 1] + (corner[header.tilesX + 2] - corner[header.tilesX + 1]) * fx;
+    return header.minHeight + (top + (bottom - top) * fz) * heightScale;
+}
+
+void TiledHeightmap::GetCell(int x, int z, float* heights) const
+{
+    int slot = tileSlots[GetTile(x, z)];
+    if (slot < 0 || slots[slot].state != SlotState::Ready)
+    {
+        heights[0] = GetOverviewHeight(x, z);
+        heights[1] = GetOverviewHeight(x + 1, z);
+        heights[2] = GetOverviewHeight(x, z + 1);
+        heights[3] = GetOverviewHeight(x + 1, z + 1);
+        return;
+    }
+
+    // the cell's far samples are on the tile's shared edge at most
+    const u16* h = samples.get() + slot * HeightmapTileSamples(tileCells) + (z % tileCells) * tileStride + x % tileCells;
+    heights[0] = header.minHeight + h[0] * heightScale;
+    heights[1] = header.minHeight + h[1] * heightScale;
+    heights[2] = header.minHeight + h[tileStride] * heightScale;
+    heights[3] = header.minHeight + h[tileStride + 1] * heightScale;
+}
+
+float TiledHeightmap::SampleBilinear(const Tyra::Vec4& position) const
+{
+    if (!loaded)
+    {
+        return 0.0F;
+    }
+
+    int x, z;
+    float fx, fz;
+    GetCellPosition(position, &x, &z, &fx, &fz);
+
+    float h[4];
+    GetCell(x, z, h);
+    float top = h[0] + (h[1] - h[0]) * fx;
+    float bottom = h[2] + (h[3] - h[2]) * fx;
+    return top + (bottom - top) * fz;
+}
+
+float TiledHeightmap::SampleTriangle(const Tyra::Vec4& position) const
+{
+    if (!loaded)
+    {
+        return 0.0F;
+    }
+
+    int x, z;
+    float fx, fz;
+    GetCellPosition(position, &x, &z, &fx, &fz);
+
+    float h[4];
+    GetCell(x, z, h);
+    return fx >= fz ? h[0] + (h[1] - h[0]) * fx + (h[3] - h[1]) * fz
+                    : h[0] + (h[3] - h[2]) * fx + (h[2] - h[0]) * fz;
+}
+
+Tyra::Vec4 TiledHeightmap::ClosestPoint(const Tyra::Vec4& position, float maxDistance) const
+{
+    float surface = SampleTriangle(position);
+    if (position.y <= surface)
+    {
+        return position;
+    }
+
+    if (!loaded || IsOutside(position))
+    {
+        return Tyra::Vec4(position.x, surface, position.z);
+    }
+
+    // same as Heightmap::closestPoint, with the tile bounds for the early out
+    float gap = position.y - surface;
+    float radius = std::min(gap, maxDistance);
+
+    int x0, z0, x1, z1;
+    float fx, fz;
+    GetCellPosition(Tyra::Vec4(position.x - radius, 0.0F, position.z - radius), &x0, &z0, &fx, &fz);
+    GetCellPosition(Tyra::Vec4(position.x + radius, 0.0F, position.z + radius), &x1, &z1, &fx, &fz);
+
+    u16 top = 0;
+    for (int tz = z0 / tileCells; tz <= z1 / tileCells; tz++)
+    {
+        for (int tx = x0 / tileCells; tx <= x1 / tileCells; tx++)
+        {
+            top = std::max(top, bounds[tz * header.tilesX + tx].max);
+        }
+    }
+    float above = position.y - (header.minHeight + top * heightScale);
+    if (above > maxDistance)
+    {
+        return Tyra::Vec4(position.x, position.y - above, position.z);
+    }
+
+    int cellX, cellZ;
+    GetCellPosition(position, &cellX, &cellZ, &fx, &fz);
+    const int reach = 2;
+    x0 = std::max(x0, cellX - reach);
+    x1 = std::min(x1, cellX + reach);
+    z0 = std::max(z0, cellZ - reach);
+    z1 = std::min(z1, cellZ + reach);
+
+    Tyra::Vec4 best(position.x, surface, position.z);
+    float bestDistance = radius * radius;
+    for (int z = z0; z <= z1; z++)
+    {
+        float worldZ = header.originZ + z * header.cellSizeZ;
+        float outZ = std::max(std::max(worldZ - position.z, position.z - worldZ - header.cellSizeZ), 0.0F);
+        for (int x = x0; x <= x1; x++)
+        {
+            float worldX = header.originX + x * header.cellSizeX;
+            float outX = std::max(std::max(worldX - position.x, position.x - worldX - header.cellSizeX), 0.0F);
+
+            float h[4];
+            GetCell(x, z, h);
+            float outY = std::max(position.y - std::max(std::max(h[0], h[1]), std::max(h[2], h[3])), 0.0F);
+            if (outX * outX + outY * outY + outZ * outZ >= bestDistance)
+            {
+                continue;
+            }
+
+            Tyra::Vec4 v00(worldX, h[0], worldZ);
+            Tyra::Vec4 v10(worldX + header.cellSizeX, h[1], worldZ);
+            Tyra::Vec4 v01(worldX, h[2], worldZ + header.cellSizeZ);
+            Tyra::Vec4 v11(worldX + header.cellSizeX, h[3], worldZ + header.cellSizeZ);
+
+            Tyra::Vec4 candidates[2] = {closestPointOnTriangle(position, v00, v10, v11),
+                                        closestPointOnTriangle(position, v00, v11, v01)};
+            for (const auto& candidate : candidates)
+            {
+                Tyra::Vec4 offset = position - candidate;
+                float distance = offset.dot3(offset);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = candidate;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+TPE_Vec3 TiledHeightmap::EnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance) const
+{
+    const float toWorld = 1.0F / TPE_F;
+    Tyra::Vec4 closest = ClosestPoint(Tyra::Vec4(position.x * toWorld, position.y * toWorld, position.z * toWorld),
+                                      maxDistance * toWorld);
+    return TPE_vec3(std::lround(closest.x * TPE_F), std::lround(closest.y * TPE_F), std::lround(closest.z * TPE_F));
+}
+
+bool TiledHeightmap::Raycast(const Tyra::Vec4& origin, const Tyra::Vec4& direction, float maxDistance,
+                             HeightmapHit* hit) const
+{
+    return Cast(origin, direction, maxDistance, 0.0F, hit);
+}
+
+bool TiledHeightmap::SegmentCast(const Tyra::Vec4& from, const Tyra::Vec4& to, HeightmapHit* hit) const
+{
+    return SphereCast(from, to, 0.0F, hit);
+}
+
+bool TiledHeightmap::SphereCast(const Tyra::Vec4& from, const Tyra::Vec4& to, float radius, HeightmapHit* hit) const
+{
+    Tyra::Vec4 delta = to - from;
+    float length = delta.length();
+    if (length <= 0.0F)
+    {
+        return false;
+    }
+    return Cast(from, delta * (1.0F / length), length, radius, hit);
+}
+
+bool TiledHeightmap::Cast(const Tyra::Vec4& origin, const Tyra::Vec4& direction, float maxDistance, float radius,
+                          HeightmapHit* hit) const
+{
+    if (hit) hit->nodesVisited = 0;
+    if (!loaded)
+    {
+        return false;
+    }
+
+    // no infinities on the EE, a huge number slabs just as well
+    const float huge = 1e30F;
+    float inverseX = direction.x != 0.0F ? 1.0F / direction.x : huge;
+    float inverseY = direction.y != 0.0F ? 1.0F / direction.y : huge;
+    float inverseZ = direction.z != 0.0F ? 1.0F / direction.z : huge;
+    const int cellsX = header.width - 1;
+    const int cellsZ = header.height - 1;
+
+    float best = maxDistance;
+    bool found = false;
+    Tyra::Vec4 bestNormal;
+
+    // a bit over radius sideways, so a ray right on the edge between two
+    // cells or tiles takes both
+    float reach = radius + 1e-3F * std::min(header.cellSizeX, header.cellSizeZ);
+
+    // every tile the cast's box touches, in the order the cast heads through
+    // them so an early hit skips most of the rest
+    Tyra::Vec4 end = origin + direction * maxDistance;
+    int x0, z0, x1, z1;
+    float fx, fz;
+    GetCellPosition(Tyra::Vec4(std::min(origin.x, end.x) - reach, 0.0F, std::min(origin.z, end.z) - reach), &x0,
+                    &z0, &fx, &fz);
+    GetCellPosition(Tyra::Vec4(std::max(origin.x, end.x) + reach, 0.0F, std::max(origin.z, end.z) + reach), &x1,
+                    &z1, &fx, &fz);
+    int tileX0 = x0 / tileCells, tileX1 = x1 / tileCells, stepX = 1;
+    int tileZ0 = z0 / tileCells, tileZ1 = z1 / tileCells, stepZ = 1;
+    if (direction.x < 0.0F) std::swap(tileX0, tileX1), stepX = -1;
+    if (direction.z < 0.0F) std::swap(tileZ0, tileZ1), stepZ = -1;
+
+    auto CellX = [this](float x) { return static_cast<int>(std::floor((x - header.originX) * inverseCellSizeX)); };
+    auto CellZ = [this](float z) { return static_cast<int>(std::floor((z - header.originZ) * inverseCellSizeZ)); };
+    float horizontal = std::sqrt(direction.x * direction.x + direction.z * direction.z);
+    float cellStep = horizontal > 0.0F ? std::min(header.cellSizeX, header.cellSizeZ) / horizontal : huge;
+
+    for (int tz = tileZ0;; tz += stepZ)
+    {
+        for (int tx = tileX0;; tx += stepX)
+        {
+            // where the cast goes through the tile's box
+            int cellX0 = tx * tileCells, cellX1 = std::min(cellX0 + tileCells, cellsX);
+            int cellZ0 = tz * tileCells, cellZ1 = std::min(cellZ0 + tileCells, cellsZ);
+            const auto& tileBounds = bounds[tz * header.tilesX + tx];
+            float nearX = (header.originX + cellX0 * header.cellSizeX - reach - origin.x) * inverseX;
+            float farX = (header.originX + cellX1 * header.cellSizeX + reach - origin.x) * inverseX;
+            float nearY = (header.minHeight + tileBounds.min * heightScale - radius - origin.y) * inverseY;
+            float farY = (header.minHeight + tileBounds.max * heightScale + radius - origin.y) * inverseY;
+            float nearZ = (header.originZ + cellZ0 * header.cellSizeZ - reach - origin.z) * inverseZ;
+            float farZ = (header.originZ + cellZ1 * header.cellSizeZ + reach - origin.z) * inverseZ;
+            float in = std::max(std::max(std::min(nearX, farX), std::min(nearY, farY)), std::min(nearZ, farZ));
+            float out = std::min(std::min(std::max(nearX, farX), std::max(nearY, farY)), std::max(nearZ, farZ));
+            float entry = std::max(in, 0.0F);
+            float exit = std::min(out, best);
+
+            if (in <= out && entry <= exit)
+            {
+                if (hit) hit->nodesVisited++;
+
+                // a cell's worth of the cast at a time, against the cells the
+                // sphere can reach on that stretch
+                for (float a = entry;; a += cellStep)
+                {
+                    float b = std::min(a + cellStep, exit);
+                    Tyra::Vec4 p = origin + direction * a;
+                    Tyra::Vec4 q = origin + direction * b;
+                    int fromX = std::max(cellX0, CellX(std::min(p.x, q.x) - reach));
+                    int toX = std::min(cellX1 - 1, CellX(std::max(p.x, q.x) + reach));
+                    int fromZ = std::max(cellZ0, CellZ(std::min(p.z, q.z) - reach));
+                    int toZ = std::min(cellZ1 - 1, CellZ(std::max(p.z, q.z) + reach));
+
+                    for (int z = fromZ; z <= toZ; z++)
+                    {
+                        // corners come out the same from every cell sharing them
+                        float worldZ = header.originZ + z * header.cellSizeZ;
+                        float nextZ = header.originZ + (z + 1) * header.cellSizeZ;
+                        for (int x = fromX; x <= toX; x++)
+                        {
+                            if (hit) hit->nodesVisited++;
+                            float worldX = header.originX + x * header.cellSizeX;
+                            float nextX = header.originX + (x + 1) * header.cellSizeX;
+                            float h[4];
+                            GetCell(x, z, h);
+                            Tyra::Vec4 v00(worldX, h[0], worldZ);
+                            Tyra::Vec4 v10(nextX, h[1], worldZ);
+                            Tyra::Vec4 v01(worldX, h[2], nextZ);
+                            Tyra::Vec4 v11(nextX, h[3], nextZ);
+                            if (castCell(origin, direction, v00, v10, v01, v11, radius, &best, &bestNormal))
+                            {
+                                found = true;
+                            }
+                        }
+                    }
+
+                    // nothing further along can come before a hit in here
+                    if (b >= exit || (found && best <= b))
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if (tx == tileX1) break;
+        }
+        if (tz == tileZ1) break;
+    }
+
+    if (found && hit)
+    {
+        hit->distance = best;
+        hit->point = origin + direction * best;
+        hit->normal = bestNormal;
+    }
+    return found;
+}
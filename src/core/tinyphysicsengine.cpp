@@ -1,9 +1,25 @@
+#ifdef GWC_TRACE
+#include "core/trace.hpp"
+#define TPE_TRACE_BEGIN(name,arg) Trace::Begin(name,arg);
+#define TPE_TRACE_END Trace::End();
+#endif
+
 #include "core/tinyphysicsengine.hpp"
 
 #include <tyra>
 
 int _TPE_body1Index, _TPE_body2Index, _TPE_joint1Index, _TPE_joint2Index;
 TPE_CollisionCallback _TPE_collisionCallback;
+TPE_WorldStats *_TPE_stats;
+TPE_ClosestPointFunction _TPE_statsEnvironmentFunction;
+
+#define _TPE_COUNT(counter) do { if (_TPE_stats != 0) _TPE_stats->counter++; } while (0)
+
+TPE_Vec3 _TPE_countedEnvironmentFunction(TPE_Vec3 point, TPE_Unit maxDistance)
+{
+  _TPE_stats->environmentCalls++;
+  return _TPE_statsEnvironmentFunction(point,maxDistance);
+}
 
 TPE_Unit TPE_nonZero(TPE_Unit x)
 {
@@ -194,6 +210,7 @@ void TPE_worldInit(TPE_World *world, TPE_Body *bodies, uint16_t bodyCount,
   world->bodyCount = bodyCount;
   world->environmentFunction = environmentFunction;
   world->collisionCallback = 0;
+  world->stats = 0;
 }
   
 #define C(n,a,b) connections[n].joint1 = a; connections[n].joint2 = b;
@@ -288,16 +305,110 @@ void TPE_bodyDeactivate(TPE_Body *body)
   body->flags |= TPE_BODY_FLAG_DEACTIVATED;
 }
 
+/** Moves a joint by its velocity like the integration in TPE_worldStep does,
+  but for fast joints without passing through the environment. Like the
+  outside rays of TPE_castEnvironmentRay it marches in steps as long as the
+  distance to the environment, nothing can be closer so nothing can be
+  crossed. It stops once the joint itself (not only its center) is about
+  touching a surface and leaves the rest to the environment collision
+  resolution, so a joint never ends up past the middle of something thinner
+  than itself and gets pushed out the far side. */
+void _TPE_jointSweep(TPE_Joint *joint, TPE_ClosestPointFunction env)
+{
+  TPE_Vec3 move = 
+    TPE_vec3(joint->velocity[0],joint->velocity[1],joint->velocity[2]);
+
+  TPE_Unit length = TPE_LENGTH(move);
+
+  if (env == 0 || length <= TPE_JOINT_SIZE(*joint))
+  {
+    // too slow to get through anything the joint wouldn't also touch
+    joint->position = TPE_vec3Plus(joint->position,move);
+    return;
+  }
+
+  _TPE_COUNT(jointsSwept);
+
+  TPE_Vec3 start = joint->position, p = start;
+  TPE_Unit travelled = 0, size = TPE_JOINT_SIZE(*joint);
+  TPE_Vec3 direction = TPE_vec3Normalized(move);
+
+  for (uint8_t i = 0; i < TPE_CCD_MAX_STEPS; ++i)
+  {
+    TPE_Unit remaining = length - travelled;
+    TPE_Vec3 closest = env(p,remaining);
+    TPE_Unit d = TPE_DISTANCE(p,closest); // 0 if p is inside
+
+    if (d >= remaining)
+    {
+      travelled = length;
+      break;
+    }
+
+    if (d <= TPE_COLLISION_RESOLUTION_MARGIN)
+      break;
+
+    TPE_Unit step = d - size;
+
+    if (step <= TPE_COLLISION_RESOLUTION_MARGIN)
+    {
+      /* Already touching. Sliding along is fine as long as the center can't
+         cross anything (steps of d) and doesn't sink more than half the joint
+         into what it touches, heading into it is left to the resolution. */
+      if (TPE_vec3Dot(direction,TPE_vec3Minus(closest,p)) > d - size / 2)
+        break;
+
+      step = d;
+    }
+
+    travelled += step;
+
+    // no overflow, velocities are 16 bit and travelled <= length
+    p = TPE_vec3Plus(start,TPE_vec3(
+      (move.x * travelled) / length,
+      (move.y * travelled) / length,
+      (move.z * travelled) / length));
+  }
+
+  joint->position = travelled == length ? TPE_vec3Plus(start,move) : p;
+}
+
 void TPE_worldStep(TPE_World *world)
 {
   _TPE_collisionCallback = world->collisionCallback;
 
+  TPE_ClosestPointFunction environmentFunction = world->environmentFunction;
+
+  _TPE_stats = world->stats;
+
+  if (_TPE_stats != 0)
+  {
+    TPE_WorldStats empty = {0};
+    *_TPE_stats = empty;
+
+    if (environmentFunction != 0)
+    {
+      // count the queries by going through a wrapper for this step
+      _TPE_statsEnvironmentFunction = environmentFunction;
+      world->environmentFunction = _TPE_countedEnvironmentFunction;
+    }
+  }
+
   for (uint16_t i = 0; i < world->bodyCount; ++i)
   {
     TPE_Body *body = world->bodies + i;   
 
-    if (body->flags & (TPE_BODY_FLAG_DEACTIVATED | TPE_BODY_FLAG_DISABLED))
+    if (body->flags & TPE_BODY_FLAG_DISABLED)
+      continue;
+
+    if (body->flags & TPE_BODY_FLAG_DEACTIVATED)
+    {
+      _TPE_COUNT(bodiesAsleep);
       continue; 
+    }
+
+    _TPE_COUNT(bodiesActive);
+    TPE_TRACE_BEGIN("Body",i)
 
     TPE_Joint *joint = body->joints, *joint2;
 
@@ -311,9 +422,14 @@ void TPE_worldStep(TPE_World *world)
         for (uint8_t k = 0; k < 3; ++k)
           joint->velocity[k] = body->joints[0].velocity[k];
 
-      joint->position.x += joint->velocity[0];
-      joint->position.y += joint->velocity[1];
-      joint->position.z += joint->velocity[2];
+      if (body->flags & TPE_BODY_FLAG_CCD)
+        _TPE_jointSweep(joint,world->environmentFunction);
+      else
+      {
+        joint->position.x += joint->velocity[0];
+        joint->position.y += joint->velocity[1];
+        joint->position.z += joint->velocity[2];
+      }
 
       joint++;
     }
@@ -328,8 +444,10 @@ void TPE_worldStep(TPE_World *world)
   
     _TPE_body2Index = _TPE_body1Index;
 
+    TPE_TRACE_BEGIN("Environment",i)
     uint8_t collided =    
       TPE_bodyEnvironmentResolveCollision(body,world->environmentFunction);
+    TPE_TRACE_END
 
     if (body->flags & TPE_BODY_FLAG_NONROTATING)
     {
@@ -413,12 +531,16 @@ void TPE_worldStep(TPE_World *world)
         if (hard)
         {
           TPE_bodyReshape(body,world->environmentFunction);
+          _TPE_COUNT(reshapePasses);
 
           bodyTension /= body->connectionCount;
         
           if (bodyTension > TPE_RESHAPE_TENSION_LIMIT)
             for (uint8_t k = 0; k < TPE_RESHAPE_ITERATIONS; ++k)
+            {
               TPE_bodyReshape(body,world->environmentFunction);
+              _TPE_COUNT(reshapePasses);
+            }
         }
         
         if (!(body->flags & TPE_BODY_FLAG_SIMPLE_CONN))  
@@ -426,6 +548,7 @@ void TPE_worldStep(TPE_World *world)
       }
     }
 
+    TPE_TRACE_BEGIN("Pairs",i)
     for (uint16_t j = 0; j < world->bodyCount; ++j)
     {
       if (j > i || (world->bodies[j].flags & TPE_BODY_FLAG_DEACTIVATED))
@@ -437,8 +560,15 @@ void TPE_worldStep(TPE_World *world)
 
         _TPE_body2Index = j;
 
-        if (TPE_checkOverlapAABB(aabbMin,aabbMax,aabbMin2,aabbMax2) &&
-          TPE_bodiesResolveCollision(body,world->bodies + j,
+        _TPE_COUNT(bodyPairsTested);
+
+        uint8_t overlap =
+          TPE_checkOverlapAABB(aabbMin,aabbMax,aabbMin2,aabbMax2);
+
+        if (overlap)
+          _TPE_COUNT(bodyPairsOverlapping);
+
+        if (overlap && TPE_bodiesResolveCollision(body,world->bodies + j,
           world->environmentFunction))
         {
           TPE_bodyActivate(body);
@@ -449,6 +579,7 @@ void TPE_worldStep(TPE_World *world)
         }
       }
     }
+    TPE_TRACE_END
 
     if (!(body->flags & TPE_BODY_FLAG_ALWAYS_ACTIVE))
     {
@@ -463,6 +594,14 @@ void TPE_worldStep(TPE_World *world)
       else
         body->deactivateCount = 0;
     }
+
+    TPE_TRACE_END
+  }
+
+  if (_TPE_stats != 0)
+  {
+    world->environmentFunction = environmentFunction;
+    _TPE_stats = 0;
   }
 }
 
@@ -930,6 +1069,8 @@ uint8_t TPE_bodiesResolveCollision(TPE_Body *b1, TPE_Body *b2,
       _TPE_joint1Index = i;
       _TPE_joint2Index = j;
 
+      _TPE_COUNT(jointTests);
+
       if (TPE_jointsResolveCollision(&(b1->joints[i]),&(b2->joints[j]),
         b1->jointMass,b2->jointMass,(b1->elasticity + b2->elasticity) / 2,
         (b1->friction + b2->friction) / 2,env))
@@ -1126,6 +1267,8 @@ uint8_t TPE_jointEnvironmentResolveCollision(TPE_Joint *joint,
 
       for (int i = 0; i < TPE_COLLISION_RESOLUTION_ITERATIONS; ++i)
       {
+        _TPE_COUNT(collisionIterations);
+
         shift = toJoint;
 
         TPE_vec3Normalize(&shift); 
@@ -1158,6 +1301,8 @@ uint8_t TPE_jointEnvironmentResolveCollision(TPE_Joint *joint,
       
       for (int i = 0; i < TPE_COLLISION_RESOLUTION_ITERATIONS; ++i)
       {
+        _TPE_COUNT(collisionIterations);
+
         joint->position = TPE_vec3Plus(joint->position,shift);
 
         toJoint = TPE_vec3Minus(joint->position,
@@ -1198,6 +1343,7 @@ uint8_t TPE_jointEnvironmentResolveCollision(TPE_Joint *joint,
     else
     {
       TPE_LOG("WARNING: joint-environment collision couldn't be resolved");
+      _TPE_COUNT(unresolvedCollisions);
 
       joint->position = positionBackup;
       joint->velocity[0] = 0;
@@ -2358,12 +2504,17 @@ uint32_t TPE_worldHash(const TPE_World *world)
 {
   uint32_t r = 0;
 
-  for (uint8_t i = 0; i < world->bodyCount; ++i)
-    r = _TPE_hash(r ^ TPE_bodyHash(&world->bodies[i]));
+  for (uint16_t i = 0; i < world->bodyCount; ++i)
+    r = TPE_worldHashAdd(r,TPE_bodyHash(&world->bodies[i]));
 
   return r;
 }
 
+uint32_t TPE_worldHashAdd(uint32_t worldHash, uint32_t bodyHash)
+{
+  return _TPE_hash(worldHash ^ bodyHash);
+}
+
 void TPE_bodyMoveTo(TPE_Body *body, TPE_Vec3 position)
 {
   position = TPE_vec3Minus(position,TPE_bodyGetCenterOfMass(body));
@@ -0,0 +1,95 @@
+#include "core/trace.hpp"
+
+#ifdef GWC_TRACE
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+std::string exitPath;
+
+void WriteExitTrace()
+{
+    Trace::Write(exitPath);
+}
+
+}
+
+const std::chrono::steady_clock::time_point Trace::start = std::chrono::steady_clock::now();
+std::mutex Trace::buffersMutex;
+std::vector<Trace::ThreadBuffer*>* Trace::buffers = new std::vector<Trace::ThreadBuffer*>();
+
+Trace::ThreadBuffer* Trace::AddBuffer()
+{
+    auto* buffer = new ThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffers->push_back(buffer);
+    buffer->id = static_cast<int>(buffers->size());
+    return buffer;
+}
+
+bool Trace::Write(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        TYRA_LOG("Trace: can't write ", path);
+        return false;
+    }
+
+    std::vector<ThreadBuffer*> threads;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        threads = *buffers;
+    }
+
+    // one event per line, the viewers don't mind a trailing metadata event
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    u32 total = 0, dropped = 0;
+    for (const auto* thread : threads)
+    {
+        u32 count = thread->count.load(std::memory_order_acquire);
+        for (u32 i = 0; i < count; i++)
+        {
+            const Event& event = thread->events[i];
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", event.name, thread->id,
+                    event.start / 1000.0, event.duration / 1000.0);
+            if (event.arg >= 0)
+            {
+                fprintf(file, ",\"args\":{\"arg\":%d}", event.arg);
+            }
+            fprintf(file, "},\n");
+        }
+        total += count;
+        dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+    for (const auto* thread : threads)
+    {
+        const char* name = thread->name.load();
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", thread->id,
+                name ? name : "Thread");
+    }
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"gwc\"}}\n]}\n");
+    bool written = !ferror(file);
+    fclose(file);
+
+    TYRA_LOG("Trace: ", total, " events from ", threads.size(), " threads written to ", path);
+    if (dropped > 0)
+    {
+        TYRA_LOG("Trace: ", dropped, " events didn't fit in TRACE_EVENTS_PER_THREAD and were dropped");
+    }
+    return written;
+}
+
+void Trace::WriteAtExit(const std::string& path)
+{
+    bool registered = !exitPath.empty();
+    exitPath = path;
+    if (!registered)
+    {
+        atexit(WriteExitTrace);
+    }
+}
+
+#endif
@@ -1,7 +1,11 @@
 
 #include "core/world.hpp"
+#include <cstring>
 #include <sstream>
 
+#include "core/profiler.hpp"
+#include "core/determinism_log.hpp"
+
 #include "levels/level01.hpp"
 
 World* World::world;
@@ -10,7 +14,7 @@ int collisionCallback(int b1, int j1, int b2, int j2, TPE_Vec3 p)
 {
     if (b1 == b2)
     {
-        World::GetWorld()->AddEnvironmentCollision(j1);
+        World::GetWorld()->AddEnvironmentCollision(b1, j1);
     }
     return 1;
 }
@@ -46,31 +50,43 @@ World::~World()
 
 void World::Setup()
 {
-    tpeBodies = new TPE_Body[10];
-    tpeJoints = new TPE_Joint[128];
-    tpeConnections = new TPE_Connection[256];
+    tpeBodies = new TPE_Body[WORLD_MAX_BODIES];
+    tpeJoints = new TPE_Joint[WORLD_MAX_JOINTS];
+    tpeConnections = new TPE_Connection[WORLD_MAX_CONNECTIONS];
     TPE_worldInit(&tpeWorld,tpeBodies,0,0);
     tpeWorld.environmentFunction = environmentDistance;
     tpeWorld.collisionCallback = collisionCallback;
+#ifdef GWC_PROFILE
+    // counting costs a branch in TPE's inner loops, only pay for it when
+    // something reads the counts
+    tpeWorld.stats = &physicsStats;
+#endif
 }
 
 void World::SetLevel(Level* level)
 {
+    TRACE_SCOPE("SetLevel");
     TYRA_ASSERT(this->level == nullptr, "Current level is not null");
     AddChild(level);
     this->level = level;
+    level->FinishLoading();
+    if (DeterminismLog::GetLog())
+    {
+        DeterminismLog::GetLog()->StartSegment();
+    }
 }
 
 void World::ClearLevel()
 {
+    TRACE_SCOPE("ClearLevel");
     TYRA_ASSERT(this->level != nullptr, "Current level is null");
 
     DeleteChildById(this->level->GetChildID());
 
     usedJoints = 0;
     usedConnections = 0;
-    envCollisions.clear();
-    lastEnvCollisions.clear();
+    memset(envCollisions, 0, sizeof(envCollisions));
+    memset(lastEnvCollisions, 0, sizeof(lastEnvCollisions));
 
     delete[] tpeConnections;
     delete[] tpeJoints;
@@ -83,6 +99,7 @@ void World::ClearLevel()
 
 void World::Update()
 {
+    PROFILE_SCOPE("World");
     for (const auto& child : *level->GetChildren()) // YUCK
     {
         PhysicsComponent* pc = dynamic_cast<PhysicsComponent*>(child->GetComponentByObjectName("Physics"));
@@ -91,9 +108,27 @@ void World::Update()
             child->PhysicsUpdate();
         }
     }
-    envCollisions.clear();
-    TPE_worldStep(&tpeWorld);
-    lastEnvCollisions = envCollisions;
+    memset(envCollisions, 0, sizeof(envCollisions));
+    {
+        PROFILE_SCOPE("Physics");
+        TPE_worldStep(&tpeWorld);
+    }
+    if (DeterminismLog::GetLog())
+    {
+        DeterminismLog::GetLog()->Record(&tpeWorld);
+    }
+    memcpy(lastEnvCollisions, envCollisions, sizeof(envCollisions));
+
+    PROFILE_COUNT("Env calls", 50, physicsStats.environmentCalls);
+    PROFILE_COUNT("Collision iterations", 5, physicsStats.collisionIterations);
+    PROFILE_COUNT("Unresolved", 1, physicsStats.unresolvedCollisions);
+    PROFILE_COUNT("Reshape passes", 1, physicsStats.reshapePasses);
+    PROFILE_COUNT("Pairs tested", 1, physicsStats.bodyPairsTested);
+    PROFILE_COUNT("Pairs overlapping", 1, physicsStats.bodyPairsOverlapping);
+    PROFILE_COUNT("Joint tests", 10, physicsStats.jointTests);
+    PROFILE_COUNT("Joints swept", 1, physicsStats.jointsSwept);
+    PROFILE_COUNT("Bodies active", 1, physicsStats.bodiesActive);
+    PROFILE_COUNT("Bodies asleep", 1, physicsStats.bodiesAsleep);
 }
 
 TPE_Body* World::InitBody(int bodyJoints, int bodyConnections, int bodyMass)
@@ -129,22 +164,20 @@ Level* World::GetLevel()
     return level;
 }
 
-void World::AddEnvironmentCollision(int jointIndex)
+void World::AddEnvironmentCollision(int bodyIndex, int jointIndex)
 {
-    envCollisions.insert(&tpeJoints[jointIndex]);
+    // TPE gives the joint's index in its body, not in tpeJoints
+    envCollisions[tpeWorld.bodies[bodyIndex].joints + jointIndex - tpeJoints] = true;
 }
 
 void World::RemoveEnvironmentCollision(TPE_Joint* joint)
 {
-    if (envCollisions.count(joint))
-    {
-        envCollisions.erase(joint);
-    }
+    envCollisions[joint - tpeJoints] = false;
 }
 
 bool World::GetEnvironmentCollision(TPE_Joint* joint)
 {
-    return envCollisions.count(joint) || lastEnvCollisions.count(joint);
+    return envCollisions[joint - tpeJoints] || lastEnvCollisions[joint - tpeJoints];
 }
 
 TPE_Vec3 World::GetLevelEnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance)
@@ -1,4 +1,6 @@
 #include "gwc.hpp"
+#include <cmath>
+#include <cstdlib>
 
 namespace Tyra {
 
@@ -28,51 +30,126 @@ void GameWithCar::StartGame()
     shouldStartGame = true;
 }
 
+void GameWithCar::SetDeterministic(unsigned seed_)
+{
+    deterministic = true;
+    seed = seed_;
+    synchronousLoading = true;
+}
+
 void GameWithCar::init()
 {
+    TRACE_THREAD("Main");
+    if (deterministic)
+    {
+        srand(seed);
+    }
+    GameClock::SetClock(&clock);
     cameraPosition = Vec4(0.0F, 10.0F, -10.0F);
 
+    // optional, without it everything is read from loose files
+    assetArchive = AssetArchive::Open(Helper::fromCwd(ARCHIVE_FILE_NAME));
+    AssetArchive::SetArchive(assetArchive.get());
+
+    assetLoader = std::make_unique<AssetLoader>(!synchronousLoading);
+    AssetLoader::SetAssetLoader(assetLoader.get());
+
+    music = std::make_unique<SongStream>();
+    SongStream::SetSongStream(music.get());
+
+    assetCache = std::make_unique<AssetCache>(engine);
+    AssetCache::SetAssetCache(assetCache.get());
+
     world = std::make_unique<World>(engine);
     World::SetWorld(world.get());
 
+#ifdef GWC_PROFILE
+    profilerOverlay = std::make_unique<ProfilerOverlay>(engine);
+#endif
+
     LevelStudio* loading = new LevelStudio(engine);
     world->SetLevel(loading);
 }
 
 void GameWithCar::loop()
+{
+    clock.Tick();
+    {
+        PROFILE_SCOPE("Loop");
+        Loop();
+    }
+    PROFILE_FRAME();
+}
+
+void GameWithCar::Loop()
 {
     cameraLookAt = Camera::GetCamera()->GetTargetLookAt();
-    cameraPosition.lerp(cameraPosition, Camera::GetCamera()->GetWorldPosition(), 0.1f);
+    // the same follow at any framerate
+    float follow = 1.0f - std::pow(1.0f - CAMERA_FOLLOW, clock.GetDelta() * CAMERA_FOLLOW_RATE);
+    cameraPosition.lerp(cameraPosition, Camera::GetCamera()->GetWorldPosition(), follow);
+    {
+        PROFILE_SCOPE("Music");
+        music->Update();
+    }
     world->_update();
+#ifdef GWC_PROFILE
+    profilerOverlay->_update();
+#endif
     engine->renderer.beginFrame(CameraInfo3D(&cameraPosition, &cameraLookAt));
     {
         world->_render();
+#ifdef GWC_PROFILE
+        profilerOverlay->_render();
+#endif
+    }
+    {
+        PROFILE_SCOPE("EndFrame");
+        engine->renderer.endFrame();
     }
-    engine->renderer.endFrame();
 
-    if (shouldStartMenu)
+    // the current level keeps running until the next one is parsed, so the
+    // switch itself only has to upload textures and build the meshes
+    if (shouldStartMenu && AssetsReady(LevelMenu::GetManifest()))
     {
+        TRACE_SCOPE("Level switch");
+        u32 start = GameClock::GetTicks();
         shouldStartMenu = false;
-        if (engine->audio.song.isPlaying())
-        {
-            engine->audio.song.stop();
-        }
+        music->Stop();
         world->ClearLevel();
         LevelMenu* menu = new LevelMenu(engine);
         world->SetLevel(menu);
+        assetLoader->Release(LevelMenu::GetManifest());
+        LogLevelSwitch(start);
     }
 
-    if (shouldStartGame)
+    if (shouldStartGame && AssetsReady(Level01::GetManifest()))
     {
-        if (engine->audio.song.isPlaying())
-        {
-            engine->audio.song.stop();
-        }
+        TRACE_SCOPE("Level switch");
+        u32 start = GameClock::GetTicks();
+        music->Stop();
         shouldStartGame = false;
         world->ClearLevel();
         Level01* game = new Level01(engine);
         world->SetLevel(game);
+        assetLoader->Release(Level01::GetManifest());
+        LogLevelSwitch(start);
     }
 }
 
+bool GameWithCar::AssetsReady(const AssetManifest& manifest)
+{
+    // waiting for a level and switching to it both count as loading
+    PROFILE_UNSTEADY();
+
+    // it's wanted right now, jump ahead of anything else still queued
+    assetLoader->Prefetch(manifest, 1);
+    return assetLoader->IsResident(manifest);
+}
+
+void GameWithCar::LogLevelSwitch(u32 startTicks)
+{
+    float elapsed = GameClock::TicksToSeconds(GameClock::GetTicks() - startTicks);
+    TYRA_LOG("Level switch took ", static_cast<int>(elapsed * 1000.0f), "ms");
+}
+
 }
@@ -1,4 +1,6 @@
 #include "levels/level01.hpp"
+#include "gwc.hpp"
+#include "core/trace.hpp"
 
 // Level01::Level01(Tyra::Engine* engine)
 //      : Level("level01/level.obj", "level01/textures/", "level01/heightmap.png", Tyra::ObjLoaderOptions{}, 0.0F, 200.0F, Vec4(-454.7F, 0.0F, -326.2F, 1.0F), Vec4(392.8F, 0.0F, 326.8F, 1.0F), engine)
@@ -9,32 +11,73 @@
 Level01::Level01(Tyra::Engine* engine)
     : Level("level01/", "level01/level.obj", "level01/txtrs/", "level01/hmap.png", Tyra::ObjLoaderOptions{}, engine)
 {
+    // a tiled one streams around the car, the whole one is loaded up front
+    tiledHeightmap = std::make_unique<TiledHeightmap>("level01/heightmap" HEIGHTMAP_TILED_EXTENSION);
+    if (!tiledHeightmap->IsLoaded())
+    {
+        tiledHeightmap.reset();
+        // bounds of the old commented out constructor above
+        heightmap = std::make_unique<Heightmap>("level01/heightmap" HEIGHTMAP_FILE_EXTENSION, Vec4(-454.7F, 0.0F, -326.2F, 1.0F), Vec4(392.8F, 0.0F, 326.8F, 1.0F));
+        if (!heightmap->isLoaded())
+        {
+            // the car would drive through every hill, don't let that ship.
+            // Off the console (host builds without res/) flat ground will do
+#ifdef _EE
+            TYRA_ASSERT(false, "Level01 has no heightmap, bake it with make -C tools heightmaps");
+#endif
+            TYRA_WARN("Level01 has no heightmap, the ground is flat at 0");
+        }
+    }
+
     Setup();
 }
 
-void Level01::Setup()
+AssetManifest Level01::GetManifest()
 {
-    StaticMeshComponent* trees = new StaticMeshComponent("level01/trees.obj", "level01/txtrs", Tyra::ObjLoaderOptions{});
-    AddComponent(trees);
+    // has to be kept in sync with what the level and its objects load
+    Tyra::ObjLoaderOptions carOptions;
+    carOptions.scale = 1.0F;
+    carOptions.flipUVs = true;
+
+    AssetManifest manifest;
+    manifest.AddMesh("level01/level.obj", Tyra::ObjLoaderOptions{});
+    manifest.AddMesh("level01/trees.obj", Tyra::ObjLoaderOptions{});
+    manifest.AddMesh("level01/road.obj", Tyra::ObjLoaderOptions{});
+    manifest.AddMesh("car/Body.obj", carOptions);
+    manifest.AddMesh("car/Wheel.obj", carOptions);
+    return manifest;
+}
 
-    StaticMeshComponent* road = new StaticMeshComponent("level01/road.obj", "level01/txtrs", Tyra::ObjLoaderOptions{});
-    AddComponent(road);
+void Level01::Setup()
+{
+    TRACE_SCOPE("Level setup");
+    GetStaticBatch()->AddMesh("level01/trees.obj", "level01/txtrs", Tyra::ObjLoaderOptions{});
+    GetStaticBatch()->AddMesh("level01/road.obj", "level01/txtrs", Tyra::ObjLoaderOptions{});
 
     GetEngine()->renderer.setClearScreenColor(Tyra::Color(203.f, 239.f, 245.f));
-    Car* car = new Car(engine);
+    car = new Car(engine);
     AddChild(car);
+    if (tiledHeightmap)
+    {
+        tiledHeightmap->Update(car->GetWorldPosition());
+    }
 
     std::stringstream ss;
-    ss << "music/mus" << (rand() % 12) + 1 << ".wav";
-    engine->audio.song.load(Helper::fromCwd(ss.str()));
-    engine->audio.song.inLoop = true;
-    engine->audio.song.setVolume(70);
-    engine->audio.song.play();
+    int song = Tyra::GameWithCar::GetGWC()->IsDeterministic() ? 1 : (rand() % 12) + 1;
+    ss << "music/mus" << song << ".wav";
+    auto* music = SongStream::GetSongStream();
+    music->Load(ss.str());
+    music->SetLoop(true);
+    music->SetVolume(70);
+    music->Play();
 }
 
 void Level01::Update()
 {
-    
+    if (tiledHeightmap)
+    {
+        tiledHeightmap->Update(car->GetWorldPosition());
+    }
 }
 
 void Level01::Render()
@@ -45,6 +88,10 @@ void Level01::Render()
 
 TPE_Vec3 Level01::EnvironmentDistance(TPE_Vec3 position, TPE_Unit maxDistance)
 {
-    return TPE_envGround(position, 0);
-    // return TPE_envHeightmap(position, TPE_vec3(0, 0, 0), TPE_F, height, maxDistance);
+    if (tiledHeightmap)
+    {
+        return tiledHeightmap->EnvironmentDistance(position, maxDistance);
+    }
+    // flat ground at 0 if the heightmap didn't load, only off the console
+    return heightmap->environmentDistance(position, maxDistance);
 }
\ No newline at end of file
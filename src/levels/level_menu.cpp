@@ -7,11 +7,39 @@ LevelMenu::LevelMenu(Tyra::Engine* engine)
     Setup();
 }
 
+AssetManifest LevelMenu::GetManifest()
+{
+    // has to be kept in sync with what the level and its objects load
+    Tyra::ObjLoaderOptions propOptions;
+    propOptions.scale = 1.0F;
+    propOptions.flipUVs = true;
+
+    AssetManifest manifest;
+    manifest.AddMesh("menu/menu.obj", Tyra::ObjLoaderOptions{});
+    manifest.AddMesh("tree/Tree.obj", propOptions);
+    manifest.AddMesh("car/Body.obj", propOptions);
+    manifest.AddMesh("car/Wheel.obj", propOptions);
+    return manifest;
+}
+
 void LevelMenu::Setup()
 {
+    TRACE_SCOPE("Level setup");
     GetEngine()->renderer.setClearScreenColor(Tyra::Color(203.f, 239.f, 245.f));
 
-    Tree* tree = new Tree(engine);
+    // every tree is an instance of this one, it lives on the level so it
+    // outlives the trees (children are deleted before components)
+    Tyra::ObjLoaderOptions treeOptions;
+    treeOptions.scale = 1.f;
+    treeOptions.flipUVs = true;
+    InstancedMeshComponent* forest = new InstancedMeshComponent("tree/Tree.obj", "tree/", treeOptions);
+    forest->AddGeneratedLod(60.f, 16);
+    forest->AddGeneratedLod(120.f, 6);
+    forest->SetBoundingRadius(8.f);
+    forest->SetCullDistance(250.f);
+    AddComponent(forest);
+
+    Tree* tree = new Tree(engine, forest);
     tree->MoveObjectWorld(Tyra::Vec4(-10.f, 0, 0));
     AddChild(tree);
 
@@ -46,15 +74,24 @@ void LevelMenu::Setup()
     AddComponent(play);
 
 
-    engine->audio.song.load(Helper::fromCwd("music/menu.wav"));
-    engine->audio.song.inLoop = true;
-    engine->audio.song.setVolume(90); // for funnies im gonna make main menu way louder than the game song :)
-    engine->audio.song.play();
+    auto* music = SongStream::GetSongStream();
+    music->Load("music/menu.wav");
+    music->SetLoop(true);
+    music->SetVolume(90); // for funnies im gonna make main menu way louder than the game song :)
+    music->Play();
 
 }
 
 void LevelMenu::Update()
 {
+    // the game is the only place to go from here, get it parsed while the menu
+    // is up. Not in Setup, the menu assets shared with it are released after that
+    if (!prefetched)
+    {
+        prefetched = true;
+        AssetLoader::GetAssetLoader()->Prefetch(Level01::GetManifest(), 0);
+    }
+
     if (engine->pad.getClicked().Cross)
     {
         Tyra::GameWithCar::GetGWC()->StartGame();
@@ -15,6 +15,7 @@ LevelStudio::~LevelStudio()
 
 void LevelStudio::Setup()
 {
+    TRACE_SCOPE("Level setup");
     GetEngine()->renderer.setClearScreenColor(Tyra::Color(255.f, 255.f, 255.f)); 
 
     Camera* camera = new Camera(engine);
@@ -30,16 +31,22 @@ void LevelStudio::Setup()
                                                 Tyra::Vec2(128.f, 128.f));
     AddComponent(studio);
 
+    // the splash is mostly here to hide the menu loading
+    AssetLoader::GetAssetLoader()->Prefetch(LevelMenu::GetManifest(), 0);
+
     sound = engine->audio.adpcm.load(Helper::fromCwd("ui/studio.adp"));
     engine->audio.adpcm.tryPlay(sound, 3);
 }
 
 void LevelStudio::Update()
 {
-    counter++;
-    if (counter > 50 * 3)
+    if (shown > LEVEL_STUDIO_SPLASH_TIME)
+    {
+        return; // the menu is already on its way
+    }
+    shown += GetClock()->GetDelta();
+    if (shown > LEVEL_STUDIO_SPLASH_TIME)
     {
-        counter = -100000; // prevent it from loading multiple times
         Tyra::GameWithCar::GetGWC()->StartMenu();
     }
 }
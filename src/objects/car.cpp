@@ -1,7 +1,9 @@
 #include "objects/car.hpp"
+#include "core/profiler.hpp"
 
-Car::Car(Tyra::Engine* engine)
-  : GameObject("Car", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0f, 0.0f, 0.0f), engine)
+Car::Car(Tyra::Engine* engine, CarModel model)
+  : GameObject("Car", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0f, 0.0f, 0.0f), engine),
+  model(model)
 {
     Setup();
 }
@@ -25,41 +27,55 @@ void Car::Setup()
 
     this->staticMeshComponent = staticMeshComponent;
 
-    auto body = World::GetWorld()->MakeCenterRectFull(1000, 1800, 400, 2000);
-    PhysicsComponent* physicsComponent = new PhysicsComponent(body);
-    AddComponent(physicsComponent);
+    if (model == CarModel::Raycast)
+    {
+        vehicle = std::make_unique<RaycastVehicle>(RaycastVehicleSetup::ForCar());
+        vehicle->MoveBy(TPE_vec3(0, 100000.f, 0));
+        physicsComponent = new PhysicsComponent(vehicle.get());
+        AddComponent(physicsComponent);
+    }
+    else
+    {
+        auto body = World::GetWorld()->MakeCenterRectFull(1000, 1800, 400, 2000);
+        physicsComponent = new PhysicsComponent(body);
+        AddComponent(physicsComponent);
 
-    this->physicsComponent = physicsComponent;
+        // prob should add a way to do this from the PhysicsComponent class, but i am really low on time
+        body->joints[4].position.y += 700;
+        body->joints[4].sizeDivided *= 3;
+        body->joints[4].sizeDivided /= 2;
 
-    // prob should add a way to do this from the PhysicsComponent class, but i am really low on time
-    body->joints[4].position.y += 700;
-    body->joints[4].sizeDivided *= 3;
-    body->joints[4].sizeDivided /= 2;
+        World::GetWorld()->InitBody(body, TPE_F);
 
-    World::GetWorld()->InitBody(body, TPE_F);
-    
-    TPE_bodyMoveBy(body, TPE_vec3(0, 100000.f, 0));
+        TPE_bodyMoveBy(body, TPE_vec3(0, 100000.f, 0));
+
+        body->elasticity = TPE_F / 100;
+        body->friction = 3 * TPE_F / 32;
+        body->flags |= TPE_BODY_FLAG_ALWAYS_ACTIVE;
+        // it's dropped in from high up and gets fast, don't let it fall through the ground
+        body->flags |= TPE_BODY_FLAG_CCD;
+    }
 
-    body->elasticity = TPE_F / 100; 
-    body->friction = 3 * TPE_F / 32;
-    body->flags |= TPE_BODY_FLAG_ALWAYS_ACTIVE;
+    wheelMeshes = new InstancedMeshComponent("car/Wheel.obj", "car/wheel/", options);
+    wheelMeshes->AddGeneratedLod(50.f, 6);
+    AddComponent(wheelMeshes);
 
-    CarWheel* rrWheel = new CarWheel(engine);
+    CarWheel* rrWheel = new CarWheel(engine, wheelMeshes);
     AddChild(rrWheel);
     rrWheel->MoveObjectLocally(Tyra::Vec4(3.7f, -1.f, 2.4f));
     wheels.push_back(rrWheel);
 
-    CarWheel* rlWheel = new CarWheel(engine);
+    CarWheel* rlWheel = new CarWheel(engine, wheelMeshes);
     AddChild(rlWheel);
     rlWheel->MoveObjectLocally(Tyra::Vec4(3.7f, -1.f, -2.4f));
     wheels.push_back(rlWheel);
 
-    CarWheel* frWheel = new CarWheel(engine);
+    CarWheel* frWheel = new CarWheel(engine, wheelMeshes);
     AddChild(frWheel);
     frWheel->MoveObjectLocally(Tyra::Vec4(-3.7f, -1.f, 2.4f));
     wheels.push_back(frWheel);
 
-    CarWheel* flWheel = new CarWheel(engine);
+    CarWheel* flWheel = new CarWheel(engine, wheelMeshes);
     AddChild(flWheel);
     flWheel->MoveObjectLocally(Tyra::Vec4(-3.7f, -1.f, -2.4f));
     wheels.push_back(flWheel);
@@ -95,12 +111,12 @@ void Car::Setup()
 
 void Car::Update() 
 {
-    engineSoundFramesCounter++;
-    if (engineSoundFramesCounter > 46 * 2) // 46 is a random number of "average framerate of this game", and 2 is the length of the engine sound in seconds. yeah, hilarious coding here.
+    engineSoundTime += GetClock()->GetDelta();
+    if (engineSoundTime > CAR_ENGINE_SOUND_LENGTH)
     {
         engine->audio.adpcm.tryPlay(engineSound, engineSoundChannel);
         engineSoundChannel = !engineSoundChannel;
-        engineSoundFramesCounter = 0;
+        engineSoundTime -= CAR_ENGINE_SOUND_LENGTH;
     }
     auto leftJoystick = pad->getLeftJoyPad();
     auto rightJoystick = pad->getRightJoyPad();
@@ -152,6 +168,18 @@ void Car::Render()
 }
 
 void Car::PhysicsUpdate()
+{
+    if (vehicle)
+    {
+        RaycastUpdate();
+    }
+    else
+    {
+        SoftBodyUpdate();
+    }
+}
+
+void Car::SoftBodyUpdate()
 {
     auto carBody = physicsComponent->GetBody();
     carForw = TPE_vec3Normalized(TPE_vec3Plus(
@@ -201,25 +229,10 @@ void Car::PhysicsUpdate()
         carBody->joints[4].position = TPE_vec3Plus(TPE_vec3Times(carUp, 300), carBody->joints[0].position);
     }
 
-    if (world->GetEnvironmentCollision(&carBody->joints[2]) && world->GetEnvironmentCollision(&carBody->joints[3]))
+    bool driving = world->GetEnvironmentCollision(&carBody->joints[2]) && world->GetEnvironmentCollision(&carBody->joints[3]);
+    UpdateAcceleration(driving);
+    if (driving)
     {
-        if (pad->getPressed().Cross)
-        {
-            acceleration += 0.03f;
-        }
-        else if (pad->getPressed().Square)
-        {
-            acceleration -= 0.15f;
-        }
-        else
-        {
-            acceleration -= 0.01f;
-            if (acceleration < 0.f) acceleration = 0.f;   
-        }
-
-        if (acceleration > maxAcceleration) acceleration = maxAcceleration;
-        if (acceleration < minAcceleration) acceleration = minAcceleration;
-
         carBody->joints[0].velocity[0] += (carForw.x * carAcceleration * acceleration) / TPE_F;
         carBody->joints[0].velocity[1] += (carForw.y * carAcceleration * acceleration) / TPE_F;
         carBody->joints[0].velocity[2] += (carForw.z * carAcceleration * acceleration) / TPE_F;
@@ -229,6 +242,43 @@ void Car::PhysicsUpdate()
     }
 }
 
+void Car::RaycastUpdate()
+{
+    PROFILE_SCOPE("Vehicle");
+    UpdateAcceleration(vehicle->IsDriving());
+
+    // steering 1 pulls the front friction axis the other way round than 2 does
+    float steer = steering == 1 ? 1.0f : (steering == 2 ? -1.0f : 0.0f);
+    float throttle = vehicle->IsDriving() ? acceleration : 0.0f;
+    vehicle->Step(world->GetEnvironmentFunction(), world->GetLevel()->GetGravity(), throttle, steer);
+    PROFILE_COUNT("Vehicle env calls", 10, vehicle->GetEnvironmentCalls());
+}
+
+void Car::UpdateAcceleration(bool driving)
+{
+    if (!driving)
+    {
+        return;
+    }
+
+    if (pad->getPressed().Cross)
+    {
+        acceleration += 0.03f;
+    }
+    else if (pad->getPressed().Square)
+    {
+        acceleration -= 0.15f;
+    }
+    else
+    {
+        acceleration -= 0.01f;
+        if (acceleration < 0.f) acceleration = 0.f;   
+    }
+
+    if (acceleration > maxAcceleration) acceleration = maxAcceleration;
+    if (acceleration < minAcceleration) acceleration = minAcceleration;
+}
+
 float Car::GetCurrentInputAcceleration()
 {   
     return acceleration;
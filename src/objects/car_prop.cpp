@@ -19,26 +19,31 @@ void CarProp::Setup()
     options.scale = 1.0F;
     options.flipUVs = true;
     StaticMeshComponent* staticMeshComponent = new StaticMeshComponent("car/Body.obj", "car/body/", options);
+    staticMeshComponent->AddGeneratedLod(80.f, 12);
     AddComponent(staticMeshComponent);
 
     this->staticMeshComponent = staticMeshComponent;
 
-    CarWheel* rrWheel = new CarWheel(engine);
+    wheelMeshes = new InstancedMeshComponent("car/Wheel.obj", "car/wheel/", options);
+    wheelMeshes->AddGeneratedLod(50.f, 6);
+    AddComponent(wheelMeshes);
+
+    CarWheel* rrWheel = new CarWheel(engine, wheelMeshes);
     AddChild(rrWheel);
     rrWheel->MoveObjectLocally(Tyra::Vec4(3.7f, -1.f, 2.4f));
     wheels.push_back(rrWheel);
 
-    CarWheel* rlWheel = new CarWheel(engine);
+    CarWheel* rlWheel = new CarWheel(engine, wheelMeshes);
     AddChild(rlWheel);
     rlWheel->MoveObjectLocally(Tyra::Vec4(3.7f, -1.f, -2.4f));
     wheels.push_back(rlWheel);
 
-    CarWheel* frWheel = new CarWheel(engine);
+    CarWheel* frWheel = new CarWheel(engine, wheelMeshes);
     AddChild(frWheel);
     frWheel->MoveObjectLocally(Tyra::Vec4(-3.7f, -1.f, 2.4f));
     wheels.push_back(frWheel);
 
-    CarWheel* flWheel = new CarWheel(engine);
+    CarWheel* flWheel = new CarWheel(engine, wheelMeshes);
     AddChild(flWheel);
     flWheel->MoveObjectLocally(Tyra::Vec4(-3.7f, -1.f, -2.4f));
     wheels.push_back(flWheel);
@@ -0,0 +1,139 @@
+#include "objects/profiler_overlay.hpp"
+
+#ifdef GWC_PROFILE
+
+#include "core/asset_cache.hpp"
+
+namespace {
+
+const float PIP_SIZE = 6.0F;
+const float PIP_STEP = 7.0F;
+const int MAX_PIPS = 34; // a bit over two frames at 60Hz
+const int REFRESH_FRAMES = 30;
+
+const Tyra::Color COUNTER_COLOR(90.0F, 90.0F, 90.0F);
+const Tyra::Color ALLOC_COLOR(128.0F, 20.0F, 20.0F);
+const Tyra::Color COLORS[] = {
+    Tyra::Color(128.0F, 128.0F, 128.0F),
+    Tyra::Color(128.0F, 40.0F, 40.0F),
+    Tyra::Color(40.0F, 128.0F, 40.0F),
+    Tyra::Color(40.0F, 70.0F, 128.0F),
+    Tyra::Color(128.0F, 128.0F, 30.0F),
+    Tyra::Color(128.0F, 40.0F, 128.0F),
+    Tyra::Color(30.0F, 128.0F, 128.0F),
+    Tyra::Color(128.0F, 80.0F, 20.0F),
+};
+
+}
+
+ProfilerOverlay::ProfilerOverlay(Tyra::Engine* engine)
+    : GameObject("ProfilerOverlay", Tyra::Vec4(0.f), Tyra::Vec4(0.f), engine)
+{
+    Setup();
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    if (texture)
+    {
+        texture->removeLinkById(pip.id);
+    }
+}
+
+void ProfilerOverlay::Setup()
+{
+    pip.mode = Tyra::SpriteMode::MODE_STRETCH;
+    texture = AssetCache::GetAssetCache()->GetTexture("ui/dot.png");
+    texture->addLink(pip.id);
+}
+
+void ProfilerOverlay::Update()
+{
+    if (engine->pad.getClicked().Select)
+    {
+        visible = !visible;
+        framesShown = 0;
+    }
+    if (!visible)
+    {
+        return;
+    }
+
+    if (framesShown % REFRESH_FRAMES == 0)
+    {
+        frameStats = Profiler::GetFrameStats();
+        zoneCount = Profiler::GetZoneCount();
+        for (int i = 0; i < zoneCount; i++)
+        {
+            zoneStats[i] = Profiler::GetStats(i);
+        }
+        counterCount = Profiler::GetCounterCount();
+        for (int i = 0; i < counterCount; i++)
+        {
+            counterStats[i] = Profiler::GetCounterStats(i);
+        }
+        allocStats = Profiler::GetFrameAllocStats();
+    }
+    framesShown++;
+    if (framesShown % PROFILER_FRAMES == 0)
+    {
+        Profiler::LogReport();
+    }
+}
+
+void ProfilerOverlay::Render()
+{
+    if (!visible)
+    {
+        return;
+    }
+
+    RenderRow(0, frameStats.avg, frameStats.p99, COLORS[0]);
+    int colors = sizeof(COLORS) / sizeof(COLORS[0]);
+    for (int i = 0; i < zoneCount; i++)
+    {
+        RenderRow(i + 1, zoneStats[i].avg, zoneStats[i].p99, COLORS[1 + i % (colors - 1)]);
+    }
+
+    // a free row between the times and the counts
+    for (int i = 0; i < counterCount; i++)
+    {
+        float unit = static_cast<float>(Profiler::GetCounterUnit(i));
+        RenderRow(zoneCount + 2 + i, counterStats[i].avg / unit, counterStats[i].p99 / unit, COUNTER_COLOR);
+    }
+    RenderRow(zoneCount + 2 + counterCount, allocStats.avg, allocStats.p99, ALLOC_COLOR);
+}
+
+void ProfilerOverlay::RenderRow(int row, float solid, float faded, const Tyra::Color& color)
+{
+    auto screenSettings = engine->renderer.core.getSettings();
+    float left = screenSettings.getWidth() - 15.0F - MAX_PIPS * PIP_STEP;
+    float top = 20.0F + row * PIP_STEP;
+
+    for (int i = 0; i < MAX_PIPS; i++)
+    {
+        float fill;
+        pip.color = color;
+        if (solid > i)
+        {
+            fill = solid - i;
+        }
+        else if (faded > i)
+        {
+            fill = faded - i;
+            pip.color.a = 40.0F;
+        }
+        else
+        {
+            break;
+        }
+
+        // the last pip shrinks to the remaining fraction
+        float size = PIP_SIZE * (fill < 1.0F ? fill : 1.0F);
+        pip.position = Tyra::Vec2(left + i * PIP_STEP, top + (PIP_SIZE - size) / 2.0F);
+        pip.size = Tyra::Vec2(size, size);
+        engine->renderer.renderer2D.render(pip);
+    }
+}
+
+#endif
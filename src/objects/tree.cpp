@@ -1,7 +1,8 @@
 #include "objects/tree.hpp"
 
-Tree::Tree(Tyra::Engine* engine)
-  : GameObject("Tree", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0f, 0.0f, 0.0f), engine)
+Tree::Tree(Tyra::Engine* engine, InstancedMeshComponent* forest)
+  : GameObject("Tree", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0f, 0.0f, 0.0f), engine),
+  forest(forest)
 {
     Setup();
 }
@@ -14,13 +15,10 @@ Tree::~Tree()
 void Tree::Setup() 
 {
     RotateObjectLocally(Tyra::Vec4(0, rand() % 360, 0));
-    Tyra::ObjLoaderOptions options;
-    options.scale = rand() % 3 + 1.f;
-    options.flipUVs = true;
-    StaticMeshComponent* staticMeshComponent = new StaticMeshComponent("tree/Tree.obj", "tree/", options);
-    AddComponent(staticMeshComponent);
+    MeshInstanceComponent* meshInstanceComponent = new MeshInstanceComponent(forest, rand() % 3 + 1.f);
+    AddComponent(meshInstanceComponent);
 
-    this->staticMeshComponent = staticMeshComponent;
+    this->meshInstanceComponent = meshInstanceComponent;
 }
 
 void Tree::Update() 
@@ -1,7 +1,8 @@
 #include "objects/wheel.hpp"
 
-CarWheel::CarWheel(Tyra::Engine* engine) 
-    : GameObject("Wheel", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0F, 0.0F, 0.0F), engine) 
+CarWheel::CarWheel(Tyra::Engine* engine, InstancedMeshComponent* wheelMeshes) 
+    : GameObject("Wheel", Tyra::Vec4(0.0F, 0.0F, 0.0F), Tyra::Vec4(0.0F, 0.0F, 0.0F), engine),
+    wheelMeshes(wheelMeshes)
 {
     Setup();
 }
@@ -9,13 +10,11 @@ CarWheel::CarWheel(Tyra::Engine* engine)
 void CarWheel::Setup()
 {
     RotateObjectLocally(Tyra::Vec4(0.0F * Tyra::Math::ANG2RAD, 90.0F * Tyra::Math::ANG2RAD, 90.0F * Tyra::Math::ANG2RAD));
-    Tyra::ObjLoaderOptions options;
-    options.scale = 1.0F;
-    options.flipUVs = true;
-    StaticMeshComponent* staticMeshComponent = new StaticMeshComponent("car/Wheel.obj", "car/wheel/", options);
-    AddComponent(staticMeshComponent);
+    // the mesh itself lives on the car, all four wheels are drawn in one go
+    MeshInstanceComponent* meshInstanceComponent = new MeshInstanceComponent(wheelMeshes);
+    AddComponent(meshInstanceComponent);
 
-    this->staticMeshComponent = staticMeshComponent;
+    this->meshInstanceComponent = meshInstanceComponent;
 }
 
 void CarWheel::Update()
@@ -0,0 +1,420 @@
+// Host-side packer: loose files under the asset root -> one .gwa archive
+// read by AssetArchive.
+//
+//   assetpack [-r root] [-e .ext]... [-c] [-o output.gwa] list
+//   assetpack --bench [-r root] [-n runs] archive.gwa
+//
+// Every line of the list is a file or a directory (packed recursively, in
+// name order), relative to the root. Files end up in the archive in list
+// order, so list them in the order the levels load them. A file is only
+// stored the first time it shows up. -e packs only files with the given
+// extensions, everything else stays loose. -c block compresses the entries
+// it pays off for. Empty lines and # comments are skipped.
+//
+// --bench reads every entry of an archive through AssetFile like the game does
+// and the same files loose from the root, fails if any of them differ, then
+// prints bytes read and timings of both. It builds against host/inc's stand-in
+// for Tyra for that.
+
+#include "core/archive_format.hpp"
+#include "core/block_codec.hpp"
+#include "core/asset_archive.hpp"
+#include "core/asset_file.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Input
+{
+    std::string path; // archive path
+    fs::path source;
+    uint32_t size;
+};
+
+std::string Trim(const std::string& line)
+{
+    size_t begin = line.find_first_not_of(" \t\r");
+    size_t end = line.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : line.substr(begin, end - begin + 1);
+}
+
+bool Included(const fs::path& path, const std::vector<std::string>& extensions)
+{
+    if (extensions.empty())
+    {
+        return true;
+    }
+    return std::find(extensions.begin(), extensions.end(), path.extension().string()) != extensions.end();
+}
+
+void Add(const fs::path& root, const fs::path& source, const std::vector<std::string>& extensions,
+         std::set<std::string>& seen, std::vector<Input>& inputs)
+{
+    if (!Included(source, extensions))
+    {
+        return;
+    }
+
+    auto path = fs::relative(source, root).generic_string();
+    if (!seen.insert(path).second)
+    {
+        return;
+    }
+
+    if (path.size() >= ARCHIVE_FILE_PATH_LENGTH)
+    {
+        fprintf(stderr, "%s: path too long, skipped\n", path.c_str());
+        return;
+    }
+
+    inputs.push_back({path, source, static_cast<uint32_t>(fs::file_size(source))});
+}
+
+bool Collect(const fs::path& root, const std::string& listPath, const std::vector<std::string>& extensions, std::vector<Input>& inputs)
+{
+    std::ifstream list(listPath);
+    if (!list)
+    {
+        fprintf(stderr, "Can't open %s\n", listPath.c_str());
+        return false;
+    }
+
+    std::set<std::string> seen;
+    std::string line;
+    while (std::getline(list, line))
+    {
+        line = Trim(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        fs::path source = root / line;
+        if (fs::is_directory(source))
+        {
+            std::vector<fs::path> files;
+            for (const auto& item : fs::recursive_directory_iterator(source))
+            {
+                if (item.is_regular_file())
+                {
+                    files.push_back(item.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (const auto& file : files)
+            {
+                Add(root, file, extensions, seen, inputs);
+            }
+        }
+        else if (fs::is_regular_file(source))
+        {
+            Add(root, source, extensions, seen, inputs);
+        }
+        else
+        {
+            fprintf(stderr, "%s: not found, skipped\n", line.c_str());
+        }
+    }
+    return true;
+}
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>& out)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    out.resize(size);
+    bool ok = size == 0 || fread(out.data(), 1, size, file) == static_cast<size_t>(size);
+    fclose(file);
+    return ok;
+}
+
+void WriteLength(std::vector<uint8_t>& out, uint32_t length)
+{
+    while (length >= 255)
+    {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(length);
+}
+
+void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, uint32_t literalCount, uint32_t offset, uint32_t matchLength)
+{
+    uint32_t matchCode = matchLength ? matchLength - BLOCK_CODEC_MIN_MATCH : 0;
+    out.push_back((std::min(literalCount, 15u) << 4) | std::min(matchCode, 15u));
+    if (literalCount >= 15) WriteLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (!matchLength)
+    {
+        return;
+    }
+    out.push_back(offset & 0xFF);
+    out.push_back(offset >> 8);
+    if (matchCode >= 15) WriteLength(out, matchCode - 15);
+}
+
+// Greedy LZ4 style compression of one block, hash table over 4 byte prefixes
+std::vector<uint8_t> CompressBlock(const uint8_t* data, uint32_t size)
+{
+    const int hashBits = 14;
+    std::vector<int32_t> table(1 << hashBits, -1);
+    auto hash = [&](uint32_t i) {
+        uint32_t v;
+        memcpy(&v, data + i, 4);
+        return (v * 2654435761u) >> (32 - hashBits);
+    };
+
+    std::vector<uint8_t> out;
+    uint32_t anchor = 0;
+    uint32_t i = 0;
+    while (i + BLOCK_CODEC_MIN_MATCH <= size)
+    {
+        uint32_t h = hash(i);
+        int32_t candidate = table[h];
+        table[h] = i;
+
+        if (candidate >= 0 && i - candidate <= 0xFFFF && !memcmp(data + candidate, data + i, BLOCK_CODEC_MIN_MATCH))
+        {
+            uint32_t length = BLOCK_CODEC_MIN_MATCH;
+            while (i + length < size && data[candidate + length] == data[i + length]) length++;
+
+            WriteSequence(out, data + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+            continue;
+        }
+        i++;
+    }
+
+    WriteSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+// Block table + blocks, see block_codec.hpp
+std::vector<uint8_t> Compress(const std::vector<uint8_t>& data)
+{
+    uint32_t blockCount = BlockCodecBlockCount(data.size());
+    std::vector<uint32_t> blockTable(blockCount);
+    std::vector<uint8_t> blocks;
+
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        uint32_t begin = b * BLOCK_CODEC_BLOCK_SIZE;
+        uint32_t size = std::min<uint32_t>(BLOCK_CODEC_BLOCK_SIZE, data.size() - begin);
+        auto packed = CompressBlock(data.data() + begin, size);
+        if (packed.size() < size)
+        {
+            blockTable[b] = packed.size();
+            blocks.insert(blocks.end(), packed.begin(), packed.end());
+        }
+        else
+        {
+            blockTable[b] = size | BLOCK_CODEC_RAW_FLAG;
+            blocks.insert(blocks.end(), data.begin() + begin, data.begin() + begin + size);
+        }
+    }
+
+    std::vector<uint8_t> result(blockCount * sizeof(uint32_t));
+    if (blockCount) memcpy(result.data(), blockTable.data(), result.size());
+    result.insert(result.end(), blocks.begin(), blocks.end());
+    return result;
+}
+
+bool Write(const std::string& outputPath, const std::vector<Input>& inputs, bool compress)
+{
+    std::vector<ArchiveFileEntry> entries(inputs.size());
+    uint32_t offset = ArchiveAlign(sizeof(ArchiveFileHeader) + inputs.size() * sizeof(ArchiveFileEntry));
+
+    ArchiveFileHeader header = {};
+    header.magic = ARCHIVE_FILE_MAGIC;
+    header.version = ARCHIVE_FILE_VERSION;
+    header.entryCount = inputs.size();
+    header.dataOffset = offset;
+
+    FILE* output = fopen(outputPath.c_str(), "wb");
+    if (!output)
+    {
+        fprintf(stderr, "Can't write %s\n", outputPath.c_str());
+        return false;
+    }
+
+    // data first, the TOC is written last once the stored sizes are known
+    uint64_t rawBytes = 0;
+    std::vector<uint8_t> buffer;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (!ReadFile(inputs[i].source.string(), buffer))
+        {
+            fprintf(stderr, "Can't read %s\n", inputs[i].source.string().c_str());
+            fclose(output);
+            return false;
+        }
+
+        auto& entry = entries[i];
+        memset(&entry, 0, sizeof(ArchiveFileEntry));
+        strncpy(entry.path, inputs[i].path.c_str(), ARCHIVE_FILE_PATH_LENGTH - 1);
+        entry.offset = offset;
+        entry.size = buffer.size();
+        entry.storedSize = buffer.size();
+        rawBytes += buffer.size();
+
+        if (compress && !buffer.empty())
+        {
+            // only worth it if it saves a decent chunk, decoding isn't free
+            auto packed = Compress(buffer);
+            if (packed.size() < buffer.size() - buffer.size() / 8)
+            {
+                entry.flags |= ARCHIVE_ENTRY_FLAG_COMPRESSED;
+                entry.storedSize = packed.size();
+                buffer.swap(packed);
+            }
+        }
+
+        fseek(output, entry.offset, SEEK_SET);
+        fwrite(buffer.data(), 1, buffer.size(), output);
+        offset = ArchiveAlign(offset + entry.storedSize);
+    }
+    header.totalSize = offset;
+
+    // pad the tail so the total size matches the header
+    fseek(output, header.totalSize - 1, SEEK_SET);
+    fputc(0, output);
+
+    fseek(output, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, output);
+    fwrite(entries.data(), sizeof(ArchiveFileEntry), entries.size(), output);
+    fclose(output);
+
+    printf("%s: %zu files, %llu bytes of data, %u bytes archive\n", outputPath.c_str(), inputs.size(),
+           static_cast<unsigned long long>(rawBytes), header.totalSize);
+    return true;
+}
+
+double Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Loads every entry through AssetFile, the game's own reader, and the same
+// files loose, checks they came out byte for byte the same and compares the
+// timings
+int Bench(const std::string& root, const std::string& archivePath, int runs)
+{
+    auto archive = AssetArchive::Open(archivePath);
+    if (!archive)
+    {
+        fprintf(stderr, "Can't open archive %s\n", archivePath.c_str());
+        return 1;
+    }
+    AssetArchive::SetArchive(archive.get());
+
+    uint64_t rawBytes = 0, archiveBytes = 0;
+    double looseTime = 0, archiveTime = 0;
+    std::vector<uint8_t> loose, packed;
+
+    for (int run = 0; run < runs; run++)
+    {
+        for (size_t i = 0; i < archive->GetEntryCount(); i++)
+        {
+            const auto& entry = archive->GetEntry(i);
+            double start = Now();
+            if (!ReadFile((fs::path(root) / entry.path).string(), loose))
+            {
+                fprintf(stderr, "%s: no loose file to compare against\n", entry.path);
+                return 1;
+            }
+            looseTime += Now() - start;
+            rawBytes += loose.size();
+
+            start = Now();
+            AssetFile file;
+            // IsArchived, or it quietly fell back to the loose file
+            if (!file.Open(entry.path) || !file.IsArchived())
+            {
+                fprintf(stderr, "%s: can't open it from the archive\n", entry.path);
+                return 1;
+            }
+            packed.resize(file.GetSize());
+            if (file.Read(packed.data(), file.GetSize()) != file.GetSize())
+            {
+                fprintf(stderr, "%s: archive read failed\n", entry.path);
+                return 1;
+            }
+            archiveTime += Now() - start;
+            archiveBytes += entry.storedSize;
+
+            if (packed.size() != loose.size() || memcmp(packed.data(), loose.data(), loose.size()))
+            {
+                fprintf(stderr, "%s: differs from the loose file\n", entry.path);
+                return 1;
+            }
+        }
+    }
+    AssetArchive::SetArchive(nullptr);
+
+    printf("%zu files, %d runs, all the same as the loose files\n", archive->GetEntryCount(), runs);
+    printf("loose:   %llu bytes read, %.2f ms\n", static_cast<unsigned long long>(rawBytes / runs), looseTime * 1000.0 / runs);
+    printf("archive: %llu bytes read, %.2f ms\n", static_cast<unsigned long long>(archiveBytes / runs), archiveTime * 1000.0 / runs);
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string root = ".";
+    std::string output = ARCHIVE_FILE_NAME;
+    std::string list;
+    std::vector<std::string> extensions;
+    bool compress = false;
+    bool bench = false;
+    int runs = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) root = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) extensions.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) runs = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-c")) compress = true;
+        else if (!strcmp(argv[i], "--bench")) bench = true;
+        else list = argv[i];
+    }
+
+    if (list.empty())
+    {
+        fprintf(stderr, "usage: assetpack [-r root] [-e .ext]... [-c] [-o output.gwa] list\n"
+                        "       assetpack --bench [-r root] [-n runs] archive.gwa\n");
+        return 1;
+    }
+
+    if (bench)
+    {
+        return Bench(root, list, runs);
+    }
+
+    std::vector<Input> inputs;
+    if (!Collect(root, list, extensions, inputs))
+    {
+        return 1;
+    }
+    return Write(output, inputs, compress) ? 0 : 1;
+}
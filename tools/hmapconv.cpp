@@ -0,0 +1,293 @@
+// Host-side converter: heightmap CSV or PNG -> packed .hmp read by Heightmap,
+// or with -t a tiled .hmt streamed by TiledHeightmap.
+//
+//   hmapconv [-o output.hmp] heightmap.csv
+//   hmapconv -m minHeight -M maxHeight [-o output.hmp] heightmap.png
+//   hmapconv -t tileCells -b left up right down [-o output.hmt] heightmap.csv
+//
+// CSV rows are ';' separated heights, the range is taken from the data
+// unless -m / -M are given. PNG pixels (first channel, 8 or 16 bit) map
+// black to minHeight and white to maxHeight.
+//
+// A tiled map carries its own placement, -b takes the same XZ bounds a
+// Heightmap would get (samples in the middle of their cells).
+
+#include "core/heightmap_format.hpp"
+
+#include <png.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Grid
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> values; // row-major
+};
+
+bool EndsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool LoadCsv(const std::string& path, Grid& grid)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        fprintf(stderr, "Can't open %s\n", path.c_str());
+        return false;
+    }
+
+    std::string line, value;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line == "\r") continue;
+
+        uint32_t count = 0;
+        std::stringstream row(line);
+        while (std::getline(row, value, ';'))
+        {
+            grid.values.push_back(strtof(value.c_str(), nullptr));
+            count++;
+        }
+
+        if (grid.height == 0)
+        {
+            grid.width = count;
+        }
+        else if (count != grid.width)
+        {
+            fprintf(stderr, "%s: row %u has %u values, expected %u\n", path.c_str(), grid.height, count, grid.width);
+            return false;
+        }
+        grid.height++;
+    }
+    return grid.width && grid.height;
+}
+
+// Values end up 0..1, scaled into the height range by the caller
+bool LoadPng(const std::string& path, Grid& grid)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path.c_str()))
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), image.message);
+        return false;
+    }
+
+    // linear 16 bit gray keeps 16 bit sources intact
+    image.format = PNG_FORMAT_LINEAR_Y;
+    std::vector<uint16_t> pixels(PNG_IMAGE_SIZE(image) / sizeof(uint16_t));
+    if (!png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr))
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), image.message);
+        return false;
+    }
+
+    grid.width = image.width;
+    grid.height = image.height;
+    grid.values.resize(pixels.size());
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        grid.values[i] = pixels[i] / 65535.f;
+    }
+    return true;
+}
+
+std::vector<uint16_t> Quantize(const Grid& grid, float minHeight, float maxHeight)
+{
+    float range = maxHeight - minHeight;
+    std::vector<uint16_t> heights(grid.values.size());
+    for (size_t i = 0; i < heights.size(); i++)
+    {
+        float t = range > 0.f ? (grid.values[i] - minHeight) / range : 0.f;
+        t = std::min(1.f, std::max(0.f, t));
+        heights[i] = static_cast<uint16_t>(t * HEIGHTMAP_FILE_MAX_VALUE + 0.5f);
+    }
+    return heights;
+}
+
+bool Write(const std::string& path, const Grid& grid, float minHeight, float maxHeight)
+{
+    HeightmapFileHeader header = {};
+    header.magic = HEIGHTMAP_FILE_MAGIC;
+    header.version = HEIGHTMAP_FILE_VERSION;
+    header.width = grid.width;
+    header.height = grid.height;
+    header.minHeight = minHeight;
+    header.maxHeight = maxHeight;
+    header.totalSize = HeightmapFileSize(grid.width, grid.height);
+
+    auto heights = Quantize(grid, minHeight, maxHeight);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Can't write %s\n", path.c_str());
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(heights.data(), sizeof(uint16_t), heights.size(), file);
+    fclose(file);
+
+    printf("%s: %ux%u, %.3f..%.3f, max error %.4f\n", path.c_str(), grid.width, grid.height, minHeight, maxHeight,
+           (maxHeight - minHeight) / HEIGHTMAP_FILE_MAX_VALUE / 2);
+    return true;
+}
+
+bool WriteTiled(const std::string& path, const Grid& grid, float minHeight, float maxHeight, uint32_t tileCells,
+                const float* bounds)
+{
+    if (grid.width < 2 || grid.height < 2)
+    {
+        fprintf(stderr, "Tiled heightmaps need at least 2x2 samples\n");
+        return false;
+    }
+
+    HeightmapTiledHeader header = {};
+    header.magic = HEIGHTMAP_TILED_MAGIC;
+    header.version = HEIGHTMAP_TILED_VERSION;
+    header.width = grid.width;
+    header.height = grid.height;
+    header.tileCells = tileCells;
+    header.tilesX = (grid.width - 2) / tileCells + 1;
+    header.tilesZ = (grid.height - 2) / tileCells + 1;
+    header.minHeight = minHeight;
+    header.maxHeight = maxHeight;
+    header.cellSizeX = (bounds[2] - bounds[0]) / grid.width;
+    header.cellSizeZ = (bounds[3] - bounds[1]) / grid.height;
+    header.originX = bounds[0] + header.cellSizeX / 2;
+    header.originZ = bounds[1] + header.cellSizeZ / 2;
+    header.totalSize = HeightmapTiledFileSize(header.tilesX, header.tilesZ, tileCells);
+
+    auto heights = Quantize(grid, minHeight, maxHeight);
+    // past the edge repeats the last sample
+    auto sample = [&](uint32_t x, uint32_t z) {
+        return heights[std::min(z, grid.height - 1) * grid.width + std::min(x, grid.width - 1)];
+    };
+
+    std::vector<HeightmapTileBounds> tileBounds;
+    std::vector<uint16_t> overview;
+    std::vector<uint16_t> tiles;
+    for (uint32_t tz = 0; tz < header.tilesZ; tz++)
+    {
+        for (uint32_t tx = 0; tx < header.tilesX; tx++)
+        {
+            HeightmapTileBounds range = {HEIGHTMAP_FILE_MAX_VALUE, 0};
+            for (uint32_t z = 0; z <= tileCells; z++)
+            {
+                for (uint32_t x = 0; x <= tileCells; x++)
+                {
+                    uint16_t value = sample(tx * tileCells + x, tz * tileCells + z);
+                    range.min = std::min(range.min, value);
+                    range.max = std::max(range.max, value);
+                    tiles.push_back(value);
+                }
+            }
+            tileBounds.push_back(range);
+        }
+    }
+    for (uint32_t tz = 0; tz <= header.tilesZ; tz++)
+    {
+        for (uint32_t tx = 0; tx <= header.tilesX; tx++)
+        {
+            overview.push_back(sample(tx * tileCells, tz * tileCells));
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Can't write %s\n", path.c_str());
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(tileBounds.data(), sizeof(HeightmapTileBounds), tileBounds.size(), file);
+    fwrite(overview.data(), sizeof(uint16_t), overview.size(), file);
+    fwrite(tiles.data(), sizeof(uint16_t), tiles.size(), file);
+    fclose(file);
+
+    printf("%s: %ux%u, %ux%u tiles of %u cells (%u bytes each), %.3f..%.3f\n", path.c_str(), grid.width,
+           grid.height, header.tilesX, header.tilesZ, tileCells,
+           static_cast<uint32_t>(HeightmapTileSamples(tileCells) * sizeof(uint16_t)), minHeight, maxHeight);
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string input, output;
+    bool hasMin = false, hasMax = false, hasBounds = false;
+    float minHeight = 0.f, maxHeight = 0.f;
+    uint32_t tileCells = 0;
+    float bounds[4];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) { minHeight = atof(argv[++i]); hasMin = true; }
+        else if (!strcmp(argv[i], "-M") && i + 1 < argc) { maxHeight = atof(argv[++i]); hasMax = true; }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) tileCells = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-b") && i + 4 < argc)
+        {
+            for (int j = 0; j < 4; j++) bounds[j] = atof(argv[++i]);
+            hasBounds = true;
+        }
+        else input = argv[i];
+    }
+
+    if (input.empty() || (tileCells && !hasBounds))
+    {
+        fprintf(stderr, "usage: hmapconv [-o output.hmp] heightmap.csv\n"
+                        "       hmapconv -m minHeight -M maxHeight [-o output.hmp] heightmap.png\n"
+                        "       hmapconv -t tileCells -b left up right down [-o output.hmt] heightmap.csv\n");
+        return 1;
+    }
+
+    if (output.empty())
+    {
+        auto dot = input.find_last_of('.');
+        output = input.substr(0, dot) + (tileCells ? HEIGHTMAP_TILED_EXTENSION : HEIGHTMAP_FILE_EXTENSION);
+    }
+
+    Grid grid;
+    if (EndsWith(input, ".png"))
+    {
+        if (!hasMin || !hasMax)
+        {
+            fprintf(stderr, "PNG heightmaps need -m and -M\n");
+            return 1;
+        }
+        if (!LoadPng(input, grid)) return 1;
+        for (auto& value : grid.values)
+        {
+            value = minHeight + value * (maxHeight - minHeight);
+        }
+    }
+    else
+    {
+        if (!LoadCsv(input, grid)) return 1;
+        auto range = std::minmax_element(grid.values.begin(), grid.values.end());
+        if (!hasMin) minHeight = *range.first;
+        if (!hasMax) maxHeight = *range.second;
+    }
+
+    if (tileCells)
+    {
+        return WriteTiled(output, grid, minHeight, maxHeight, tileCells, bounds) ? 0 : 1;
+    }
+    return Write(output, grid, minHeight, maxHeight) ? 0 : 1;
+}
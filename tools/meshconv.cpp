@@ -0,0 +1,510 @@
+// Host-side converter: OBJ (+ MTL) -> packed .gwm blob read by MeshLoader.
+//
+//   meshconv [-s scale] [-f] [-o output.gwm] input.obj
+//   meshconv --bench [-n runs] input.obj...
+//
+// -s / -f mirror ObjLoaderOptions::scale / flipUVs. The loader compensates
+// if the game asks for different options, so baking with defaults is fine.
+
+#include "core/mesh_format.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Material
+{
+    std::string name;
+    std::string texturePath;
+    float ambient[4] = {128.f, 128.f, 128.f, 128.f};
+    std::vector<float> positions, normals, textureCoords, colors; // 4 floats per vertex
+};
+
+struct Mesh
+{
+    std::vector<Material> materials;
+    uint32_t flags = 0;
+};
+
+bool ReadFile(const std::string& path, std::string& out)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    out.resize(size);
+    bool ok = size == 0 || fread(&out[0], 1, size, file) == static_cast<size_t>(size);
+    fclose(file);
+    return ok;
+}
+
+std::string Directory(const std::string& path)
+{
+    auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+std::string TextureName(std::string path)
+{
+    auto slash = path.find_last_of("/\\");
+    if (slash != std::string::npos) path = path.substr(slash + 1);
+    auto dot = path.find_last_of('.');
+    if (dot != std::string::npos) path = path.substr(0, dot);
+    return path;
+}
+
+std::string Trim(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    return std::string(begin, end);
+}
+
+// Calls f(lineBegin, lineEnd) for every line of text
+template <typename F>
+void ForEachLine(const std::string& text, F f)
+{
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        f(p, lineEnd);
+        p = lineEnd + 1;
+    }
+}
+
+void LoadMtl(const std::string& path, Mesh& mesh)
+{
+    std::string text;
+    if (!ReadFile(path, text))
+    {
+        fprintf(stderr, "warning: can't read material library %s\n", path.c_str());
+        return;
+    }
+
+    Material* current = nullptr;
+    ForEachLine(text, [&](const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (!strncmp(p, "newmtl ", 7))
+        {
+            std::string name = Trim(p + 7, end);
+            current = nullptr;
+            for (auto& material : mesh.materials)
+                if (material.name == name) current = &material;
+            if (!current)
+            {
+                mesh.materials.push_back(Material());
+                current = &mesh.materials.back();
+                current->name = name;
+            }
+        }
+        else if (current && !strncmp(p, "Kd ", 3))
+        {
+            char* next;
+            current->ambient[0] = strtof(p + 3, &next) * 128.f;
+            current->ambient[1] = strtof(next, &next) * 128.f;
+            current->ambient[2] = strtof(next, &next) * 128.f;
+        }
+        else if (current && !strncmp(p, "map_Kd ", 7))
+        {
+            current->texturePath = TextureName(Trim(p + 7, end));
+        }
+    });
+}
+
+bool ParseObj(const std::string& path, float scale, bool flipUVs, Mesh& mesh)
+{
+    std::string text;
+    if (!ReadFile(path, text))
+    {
+        fprintf(stderr, "can't read %s\n", path.c_str());
+        return false;
+    }
+
+    std::vector<float> positions, colors, normals, textureCoords; // 3, 3, 3, 2 per entry
+    Material* current = nullptr;
+
+    auto useMaterial = [&](const std::string& name) {
+        for (auto& material : mesh.materials)
+        {
+            if (material.name == name)
+            {
+                current = &material;
+                return;
+            }
+        }
+        mesh.materials.push_back(Material());
+        current = &mesh.materials.back();
+        current->name = name;
+    };
+
+    auto emitVertex = [&](long v, long t, long n) {
+        const size_t vi = v > 0 ? v - 1 : positions.size() / 3 + v;
+        if (vi >= positions.size() / 3) return false;
+        current->positions.insert(current->positions.end(),
+                                  {positions[vi * 3] * scale, positions[vi * 3 + 1] * scale, positions[vi * 3 + 2] * scale, 1.f});
+        if (!colors.empty())
+        {
+            current->colors.insert(current->colors.end(),
+                                   {colors[vi * 3] * 128.f, colors[vi * 3 + 1] * 128.f, colors[vi * 3 + 2] * 128.f, 128.f});
+        }
+
+        size_t ti = t > 0 ? t - 1 : textureCoords.size() / 2 + t;
+        if (t != 0 && ti < textureCoords.size() / 2)
+        {
+            float u = textureCoords[ti * 2], vv = textureCoords[ti * 2 + 1];
+            current->textureCoords.insert(current->textureCoords.end(), {u, flipUVs ? 1.f - vv : vv, 1.f, 0.f});
+            mesh.flags |= MESH_FILE_FLAG_TEXTURE_COORDS;
+        }
+        else
+        {
+            current->textureCoords.insert(current->textureCoords.end(), {0.f, 0.f, 1.f, 0.f});
+        }
+
+        size_t ni = n > 0 ? n - 1 : normals.size() / 3 + n;
+        if (n != 0 && ni < normals.size() / 3)
+        {
+            current->normals.insert(current->normals.end(), {normals[ni * 3], normals[ni * 3 + 1], normals[ni * 3 + 2], 1.f});
+            mesh.flags |= MESH_FILE_FLAG_NORMALS;
+        }
+        else
+        {
+            current->normals.insert(current->normals.end(), {0.f, 1.f, 0.f, 1.f});
+        }
+        return true;
+    };
+
+    bool ok = true;
+    ForEachLine(text, [&](const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (end - p < 2) return;
+
+        char* next;
+        if (p[0] == 'v' && p[1] == ' ')
+        {
+            float xyz[6];
+            int n = 0;
+            const char* q = p + 2;
+            for (; n < 6; n++)
+            {
+                xyz[n] = strtof(q, &next);
+                if (next == q || next > end) break;
+                q = next;
+            }
+            positions.insert(positions.end(), {xyz[0], xyz[1], xyz[2]});
+            if (n >= 6)
+            {
+                // vertex colors, only kept if every vertex has them
+                if (colors.size() == positions.size() - 3) colors.insert(colors.end(), {xyz[3], xyz[4], xyz[5]});
+            }
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            float u = strtof(p + 2, &next);
+            float v = strtof(next, &next);
+            textureCoords.insert(textureCoords.end(), {u, v});
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            float x = strtof(p + 2, &next);
+            float y = strtof(next, &next);
+            float z = strtof(next, &next);
+            normals.insert(normals.end(), {x, y, z});
+        }
+        else if (p[0] == 'f' && p[1] == ' ')
+        {
+            if (!current) useMaterial("default");
+
+            long face[64][3];
+            int count = 0;
+            const char* q = p + 2;
+            while (q < end && count < 64)
+            {
+                while (q < end && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+                if (q >= end) break;
+                long v = strtol(q, &next, 10), t = 0, n = 0;
+                q = next;
+                if (q < end && *q == '/')
+                {
+                    q++;
+                    if (*q != '/')
+                    {
+                        t = strtol(q, &next, 10);
+                        q = next;
+                    }
+                    if (q < end && *q == '/')
+                    {
+                        n = strtol(q + 1, &next, 10);
+                        q = next;
+                    }
+                }
+                face[count][0] = v;
+                face[count][1] = t;
+                face[count][2] = n;
+                count++;
+            }
+
+            // triangle fan
+            for (int i = 1; i + 1 < count; i++)
+            {
+                ok &= emitVertex(face[0][0], face[0][1], face[0][2]);
+                ok &= emitVertex(face[i][0], face[i][1], face[i][2]);
+                ok &= emitVertex(face[i + 1][0], face[i + 1][1], face[i + 1][2]);
+            }
+        }
+        else if (!strncmp(p, "usemtl ", 7))
+        {
+            useMaterial(Trim(p + 7, end));
+        }
+        else if (!strncmp(p, "mtllib ", 7))
+        {
+            LoadMtl(Directory(path) + Trim(p + 7, end), mesh);
+        }
+    });
+
+    if (!colors.empty() && colors.size() == positions.size())
+    {
+        mesh.flags |= MESH_FILE_FLAG_COLORS;
+    }
+
+    // materials that are declared but never used would make empty draws
+    for (size_t i = 0; i < mesh.materials.size();)
+    {
+        if (mesh.materials[i].positions.empty())
+            mesh.materials.erase(mesh.materials.begin() + i);
+        else
+            i++;
+    }
+
+    if (!ok)
+    {
+        fprintf(stderr, "%s: face references a missing vertex\n", path.c_str());
+    }
+    return ok;
+}
+
+std::vector<uint8_t> Pack(const Mesh& mesh, float scale, bool flipUVs)
+{
+    const uint32_t attributes = MeshFileAttributeCount(mesh.flags);
+    uint32_t size = sizeof(MeshFileHeader) + mesh.materials.size() * sizeof(MeshFileMaterial);
+    for (const auto& material : mesh.materials)
+    {
+        size += material.positions.size() * sizeof(float) * attributes;
+    }
+
+    std::vector<uint8_t> blob(size, 0);
+    auto* header = reinterpret_cast<MeshFileHeader*>(blob.data());
+    header->magic = MESH_FILE_MAGIC;
+    header->version = MESH_FILE_VERSION;
+    header->flags = mesh.flags;
+    header->materialCount = mesh.materials.size();
+    header->scale = scale;
+    header->flipUVs = flipUVs;
+    header->totalSize = size;
+
+    auto* table = reinterpret_cast<MeshFileMaterial*>(blob.data() + sizeof(MeshFileHeader));
+    uint32_t offset = sizeof(MeshFileHeader) + mesh.materials.size() * sizeof(MeshFileMaterial);
+    for (size_t m = 0; m < mesh.materials.size(); m++)
+    {
+        const auto& material = mesh.materials[m];
+        auto& entry = table[m];
+        strncpy(entry.name, material.name.c_str(), MESH_FILE_NAME_LENGTH - 1);
+        strncpy(entry.texturePath, material.texturePath.c_str(), MESH_FILE_NAME_LENGTH - 1);
+        memcpy(entry.ambient, material.ambient, sizeof(entry.ambient));
+        entry.vertexCount = material.positions.size() / 4;
+        entry.dataOffset = offset;
+
+        auto append = [&](const std::vector<float>& values) {
+            memcpy(blob.data() + offset, values.data(), values.size() * sizeof(float));
+            offset += values.size() * sizeof(float);
+        };
+        append(material.positions);
+        if (mesh.flags & MESH_FILE_FLAG_NORMALS) append(material.normals);
+        if (mesh.flags & MESH_FILE_FLAG_TEXTURE_COORDS) append(material.textureCoords);
+        if (mesh.flags & MESH_FILE_FLAG_COLORS) append(material.colors);
+    }
+
+    return blob;
+}
+
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return ok;
+}
+
+// Same work the runtime loader does: one read, then copy out the float4 arrays
+size_t LoadBlob(const std::string& path, std::vector<std::vector<float>>& arrays)
+{
+    std::string blob;
+    if (!ReadFile(path, blob) || blob.size() < sizeof(MeshFileHeader))
+    {
+        return 0;
+    }
+    const auto* header = reinterpret_cast<const MeshFileHeader*>(blob.data());
+    const auto* table = reinterpret_cast<const MeshFileMaterial*>(blob.data() + sizeof(MeshFileHeader));
+    const uint32_t attributes = MeshFileAttributeCount(header->flags);
+    size_t vertices = 0;
+    arrays.clear();
+    for (uint32_t m = 0; m < header->materialCount; m++)
+    {
+        const float* floats = reinterpret_cast<const float*>(blob.data() + table[m].dataOffset);
+        for (uint32_t a = 0; a < attributes; a++)
+        {
+            arrays.emplace_back(floats, floats + table[m].vertexCount * 4);
+            floats += table[m].vertexCount * 4;
+        }
+        vertices += table[m].vertexCount;
+    }
+    return vertices;
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::string BlobPath(const std::string& input)
+{
+    auto dot = input.find_last_of('.');
+    auto slash = input.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return input + MESH_FILE_EXTENSION;
+    return input.substr(0, dot) + MESH_FILE_EXTENSION;
+}
+
+int Bench(const std::vector<std::string>& inputs, int runs)
+{
+    printf("%-32s %10s %10s %8s %12s %12s %8s\n", "asset", "obj KiB", "blob KiB", "verts", "obj ms", "blob ms", "speedup");
+    double totalObj = 0.0, totalBlob = 0.0;
+    const std::string tmpPath = "meshconv_bench.tmp" MESH_FILE_EXTENSION;
+
+    for (const auto& input : inputs)
+    {
+        std::string text;
+        if (!ReadFile(input, text))
+        {
+            fprintf(stderr, "can't read %s\n", input.c_str());
+            return 1;
+        }
+
+        Mesh mesh;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; i++)
+        {
+            mesh = Mesh();
+            ParseObj(input, 1.f, false, mesh);
+        }
+        double objMs = Milliseconds(std::chrono::steady_clock::now() - start) / runs;
+
+        auto blob = Pack(mesh, 1.f, false);
+        WriteFile(tmpPath, blob);
+        std::vector<std::vector<float>> arrays;
+        size_t vertices = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; i++)
+        {
+            vertices = LoadBlob(tmpPath, arrays);
+        }
+        double blobMs = Milliseconds(std::chrono::steady_clock::now() - start) / runs;
+
+        totalObj += objMs;
+        totalBlob += blobMs;
+        printf("%-32s %10.1f %10.1f %8zu %12.3f %12.3f %7.1fx\n", input.c_str(), text.size() / 1024.0, blob.size() / 1024.0,
+               vertices, objMs, blobMs, objMs / (blobMs > 0.0 ? blobMs : 1e-9));
+    }
+
+    remove(tmpPath.c_str());
+    printf("%-32s %10s %10s %8s %12.3f %12.3f %7.1fx\n", "total", "", "", "", totalObj, totalBlob,
+           totalObj / (totalBlob > 0.0 ? totalBlob : 1e-9));
+    return 0;
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "usage: meshconv [-s scale] [-f] [-o output.gwm] input.obj\n"
+            "       meshconv --bench [-n runs] input.obj...\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    float scale = 1.f;
+    bool flipUVs = false, bench = false;
+    int runs = 10;
+    std::string output;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) scale = strtof(argv[++i], nullptr);
+        else if (arg == "-f") flipUVs = true;
+        else if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) runs = atoi(argv[++i]);
+        else if (arg == "--bench") bench = true;
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            Usage();
+            return 1;
+        }
+        else inputs.push_back(arg);
+    }
+
+    if (inputs.empty() || scale == 0.f || runs <= 0)
+    {
+        Usage();
+        return 1;
+    }
+
+    if (bench)
+    {
+        return Bench(inputs, runs);
+    }
+
+    if (inputs.size() != 1)
+    {
+        Usage();
+        return 1;
+    }
+
+    Mesh mesh;
+    if (!ParseObj(inputs[0], scale, flipUVs, mesh))
+    {
+        return 1;
+    }
+    if (output.empty())
+    {
+        output = BlobPath(inputs[0]);
+    }
+    auto blob = Pack(mesh, scale, flipUVs);
+    if (!WriteFile(output, blob))
+    {
+        fprintf(stderr, "can't write %s\n", output.c_str());
+        return 1;
+    }
+
+    size_t vertices = 0;
+    for (const auto& material : mesh.materials) vertices += material.positions.size() / 4;
+    printf("%s -> %s: %zu materials, %zu vertices, %zu bytes\n", inputs[0].c_str(), output.c_str(), mesh.materials.size(), vertices,
+           blob.size());
+    return 0;
+}